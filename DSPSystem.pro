@@ -8,25 +8,78 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
+CONFIG += c++11
+
 TARGET = Pruebas
 TEMPLATE = app
 
-LIBS += -lfftw3 -ljack -lsndfile -lGL
+LIBS += -lfftw3 -lfftw3f -ljack -lsndfile -lGL -lpthread
 
 INCLUDEPATH += /usr/include
 
+# qmake CONFIG+=rtcheck: abort if memory is allocated or released inside jack::process
+rtcheck {
+    DEFINES += _DSP_RT_ALLOC_CHECK
+}
+
+# qmake CONFIG+=fftwdouble: run the DFT engines in double precision (reference)
+fftwdouble {
+    DEFINES += _DSP_FFTW_DOUBLE
+}
+
+# make check: build and run the tests in pruebas/ (single against double precision)
+pruebas.target = check
+pruebas.commands = $(MKDIR) pruebas && cd pruebas && $(QMAKE) $$PWD/pruebas/pruebas.pro && $(MAKE) check
+QMAKE_EXTRA_TARGETS += pruebas
+
 
 SOURCES += main.cpp\
         mainwindow.cpp \
     controlvolume.cpp \
     dspsystem.cpp \
-    jack.cpp
+    jack.cpp \
+    sosbank.cpp \
+    partconvolver.cpp \
+    multiratebank.cpp \
+    banddesigner.cpp \
+    filterbank.cpp \
+    simdkernels.cpp \
+    processoradapter.cpp \
+    reblockadapter.cpp \
+    rtguard.cpp \
+    rtpool.cpp \
+    multichannelhost.cpp \
+    stagepipeline.cpp \
+    reverbunit.cpp \
+    graphnodes.cpp \
+    processorgraph.cpp
 
 HEADERS  += mainwindow.h \
     controlvolume.h \
     dspsystem.h \
     jack.h \
     processor.h \
+    processorv2.h \
+    processoradapter.h \
+    reblockadapter.h \
+    sosbank.h \
+    partconvolver.h \
+    multiratebank.h \
+    banddesigner.h \
+    filterbank.h \
+    simdkernels.h \
+    precision.h \
+    rtguard.h \
+    rtpool.h \
+    spinfutex.h \
+    multichannelhost.h \
+    stagepipeline.h \
+    spscring.h \
+    reverbunit.h \
+    graphnodes.h \
+    processorgraph.h \
+    triplebuffer.h \
+    parametros.h \
     spectralvalues.h
 
 FORMS    += mainwindow.ui
@@ -0,0 +1,265 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   banddesigner.cpp
+ *         Runtime design of the elliptic band-pass filters of the equalizer
+ *         for any sample rate.
+ *
+ * $Id: banddesigner.cpp $
+ */
+
+#include "banddesigner.h"
+#include <cmath>
+
+typedef sosBank::complejo complejo;
+
+namespace {
+
+  const long double Pi = 3.141592653589793238462643383279502884L;
+
+  /*
+   * Media aritmetico-geometrica de a y b.
+   */
+  long double mediaAG(long double a,long double b) {
+    for (int i=0;(i<64) && (std::fabs(a-b) > 1.0e-19L*a);++i) {
+      const long double t = 0.5L*(a+b);
+      b = std::sqrt(a*b);
+      a = t;
+    }
+    return a;
+  }
+
+  /*
+   * Integral eliptica completa de primera especie K(m).
+   */
+  long double integralK(long double m) {
+    return Pi/(2.0L*mediaAG(1.0L,std::sqrt(1.0L-m)));
+  }
+
+  /*
+   * K(1-p), sin perder precision cuando p es muy pequeno.
+   */
+  long double integralKComplemento(long double p) {
+    return Pi/(2.0L*mediaAG(1.0L,std::sqrt(p)));
+  }
+
+  /*
+   * Funciones elipticas de Jacobi sn, cn y dn de parametro 0 <= m < 1,
+   * por la media aritmetico-geometrica descendente.
+   */
+  void jacobi(long double u,long double m,
+              long double& sn,long double& cn,long double& dn) {
+
+    if (m < 1.0e-18L) {
+      sn = std::sin(u);
+      cn = std::cos(u);
+      dn = 1.0L;
+      return;
+    }
+
+    long double a[16];
+    long double c[16];
+    a[0] = 1.0L;
+    c[0] = std::sqrt(m);
+    long double b = std::sqrt(1.0L-m);
+    long double potencia = 1.0L;
+    int i = 0;
+    while ((std::fabs(c[i]/a[i]) > 1.0e-19L) && (i < 15)) {
+      const long double ai = a[i];
+      ++i;
+      c[i] = 0.5L*(ai-b);
+      const long double t = std::sqrt(ai*b);
+      a[i] = 0.5L*(ai+b);
+      b = t;
+      potencia *= 2.0L;
+    }
+
+    long double phi = potencia*a[i]*u;
+    long double anterior = phi;
+    for (;i>0;--i) {
+      const long double t = c[i]*std::sin(phi)/a[i];
+      anterior = phi;
+      phi = 0.5L*(std::asin(t)+phi);
+    }
+
+    sn = std::sin(phi);
+    cn = std::cos(phi);
+    dn = cn/std::cos(phi-anterior);
+  }
+
+  /*
+   * Parametro m del filtro eliptico de orden n cuya selectividad corresponde
+   * a la discriminacion m1 (ecuacion de grado, por las series de la nome q).
+   */
+  long double ecuacionGrado(int n,long double m1) {
+    const long double q1 = std::exp(-Pi*integralKComplemento(m1)/integralK(m1));
+    const long double q = std::pow(q1,1.0L/n);
+
+    long double num = 0.0L;
+    long double den = 0.0L;
+    for (int k=0;k<7;++k) {
+      num += std::pow(q,static_cast<long double>(k*(k+1)));
+    }
+    for (int k=1;k<8;++k) {
+      den += std::pow(q,static_cast<long double>(k*k));
+    }
+    return 16.0L*q*std::pow(num/(1.0L+2.0L*den),4);
+  }
+
+  /*
+   * Inversa de sc(u,m) = sn/cn, como Im{sn^-1(jw,m)} con la sucesion
+   * descendente de Landen.
+   */
+  long double inversaSc(long double w,long double m) {
+
+    long double k[32];
+    int n = 0;
+    k[0] = std::sqrt(m);
+    while ((k[n] != 0.0L) && (n < 31)) {
+      const long double kp = std::sqrt((1.0L-k[n])*(1.0L+k[n]));
+      k[n+1] = (1.0L-kp)/(1.0L+kp);
+      ++n;
+    }
+
+    long double K = 0.5L*Pi;
+    for (int i=1;i<=n;++i) {
+      K *= 1.0L+k[i];
+    }
+
+    complejo wn(0.0L,w);
+    for (int i=0;i<n;++i) {
+      wn = 2.0L*wn/((1.0L+k[i+1])*(1.0L+std::sqrt((1.0L-k[i]*wn)*(1.0L+k[i]*wn))));
+    }
+
+    return (K*(2.0L/Pi)*std::asin(wn)).imag();
+  }
+}
+
+/*
+ * Constructor
+ *
+ * Calcula el prototipo analogico pasabajos eliptico con corte en 1 rad/s.
+ */
+bandDesigner::bandDesigner(double rizado,double atenuacion) {
+
+  const int N = OrdenPrototipo;
+
+  const long double epsCuadrado = std::pow(10.0L,0.1L*rizado) - 1.0L;
+  const long double eps = std::sqrt(epsCuadrado);
+  const long double discriminacion = epsCuadrado/(std::pow(10.0L,0.1L*atenuacion) - 1.0L);
+
+  const long double m = ecuacionGrado(N,discriminacion);
+  const long double capK = integralK(m);
+  const long double v0 = capK*inversaSc(1.0L/eps,discriminacion)/(N*integralK(discriminacion));
+
+  long double sv,cv,dv;
+  jacobi(v0,1.0L-m,sv,cv,dv);
+
+  int nCeros = 0;
+  int nPolos = 0;
+  for (int j=1-(N%2);j<N;j+=2) {
+    long double s,c,d;
+    jacobi(j*capK/N,m,s,c,d);
+
+    // Ceros en +-j/(sqrt(m) sn); el de sn = 0 esta en infinito.
+    if (std::fabs(s) > 1.0e-15L) {
+      const complejo cero(0.0L,1.0L/(std::sqrt(m)*s));
+      cerosPrototipo_[nCeros++] = cero;
+      cerosPrototipo_[nCeros++] = std::conj(cero);
+    }
+
+    const complejo polo = -complejo(c*d*sv*cv,s*dv)/(1.0L-(d*sv)*(d*sv));
+    polosPrototipo_[nPolos++] = polo;
+    if (std::fabs(polo.imag()) > 1.0e-15L) {
+      polosPrototipo_[nPolos++] = std::conj(polo);
+    }
+  }
+
+  // Ganancia unitaria en continua (orden impar: el maximo del rizado es 1).
+  complejo num = 1.0L;
+  complejo den = 1.0L;
+  for (int i=0;i<nPolos;++i) {
+    num *= -polosPrototipo_[i];
+  }
+  for (int i=0;i<nCeros;++i) {
+    den *= -cerosPrototipo_[i];
+  }
+  gananciaPrototipo_ = (num/den).real();
+}
+
+/**
+ * @brief disenar Calcula ceros, polos y ganancia en z de un pasabanda.
+ * @param fs frecuencia de muestreo en Hz.
+ * @param inferior frecuencia de borde inferior en Hz.
+ * @param superior frecuencia de borde superior en Hz (menor que fs/2).
+ * @param ceros arreglo de Orden ceros.
+ * @param polos arreglo de Orden polos.
+ * @param ganancia ganancia del filtro.
+ * @return false si los bordes no forman una banda valida para fs.
+ */
+bool bandDesigner::disenar(double fs,double inferior,double superior,
+                           complejo* ceros,complejo* polos,
+                           long double& ganancia) const {
+
+  if (!(inferior > 0.0) || !(superior > inferior) || !(superior < 0.5*fs)) {
+    return false;
+  }
+
+  // Los bordes se predistorsionan para que la bilineal los deje en su lugar.
+  const long double fs2 = 2.0L*fs;
+  const long double w1 = fs2*std::tan(Pi*inferior/fs);
+  const long double w2 = fs2*std::tan(Pi*superior/fs);
+  const long double ancho = w2-w1;
+  const long double centro2 = w1*w2;
+
+  // Pasabajos a pasabanda, s -> (s^2 + wo^2)/(B s): cada raiz r da dos raices
+  // rB/2 +- sqrt((rB/2)^2 - wo^2). El cero en infinito del prototipo queda en s = 0.
+  complejo cerosS[Orden-1];
+  complejo polosS[Orden];
+  int n = 0;
+  for (int i=0;i<OrdenPrototipo-1;++i) {
+    const complejo r = cerosPrototipo_[i]*(0.5L*ancho);
+    const complejo raiz = std::sqrt(r*r-centro2);
+    cerosS[n++] = r+raiz;
+    cerosS[n++] = r-raiz;
+  }
+  cerosS[n++] = 0.0L;
+  for (int i=0;i<OrdenPrototipo;++i) {
+    const complejo r = polosPrototipo_[i]*(0.5L*ancho);
+    const complejo raiz = std::sqrt(r*r-centro2);
+    polosS[2*i] = r+raiz;
+    polosS[2*i+1] = r-raiz;
+  }
+
+  // Transformada bilineal z = (2fs + s)/(2fs - s). El cero restante en infinito pasa a z = -1.
+  complejo num = 1.0L;
+  complejo den = 1.0L;
+  for (int i=0;i<Orden-1;++i) {
+    ceros[i] = (fs2+cerosS[i])/(fs2-cerosS[i]);
+    num *= fs2-cerosS[i];
+  }
+  ceros[Orden-1] = -1.0L;
+  for (int i=0;i<Orden;++i) {
+    polos[i] = (fs2+polosS[i])/(fs2-polosS[i]);
+    den *= fs2-polosS[i];
+  }
+
+  ganancia = gananciaPrototipo_*ancho*(num/den).real();
+  return true;
+}
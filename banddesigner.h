@@ -0,0 +1,88 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   banddesigner.h
+ *         Runtime design of the elliptic band-pass filters of the equalizer
+ *         for any sample rate.
+ *
+ * $Id: banddesigner.h $
+ */
+
+#ifndef BANDDESIGNER_H
+#define BANDDESIGNER_H
+
+#include "sosbank.h"
+
+/**
+ * Disenador de filtros pasabanda elipticos.
+ *
+ * Se parte del prototipo analogico pasabajos eliptico de orden 3 (rizado
+ * rp en la banda de paso y atenuacion rs en la de rechazo), se transforma a
+ * pasabanda entre las frecuencias de borde predistorsionadas y se discretiza
+ * con la transformada bilineal. El resultado es un filtro de orden 6 dado por
+ * sus ceros, polos y ganancia, que se pasa directamente a secciones de segundo
+ * orden sin expandir el polinomio (que esta mal condicionado en las bandas bajas).
+ *
+ * Con rp = 1 dB, rs = 80 dB y fs = 44100 Hz se obtienen los coeficientes que
+ * el ecualizador tenia escritos como constantes.
+ */
+class bandDesigner {
+public:
+
+    /**
+     * Constantes del disenador.
+     */
+    enum {
+      OrdenPrototipo=3, /**< Orden del prototipo pasabajos. */
+      Orden=6           /**< Orden del pasabanda resultante. */
+    };
+
+    /**
+     * Constructor
+     * @param rizado rizado maximo en la banda de paso, en dB.
+     * @param atenuacion atenuacion minima en la banda de rechazo, en dB.
+     */
+    bandDesigner(double rizado=1.0,double atenuacion=80.0);
+
+    /**
+     * @brief disenar Calcula ceros, polos y ganancia en z de un pasabanda.
+     * @param fs frecuencia de muestreo en Hz.
+     * @param inferior frecuencia de borde inferior en Hz.
+     * @param superior frecuencia de borde superior en Hz (menor que fs/2).
+     * @param ceros arreglo de Orden ceros.
+     * @param polos arreglo de Orden polos.
+     * @param ganancia ganancia del filtro.
+     * @return false si los bordes no forman una banda valida para fs.
+     */
+    bool disenar(double fs,double inferior,double superior,
+                 sosBank::complejo* ceros,sosBank::complejo* polos,
+                 long double& ganancia) const;
+
+private:
+
+    /**
+     * Ceros, polos y ganancia del prototipo analogico con corte en 1 rad/s.
+     * Los ceros son imaginarios puros (OrdenPrototipo-1), los polos OrdenPrototipo.
+     */
+    sosBank::complejo cerosPrototipo_[OrdenPrototipo-1];
+    sosBank::complejo polosPrototipo_[OrdenPrototipo];
+    long double gananciaPrototipo_;
+};
+
+#endif // BANDDESIGNER_H
@@ -27,362 +27,851 @@
 
 #include "controlvolume.h"
 #include "spectralvalues.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <stdlib.h>
+#include <vector>
 using namespace std;
 
 #define REAL 0
 #define IMAG 1
 #define PI 3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067982148086513282306647093844609550582231725359408128481
 
+namespace {
+
+  /*
+   * Separacion minima en Hz entre el borde superior de una banda y fs/2.
+   */
+  const double margenNyquist = 500.0;
+
+  /*
+   * Energia de la cola de h(n) que se descarta, relativa a la total (-80 dB).
+   */
+  const double toleranciaCola = 1e-8;
+
+  /*
+   * Los largos de h(n) se redondean hacia arriba a un multiplo de este valor.
+   */
+  const int granoLargo = 16;
+
+  /*
+   * Elige el menor largo L de h(n) tal que la energia de h(L), h(L+1), ... sea a
+   * lo sumo toleranciaCola de la energia total, sin exceder maximo, y calcula en
+   * dB la energia descartada. Una respuesta nula tiene largo 0.
+   */
+  int medirCola(const double* h,int ventana,int maximo,double& error){
+    double total = 0.0;
+    for(int n = 0; n < ventana; n++){
+      total += h[n]*h[n];
+    }
+    if(total <= 0.0){
+      error = -HUGE_VAL;
+      return 0;
+    }
+    double cola = 0.0;
+    int largo = ventana;
+    while((largo > 0) && (cola + h[largo-1]*h[largo-1] <= toleranciaCola*total)){
+      --largo;
+      cola += h[largo]*h[largo];
+    }
+    largo = std::min(maximo,((largo + granoLargo - 1)/granoLargo)*granoLargo);
+    cola = 0.0;
+    for(int n = largo; n < ventana; n++){
+      cola += h[n]*h[n];
+    }
+    error = (cola > 0.0) ? 10.0*log10(cola/total) : -HUGE_VAL;
+    return largo;
+  }
+
+  /*
+   * Busca el primer y el ultimo termino de H(k) cuya magnitud supera umbral
+   * veces la maxima. Se devuelve [desde,hasta); una tabla nula da un rango vacio.
+   */
+  template<typename C>
+  void rangoSignificativo(const C* H,int terminos,double umbral,
+                          int& desde,int& hasta){
+    double maximo = 0.0;
+    for(int k = 0; k < terminos; k++){
+      maximo = std::max(maximo,double(H[k][0])*H[k][0] + double(H[k][1])*H[k][1]);
+    }
+    const double limite = umbral*umbral*maximo;
+    desde = 0;
+    hasta = 0;
+    if(maximo <= 0.0){
+      return;
+    }
+    desde = terminos;
+    for(int k = 0; k < terminos; k++){
+      if(double(H[k][0])*H[k][0] + double(H[k][1])*H[k][1] >= limite){
+        desde = std::min(desde,k);
+        hasta = k + 1;
+      }
+    }
+  }
+
+  /*
+   * Indica si las n muestras son todas cero.
+   */
+  bool esSilencio(const float* x,int n){
+    for(int i = 0; i < n; i++){
+      if(x[i] != 0.0f){
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+template<typename Precision>
+const double basicControlVolume<Precision>::UmbralBinsOmision = -90.0;
+
 /*
  * Constructor
  */
-controlVolume::controlVolume(){
+template<typename Precision>
+basicControlVolume<Precision>::basicControlVolume(const filterBank& banco)
+    :basicControlVolume(banco,0){
+}
+
+/*
+ * Constructor de un canal con fuente
+ */
+template<typename Precision>
+basicControlVolume<Precision>::basicControlVolume(basicControlVolume* fuente)
+    :basicControlVolume(fuente->banco_,fuente){
+}
 
-    //Inicializacion de los punteros de tipo double[2048][2].
-    f32 = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * 2048);
-    f64 = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * 2048);
-    f125 = (fftw_complex*) fftw_malloc(sizeof(fftw_complex)* 2048);
-    f250 = (fftw_complex*) fftw_malloc(sizeof(fftw_complex)* 2048);
-    f500 = (fftw_complex*) fftw_malloc(sizeof(fftw_complex)* 2048);
-    f1k = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * 2048);
-    f2k = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * 2048);
-    f4k = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * 2048);
-    f8k = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * 2048);
-    f16k = (fftw_complex*) fftw_malloc(sizeof(fftw_complex)* 2048);
+/*
+ * Constructor comun
+ */
+template<typename Precision>
+basicControlVolume<Precision>::basicControlVolume(const filterBank& banco, basicControlVolume* fuente)
+    :motor(MotorCompuesto),medirBandas(true),banco_(banco),bandas_(banco.bandas()),
+     nucleos_(simdKernels::seleccionados()),motorAnterior_(MotorCompuesto),volumenAnterior_(-1),
+     canalesAnterior_(1),silencio_(0),omitido_(false),reverb_((fuente != 0) ? 1 : int(MaxCanales)),retardoMultitasa_(0),umbralBins_(pow(10.0,UmbralBinsOmision/20.0)),actual_(0),reservado_(0),publicaciones_(0),pedido_(0),terminar_(false),fuente_(fuente),canales_((fuente != 0) ? 1 : int(MaxCanales)),enUso_(0){
 
     //valor booleano que indica el inicio de una cancion.
     inicio = true;
 
-    // Arreglos donde se almacenan los M-1 valores de la salida que se generan al aplicar el metodo de solapamiento y suma.
-    datos32 = new float[1024];
-    datos64 = new float[1024];
-    datos125 = new float[1024];
-    datos250 = new float[1024];
-    datos500 = new float[1024];
-    datos1k = new float[1024];
-    datos2k = new float[1024];
-    datos4k = new float[1024];
-    datos8k = new float[1024];
-    datos16k = new float[1024];
-
-    tmpOut = new float[1024];
-
-    // Se inicializa el valor de la salida como 0
-    lastOut = new float[MAX_D];
-    lastReverb = new float[MAX_D];
-
-    for(int i = 0;i < MAX_D; i++){
-        lastOut[i] = 0.0;
-        lastReverb[i] = 0.0;
-    }
-
-    //Inicializacion de los valores en los punteros de tipo double[2048][2]
-    inicializarH32();
-    inicializarH64();
-    inicializarH125();
-    inicializarH250();
-    inicializarH500();
-    inicializarH1k();
-    inicializarH2k();
-    inicializarH4k();
-    inicializarH8k();
-    inicializarH16k();
+    for(int b = 0; b < MaxBandas; b++){
+        muestrasBanda_[b] = 0.0f;
+    }
 
+    //Los filtros de cada banda se disenan en prepararPlanes() para la frecuencia de
+    //muestreo y el tamano de bloque que se esten utilizando. Los cambios posteriores
+    //los atiende el hilo de diseno (solicitarPlanes).
+    sem_init(&pendiente_,0,0);
+    trabajador_ = std::thread(&basicControlVolume::trabajar,this);
 }
+
 /*
  * Destructor
  */
-controlVolume::~controlVolume(){
+template<typename Precision>
+basicControlVolume<Precision>::~basicControlVolume(){
+
+    grupo_.detener();
+
+    terminar_.store(true);
+    sem_post(&pendiente_);
+    trabajador_.join();
+    sem_destroy(&pendiente_);
+
+    actual_.store(0);
+    for(typename estadoCache_type::iterator it = estados_.begin(); it != estados_.end(); ++it){
+        liberarEstado(it->second);
+    }
+    estados_.clear();
+
+    for(typename disenoCache_type::iterator it = disenos_.begin(); it != disenos_.end(); ++it){
+        liberarDiseno(it->second);
+    }
+    disenos_.clear();
+
+    //Se destruyen los planes guardados en el cache.
+    for(typename planCache_type::iterator it = planes_.begin(); it != planes_.end(); ++it){
+        Precision::destruir(it->second);
+    }
+    planes_.clear();
+
+    //Los planes de la fuente siguen en uso mientras ella exista.
+    if(fuente_ == 0){
+        Precision::limpiar();
+    }
+}
+
+/**
+ * @brief prepararPlanes Construye (o toma del cache) el diseno de las bandas, las tablas, planes y buffers
+ * de una frecuencia de muestreo y un tamano de bloque, y los publica.
+ * @param sampleRate frecuencia de muestreo en Hz.
+ * @param blockSize cantidad de muestras por bloque (cualquier tamano).
+ * @param flags bandera de planeacion de FFTW (FFTW_MEASURE o FFTW_PATIENT).
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::prepararPlanes(int sampleRate, int blockSize, unsigned flags){
+
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    publicarEstado(obtenerEstado(sampleRate,blockSize,flags));
+}
+
+/**
+ * @brief solicitarPlanes Pide al hilo de diseno el estado de una frecuencia de muestreo y un tamano de bloque.
+ * @param sampleRate frecuencia de muestreo en Hz.
+ * @param blockSize cantidad de muestras por bloque.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::solicitarPlanes(int sampleRate, int blockSize){
+
+    if(sampleRate <= 0){
+        sampleRate = FrecuenciaReferencia;
+    }
+
+    // El pedido siempre se registra: si el hilo de diseno esta construyendo otro
+    // estado, al terminar ve que hay uno mas reciente y no publica el suyo.
+    pedido_.store((static_cast<long long>(sampleRate) << 32) | blockSize);
+
+    // Si el estado ya esta en el cache y el hilo de diseno no tiene el cache
+    // tomado, se publica de inmediato. Nunca se espera por el mutex.
+    std::unique_lock<std::mutex> lock(cacheMutex_,std::try_to_lock);
+    if(lock.owns_lock()){
+        typename estadoCache_type::iterator it = estados_.find(std::make_pair(sampleRate,blockSize));
+        if(it != estados_.end()){
+            publicarEstado(it->second);
+        }
+    }
+
+    sem_post(&pendiente_);
+}
+
+/**
+ * @brief trabajar Ciclo del hilo de diseno: espera pedidos y construye sus estados.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::trabajar(){
+
+    for(;;){
+        while(sem_wait(&pendiente_) != 0){
+            // EINTR: se vuelve a esperar
+        }
+        if(terminar_.load()){
+            return;
+        }
+
+        const long long pedido = pedido_.exchange(0);
+        if(pedido == 0){
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        EstadoBloque* e = obtenerEstado(static_cast<int>(pedido >> 32),
+                                        static_cast<int>(pedido & 0xffffffffLL),FFTW_MEASURE);
+
+        // Si llego otro pedido mientras se construia este estado, queda en el cache
+        // y se publica el mas reciente en la siguiente vuelta.
+        if(pedido_.load() == 0){
+            publicarEstado(e);
+        }
+    }
+}
+
+/**
+ * @brief obtenerEstado Toma del cache o construye el estado de una configuracion. Requiere cacheMutex_.
+ * @param sampleRate frecuencia de muestreo en Hz.
+ * @param blockSize cantidad de muestras por bloque.
+ * @param flags bandera de planeacion de FFTW.
+ */
+template<typename Precision>
+typename basicControlVolume<Precision>::EstadoBloque* basicControlVolume<Precision>::obtenerEstado(int sampleRate, int blockSize, unsigned flags){
+
+    if(sampleRate <= 0){
+        sampleRate = FrecuenciaReferencia;
+    }
+
+    // Las frecuencias y tamanos ya vistos se toman del cache, de modo que volver a
+    // una configuracion anterior no cuesta nada.
+    DisenoTasa* d = obtenerDiseno(sampleRate);
+
+    EstadoBloque* e = 0;
+    const std::pair<int,int> clave(sampleRate,blockSize);
+    typename estadoCache_type::iterator it = estados_.find(clave);
+    if(it == estados_.end()){
+        e = crearEstado(d,blockSize,flags);
+        estados_[clave] = e;
+    } else {
+        e = it->second;
+    }
+
+    return e;
+}
+
+/**
+ * @brief obtenerDiseno Toma del cache o construye el diseno de una frecuencia de muestreo. Requiere cacheMutex_.
+ * @param sampleRate frecuencia de muestreo en Hz.
+ */
+template<typename Precision>
+typename basicControlVolume<Precision>::DisenoTasa* basicControlVolume<Precision>::obtenerDiseno(int sampleRate){
+
+    typename disenoCache_type::iterator itd = disenos_.find(sampleRate);
+    if(itd != disenos_.end()){
+        return itd->second;
+    }
+    DisenoTasa* d = crearDiseno(sampleRate);
+    disenos_[sampleRate] = d;
+    return d;
+}
+
+/**
+ * @brief publicarEstado Publica un estado y libera los que sobran en el cache. Requiere cacheMutex_.
+ * @param e estado a publicar; debe estar en el cache.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::publicarEstado(EstadoBloque* e){
+
+    // El hilo de tiempo real toma el estado nuevo al inicio del siguiente bloque.
+    e->uso = ++publicaciones_;
+    retardoMultitasa_.store(e->diseno->multitasa[0]->latencia());
+    actual_.store(e);
+
+    podarCache(e);
+}
+
+/**
+ * @brief podarCache Libera los estados menos recientes que sobran en el cache y los disenos sin estados.
+ * Requiere cacheMutex_.
+ * @param conservar estado que no se libera aunque sea el menos reciente.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::podarCache(EstadoBloque* conservar){
+
+    // Se descartan los estados menos recientes que sobran. El que el hilo de tiempo
+    // real declaro en reservado_ se conserva: filter() solo lo cambia despues de
+    // verificar que sigue publicado, por lo que despues de publicar un estado nunca
+    // vuelve a tomar otro. Los que usan otros canales tampoco se pueden liberar.
+    while(estados_.size() > static_cast<size_t>(MaxEstados)){
+        EstadoBloque* enUso = reservado_.load();
+        EstadoBloque* publicado = actual_.load();
+        typename estadoCache_type::iterator victima = estados_.end();
+        for(typename estadoCache_type::iterator it = estados_.begin(); it != estados_.end(); ++it){
+            if((it->second != conservar) && (it->second != enUso) && (it->second != publicado) &&
+               (it->second->prestamos == 0) &&
+               ((victima == estados_.end()) || (it->second->uso < victima->second->uso))){
+                victima = it;
+            }
+        }
+        if(victima == estados_.end()){
+            break;
+        }
+        liberarEstado(victima->second);
+        estados_.erase(victima);
+    }
 
+    // Los disenos que ya no tienen estados ni los usan otros canales tampoco se necesitan.
+    typename disenoCache_type::iterator itd = disenos_.begin();
+    while(itd != disenos_.end()){
+        bool usado = (itd->second->prestamos > 0);
+        for(typename estadoCache_type::iterator it = estados_.begin(); it != estados_.end(); ++it){
+            usado = usado || (it->second->diseno == itd->second);
+        }
+        if(usado){
+            ++itd;
+        } else {
+            liberarDiseno(itd->second);
+            disenos_.erase(itd++);
+        }
+    }
 }
 
 /**
- * @brief inicializarHK Funcion encargada de generar H(k) utilizando la DFT para un filtro especifico.
- * @param puntero puntero a un arreglo donde se almacenaran los valores de H(k).
- * @param G valor que representa la ganancia total de la ecuacion de diferencias de grado 6.
- * @param a_0 valor decimal que representa coeficiente que multiplica a x(n).
- * @param b_0 valor decimal que representa coeficiente que multiplica a x(n-1).
- * @param c_0 valor decimal que representa coeficiente que multiplica a x(n-2).
- * @param e_0 valor decimal que representa coeficiente que multiplica a x(n-4).
- * @param f_0 valor decimal que representa coeficiente que multiplica a x(n-5).
- * @param g_0 valor decimal que representa coeficiente que multiplica a x(n-6).
- * @param b_1 valor decimal que representa coeficiente que multiplica a y(n-1).
- * @param c_1 valor decimal que representa coeficiente que multiplica a y(n-2).
- * @param d_1 valor decimal que representa coeficiente que multiplica a y(n-3).
- * @param e_1 valor decimal que representa coeficiente que multiplica a y(n-4).
- * @param f_1 valor decimal que representa coeficiente que multiplica a y(n-5).
- * @param g_1 valor decimal que representa coeficiente que multiplica a y(n-6).
+ * @brief crearDiseno Disena las bandas para una frecuencia de muestreo y calcula sus respuestas al impulso.
+ * @param sampleRate frecuencia de muestreo en Hz.
  */
-void controlVolume::inicializarHK(fftw_complex *puntero, double G, double a_0, double b_0, double c_0, double e_0, double f_0, double g_0, double b_1, double c_1, double d_1, double e_1, double f_1, double g_1){
+template<typename Precision>
+typename basicControlVolume<Precision>::DisenoTasa* basicControlVolume<Precision>::crearDiseno(int sampleRate){
+
+    DisenoTasa* d = new DisenoTasa;
+    d->sampleRate = sampleRate;
+    d->prestado = 0;
+    d->prestamos = 0;
+    d->memoria = 0;
+    for(int c = 0; c < MaxCanales; c++){
+        d->iir[c] = (c < canales_) ? new sosBank(bandas_) : 0;
+        d->multitasa[c] = 0;
+    }
+
+    //Un canal con fuente toma las respuestas y sus largos del diseno de la fuente y solo
+    //disena sus propias secciones, que llevan el estado del canal.
+    if(fuente_ != 0){
+        std::lock_guard<std::mutex> lock(fuente_->cacheMutex_);
+        d->prestado = fuente_->obtenerDiseno(sampleRate);
+        ++d->prestado->prestamos;
+    }
 
-    int N = 2048; //Largo del enventanado.
+    //h(n) se mide en una ventana del doble del largo maximo, de modo que el error de
+    //una banda que no cabe en LargoMaximo tambien se puede estimar.
+    const int ventana = 2*LargoMaximo;
+    double* h = (d->prestado == 0) ? new double[ventana] : 0;
+    int total = 0;
+    d->cantidadLargas = 0;
+
+    for(int b = 0; b < bandas_; b++){
+
+        //El borde superior se limita por debajo de fs/2; una banda que no cabe no aporta a la salida.
+        const double inferior = banco_.banda(b).inferior;
+        const double superior = std::min(banco_.banda(b).superior,0.5*sampleRate - margenNyquist);
+
+        sosBank::complejo ceros[bandDesigner::Orden];
+        sosBank::complejo polos[bandDesigner::Orden];
+        long double ganancia = 0.0L;
+        //Los bancos de los canales tienen los mismos coeficientes; solo el estado es distinto.
+        const bool cabe = disenador_.disenar(sampleRate,inferior,superior,ceros,polos,ganancia);
+        for(int c = 0; c < canales_; c++){
+            if(!cabe || !d->iir[c]->disenarZpk(b,ceros,polos,ganancia)){
+                d->iir[c]->anular(b);
+            }
+        }
+        if(!cabe && (d->prestado == 0)){
+            cerr << "controlVolume: la banda " << b << " no cabe en " << sampleRate << " Hz" << endl;
+        }
+        if(d->prestado != 0){
+            d->respuestas[b] = d->prestado->respuestas[b];
+            d->largos[b] = d->prestado->largos[b];
+            d->errores[b] = d->prestado->errores[b];
+            d->larga[b] = d->prestado->larga[b];
+            d->cantidadLargas += d->larga[b] ? 1 : 0;
+            continue;
+        }
+
+        //h(n) se calcula con las secciones de segundo orden, sin expandir el polinomio de orden 6,
+        //y se conserva hasta donde decae su energia: las bandas bajas son mucho mas largas que las altas.
+        d->iir[0]->respuestaImpulso(b,ventana,h);
+        d->largos[b] = medirCola(h,ventana,LargoMaximo,d->errores[b]);
+        d->larga[b] = (d->largos[b] > LargoFIR);
+        if(d->larga[b]){
+            ++d->cantidadLargas;
+        }
+        total += d->largos[b];
+    }
+    delete[] h;
+
+    d->cola = 0;
+    for(int b = 0; b < bandas_; b++){
+        d->cola = std::max(d->cola,d->largos[b]);
+    }
+
+    //Las respuestas de todas las bandas se guardan en una sola reserva, una tras otra.
+    if(d->prestado == 0){
+        d->memoria = new double[std::max(1,total)];
+        double* siguiente = d->memoria;
+        for(int b = 0; b < bandas_; b++){
+            d->respuestas[b] = siguiente;
+            d->iir[0]->respuestaImpulso(b,d->largos[b],d->respuestas[b]);
+            siguiente += d->largos[b];
+        }
+    }
 
-    fftw_complex *h = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N);
+    //Las bandas bajas de MotorMultitasa toman sus respuestas de las mismas secciones.
+    for(int c = 0; c < canales_; c++){
+        d->multitasa[c] = new multirateBank(bandas_);
+        d->multitasa[c]->preparar(sampleRate,banco_,*d->iir[0]);
+    }
+
+    return d;
+}
 
-    //Asumiendo que x(n) = d(n) Impulso unitario.
-    //calculo de h(0).
-    h[0][REAL] = G * a_0;
-    //calculo de h(1).
-    h[1][REAL] = G * b_0 + b_1 * h[0][REAL];
-    //calculo de h(2).
-    h[2][REAL] = G * c_0 + h[1][REAL] * b_1 + c_1 * h[0][REAL];
-    //calculo de h(3).
-    h[3][REAL] = h[2][REAL] * b_1 + c_1 * h[1][REAL] + d_1 * h[0][REAL];
-    //calculo de h(4).
-    h[4][REAL] = G * e_0 + b_1 * h[3][REAL] + c_1 * h[2][REAL] + d_1 * h[1][REAL] + e_1 * h[0][REAL];
-    //calculo de h(5).
-    h[5][REAL] = G * f_0 + b_1 * h[4][REAL] + c_1 * h[3][REAL] + d_1 * h[2][REAL] + e_1 * h[1][REAL] + f_1 * h[0][REAL];
-    //calculo de h(6).
-    h[6][REAL] = G * g_0 + b_1 * h[5][REAL] + c_1 * h[4][REAL] + d_1 * h[3][REAL] + e_1 * h[2][REAL] + f_1 * h[1][REAL] + g_1 * h[0][REAL];
+/**
+ * @brief liberarDiseno Libera la memoria de un diseno.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::liberarDiseno(DisenoTasa* d){
 
-    //De h(7) en adelante solo depende de las salidas anteriores. Por lo que recursivamente se calculan los demas valores.
-    for(int i = 7; i<1025; i++){
+    if(d->prestado != 0){
+        std::lock_guard<std::mutex> lock(fuente_->cacheMutex_);
+        --d->prestado->prestamos;
+    }
+    delete[] d->memoria;
+    for(int c = 0; c < MaxCanales; c++){
+        delete d->iir[c];
+        delete d->multitasa[c];
+    }
+    delete d;
+}
 
+/**
+ * @brief crearEstado Construye las tablas, planes y buffers de un tamano de bloque a partir de un diseno.
+ * @param d filtros de la frecuencia de muestreo del estado.
+ * @param blockSize cantidad de muestras por bloque.
+ * @param flags bandera de planeacion de FFTW.
+ */
+template<typename Precision>
+typename basicControlVolume<Precision>::EstadoBloque* basicControlVolume<Precision>::crearEstado(DisenoTasa* d, int blockSize, unsigned flags){
+
+    EstadoBloque* e = new EstadoBloque;
+    e->diseno = d;
+    e->uso = 0;
+    e->prestamos = 0;
+
+    // Un canal con fuente toma las tablas, rangos y planes del estado de la fuente para
+    // la misma configuracion, que tiene los mismos largos, y solo reserva sus historias
+    // y buffers de trabajo.
+    EstadoBloque* f = 0;
+    if(fuente_ != 0){
+        std::lock_guard<std::mutex> lock(fuente_->cacheMutex_);
+        f = fuente_->obtenerEstado(d->sampleRate,blockSize,flags);
+        ++f->prestamos;
+        fuente_->podarCache(f);
+    }
+    e->prestado = f;
 
-        h[i][REAL] = b_1 * h[i-1][REAL] + c_1 * h[i-2][REAL] + d_1 * h[i-3][REAL] + e_1 * h[i-4][REAL] + f_1 * h[i-5][REAL] + g_1 * h[i-6][REAL];
+    // Menor potencia de dos en la que caben el bloque y la cola de la banda corta mas larga.
+    int largoCortas = 1;
+    for(int b = 0; b < bandas_; b++){
+        if(!d->larga[b]){
+            largoCortas = std::max(largoCortas,d->largos[b]);
+        }
+    }
+    int N = 1;
+    while(N < blockSize + largoCortas - 1){
+        N *= 2;
+    }
+    int terminos = N/2 + 1; // N/2+1 terminos no redundantes de la DFT real
+
+    e->blockSize = blockSize;
+    e->largoDFT = N;
+    e->historia = N - blockSize;
+
+    e->x = (real*) Precision::reservar(sizeof(real) * N);
+    e->X = (complejo*) Precision::reservar(sizeof(complejo) * terminos);
+    e->Y = (complejo*) Precision::reservar(sizeof(complejo) * terminos);
+    e->y = (real*) Precision::reservar(sizeof(real) * N);
+    e->z = (canales_ > 1) ? (complejo*) Precision::reservar(sizeof(complejo) * N) : 0;
+    e->Z = (canales_ > 1) ? (complejo*) Precision::reservar(sizeof(complejo) * N) : 0;
+
+    // MotorBandas usa un juego de buffers por hilo de grupo_; el del hilo de tiempo real
+    // son x, X, Y y y. Ninguna banda corta usa una DFT de mas de N puntos.
+    e->trabajos = grupo_.hilos() + 1;
+    e->xTrabajo[0] = e->x;
+    e->XTrabajo[0] = e->X;
+    e->YTrabajo[0] = e->Y;
+    e->yTrabajo[0] = e->y;
+    for(int h = 1; h < e->trabajos; h++){
+        e->xTrabajo[h] = (real*) Precision::reservar(sizeof(real) * N);
+        e->XTrabajo[h] = (complejo*) Precision::reservar(sizeof(complejo) * terminos);
+        e->YTrabajo[h] = (complejo*) Precision::reservar(sizeof(complejo) * terminos);
+        e->yTrabajo[h] = (real*) Precision::reservar(sizeof(real) * N);
+    }
 
+    if(f != 0){
+        e->dft = f->dft;
+        e->idft = f->idft;
+        e->zdft = f->zdft;
+        e->zidft = f->zidft;
+        e->tablasH = f->tablasH;
+        e->tablasBandas = f->tablasBandas;
+        e->giro = f->giro;
+        for(int b = 0; b < bandas_; b++){
+            e->tablas[b] = f->tablas[b];
+            e->rangos[b] = f->rangos[b];
+            e->largoBanda[b] = f->largoBanda[b];
+            e->dftBanda[b] = f->dftBanda[b];
+            e->idftBanda[b] = f->idftBanda[b];
+            e->tablaBanda[b] = f->tablaBanda[b];
+            e->rangosBanda[b] = f->rangosBanda[b];
+        }
+    } else {
+        crearTablas(d,e,flags);
     }
 
-    //Se agregan ceros hasta que el largo de h(n) sea igual a L+M-1 = 2048.
-    for(int i = 1025;i<N;i++){
+    // Historias de MotorBandas, de N_b-B muestras por canal y banda.
+    for(int b = 0; b < bandas_; b++){
+        const int Nb = e->largoBanda[b];
+        for(int c = 0; c < MaxCanales; c++){
+            e->datos[c][b] = (c < canales_) ? new float[Nb - blockSize] : 0;
+            for(int i = 0; (c < canales_) && (i < Nb - blockSize); i++){
+                e->datos[c][b][i] = 0.0f;
+            }
+        }
+    }
 
-        h[i][REAL] = 0.0;
+    //El espectro compuesto inicia en cero; el primer bloque lo construye con las ganancias actuales.
+    e->hc = (complejo*) Precision::reservar(sizeof(complejo) * terminos);
+    memset(e->hc,0,sizeof(complejo) * terminos);
+    for(int b = 0; b < bandas_; b++){
+        e->gananciasHc[b] = 0;
+    }
+    e->actualizacionesHc = 0;
+    e->rangoHc.desde = 0;
+    e->rangoHc.hasta = 0;
+    e->hcCompleto = (canales_ > 1) ? (complejo*) Precision::reservar(sizeof(complejo) * N) : 0;
+    e->hcCompletoAlDia = false;
+    for(int c = 0; c < MaxCanales; c++){
+        e->datosHc[c] = (c < canales_) ? new float[e->historia] : 0;
+        for(int i = 0; (c < canales_) && (i < e->historia); i++){
+            e->datosHc[c][i] = 0.0f;
+        }
+    }
 
+    // Memoria de trabajo del hilo de tiempo real. Se reserva una sola vez por estado y
+    // cada bloque usa la misma distribucion; cada arreglo inicia en una linea de cache.
+    const int paso = ((blockSize + 15)/16)*16;
+    const int arreglos = 2*canales_ + canales_*bandas_ + 1;
+    e->arena = (float*) Precision::reservar(sizeof(float) * paso * arreglos);
+    memset(e->arena,0,sizeof(float) * paso * arreglos);
+    for(int c = 0; c < MaxCanales; c++){
+        e->tmpOut[c] = (c < canales_) ? e->arena + c*paso : 0;
+        e->tmpLargas[c] = (c < canales_) ? e->arena + (canales_+c)*paso : 0;
+    }
+    for(int c = 0; c < MaxCanales; c++){
+        for(int b = 0; b < bandas_; b++){
+            e->salidas[c][b] = (c < canales_) ? e->arena + (2*canales_+c*bandas_+b)*paso : 0;
+        }
+    }
+    e->procesado = e->arena + (2*canales_+canales_*bandas_)*paso;
+
+    // Particiones de MotorParticionado: el bloque se divide a la mitad hasta que
+    // la particion no exceda ParticionMaxima, de modo que siempre divide al bloque.
+    // Un canal con fuente usa las tablas particionadas de la fuente, que tiene la misma.
+    if(f != 0){
+        e->conv = new partConvolver<Precision>(bandas_);
+        e->conv->compartir(*f->conv,canales_ > 1);
+        e->largas = new partConvolver<Precision>(bandas_);
+        e->largas->compartir(*f->largas,canales_ > 1);
+        return e;
+    }
+    int particion = blockSize;
+    while((particion > ParticionMaxima) && (particion % 2 == 0)){
+        particion /= 2;
     }
+    // MotorParticionado usa el largo medido de cada banda; los demas motores solo
+    // pasan por aqui las bandas largas.
+    crearPlanes(2 * particion,flags,e);
+    int soloLargas[MaxBandas];
+    for(int b = 0; b < bandas_; b++){
+        soloLargas[b] = d->larga[b] ? d->largos[b] : 0;
+    }
+    e->conv = new partConvolver<Precision>(bandas_);
+    e->conv->preparar(particion,d->largos,d->respuestas,
+                      buscarPlan(2 * particion,PlanDirecto),
+                      buscarPlan(2 * particion,PlanInverso),
+                      buscarPlan(2 * particion,PlanComplejoDirecto),
+                      buscarPlan(2 * particion,PlanComplejoInverso));
+    e->largas = new partConvolver<Precision>(bandas_);
+    e->largas->preparar(particion,soloLargas,d->respuestas,
+                        buscarPlan(2 * particion,PlanDirecto),
+                        buscarPlan(2 * particion,PlanInverso),
+                        buscarPlan(2 * particion,PlanComplejoDirecto),
+                        buscarPlan(2 * particion,PlanComplejoInverso));
+
+    return e;
+}
 
-    //Se inicializan la parte imaginaria en cero debido a que la respuesta al impulso es real.
-    for(int i =0;i<N;i++){
+/**
+ * @brief crearTablas Crea los planes y calcula las tablas H(k), sus rangos y los factores de los medidores de un estado.
+ * @param d filtros de la frecuencia de muestreo del estado.
+ * @param e estado con el tamano de bloque, el largo N y los buffers de trabajo ya fijados.
+ * @param flags bandera de planeacion de FFTW.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::crearTablas(DisenoTasa* d, EstadoBloque* e, unsigned flags){
+
+    const int blockSize = e->blockSize;
+    const int N = e->largoDFT;
+    const int terminos = N/2 + 1;
+
+    crearPlanes(N,flags,e);
+    e->dft = buscarPlan(N,PlanDirecto);
+    e->idft = buscarPlan(N,PlanInverso);
+    e->zdft = buscarPlan(N,PlanComplejoDirecto);
+    e->zidft = buscarPlan(N,PlanComplejoInverso);
+
+    // H(k) de cada banda: DFT real de h(n) rellenada con ceros hasta N puntos. Todas las
+    // tablas van en un solo bloque alineado, una banda tras otra. Las bandas largas no
+    // caben y quedan en cero; se aplican con la convolucion particionada.
+    e->tablasH = (complejo*) Precision::reservar(sizeof(complejo) * terminos * bandas_);
+    for(int b = 0; b < bandas_; b++){
+        const int largo = d->larga[b] ? 0 : d->largos[b];
+        for(int i = 0; i < N; i++){
+            e->x[i] = (i < largo) ? static_cast<real>(d->respuestas[b][i]) : real(0);
+        }
+        e->tablas[b] = e->tablasH + b*terminos;
+        Precision::directa(e->dft,e->x,e->tablas[b]);
+        rangoSignificativo(e->tablas[b],terminos,umbralBins_,e->rangos[b].desde,e->rangos[b].hasta);
+    }
 
-        h[i][IMAG] = 0.0;
+    // MotorBandas aplica cada banda corta con la menor DFT en la que cabe su propia h(n).
+    int terminosBandas = 0;
+    for(int b = 0; b < bandas_; b++){
+        const int largo = d->larga[b] ? 0 : d->largos[b];
+        int Nb = 1;
+        while(Nb < blockSize + std::max(1,largo) - 1){
+            Nb *= 2;
+        }
+        e->largoBanda[b] = Nb;
+        crearPlanes(Nb,flags,e);
+        e->dftBanda[b] = buscarPlan(Nb,PlanDirecto);
+        e->idftBanda[b] = buscarPlan(Nb,PlanInverso);
+        terminosBandas += Nb/2 + 1;
+    }
+    e->tablasBandas = (complejo*) Precision::reservar(sizeof(complejo) * terminosBandas);
+    complejo* siguiente = e->tablasBandas;
+    for(int b = 0; b < bandas_; b++){
+        const int largo = d->larga[b] ? 0 : d->largos[b];
+        const int Nb = e->largoBanda[b];
+        for(int i = 0; i < Nb; i++){
+            e->x[i] = (i < largo) ? static_cast<real>(d->respuestas[b][i]) : real(0);
+        }
+        e->tablaBanda[b] = siguiente;
+        Precision::directa(e->dftBanda[b],e->x,e->tablaBanda[b]);
+        rangoSignificativo(e->tablaBanda[b],Nb/2 + 1,umbralBins_,e->rangosBanda[b].desde,e->rangosBanda[b].hasta);
+        siguiente += Nb/2 + 1;
+    }
 
+    // Factores para evaluar la muestra central del bloque de salida (n = N-B + B/2)
+    // que leen los medidores del espectro.
+    e->giro = (complejo*) Precision::reservar(sizeof(complejo) * terminos);
+    int n0 = e->historia + blockSize/2;
+    for(int k = 0; k < terminos; k++){
+        double angulo = 2.0 * PI * double((static_cast<long long>(k) * n0) % N) / N;
+        e->giro[k][REAL] = cos(angulo);
+        e->giro[k][IMAG] = sin(angulo);
     }
+}
 
-    //Se aplica la DFT.
-    fftw_plan plan = fftw_plan_dft_1d(N,h,puntero,FFTW_FORWARD,FFTW_ESTIMATE);
-    fftw_execute(plan);
+/**
+ * @brief liberarEstado Libera la memoria de un estado.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::liberarEstado(EstadoBloque* e){
 
-    //Se libera la memoria.
-    fftw_destroy_plan(plan);
-    fftw_free(h);
-    fftw_cleanup();
+    if(e->prestado != 0){
+        std::lock_guard<std::mutex> lock(fuente_->cacheMutex_);
+        --e->prestado->prestamos;
+    } else {
+        Precision::liberar(e->tablasH);
+        Precision::liberar(e->tablasBandas);
+        Precision::liberar(e->giro);
+    }
+    for(int c = 0; c < MaxCanales; c++){
+        for(int b = 0; b < bandas_; b++){
+            delete[] e->datos[c][b];
+        }
+        delete[] e->datosHc[c];
+    }
+    Precision::liberar(e->hc);
+    Precision::liberar(e->hcCompleto);
+    Precision::liberar(e->x);
+    Precision::liberar(e->X);
+    Precision::liberar(e->Y);
+    Precision::liberar(e->y);
+    for(int h = 1; h < e->trabajos; h++){
+        Precision::liberar(e->xTrabajo[h]);
+        Precision::liberar(e->XTrabajo[h]);
+        Precision::liberar(e->YTrabajo[h]);
+        Precision::liberar(e->yTrabajo[h]);
+    }
+    Precision::liberar(e->z);
+    Precision::liberar(e->Z);
+    Precision::liberar(e->arena);
+    delete e->conv;
+    delete e->largas;
+    delete e;
+}
 
+/**
+ * @brief crearPlanes Crea, si no existen, los planes reales y complejos de N puntos.
+ * @param N largo de la transformada; debe caber en los buffers del estado.
+ * @param flags bandera de planeacion de FFTW.
+ * @param e estado sobre cuyos buffers se planea.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::crearPlanes(int N, unsigned flags, EstadoBloque* e){
+
+    // FFTW_MEASURE y FFTW_PATIENT sobreescriben los arreglos durante la
+    // planeacion, por eso se planea sobre los buffers de trabajo. Todos se
+    // reservan con fftw_malloc, por lo que un plan sirve para los buffers de
+    // cualquier estado con fftw_execute_dft_r2c/c2r/dft (o sus versiones fftwf).
+    // Los planes complejos son fuera de lugar, entre z y Z.
+    if(buscarPlan(N,PlanDirecto) == 0){
+        planes_[std::make_pair(N,int(PlanDirecto))] =
+            Precision::planDirecto(N,e->x,e->X,flags);
+    }
+    if(buscarPlan(N,PlanInverso) == 0){
+        planes_[std::make_pair(N,int(PlanInverso))] =
+            Precision::planInverso(N,e->Y,e->y,flags);
+    }
+    if(buscarPlan(N,PlanComplejoDirecto) == 0){
+        planes_[std::make_pair(N,int(PlanComplejoDirecto))] =
+            Precision::planComplejo(N,e->z,e->Z,FFTW_FORWARD,flags);
+    }
+    if(buscarPlan(N,PlanComplejoInverso) == 0){
+        planes_[std::make_pair(N,int(PlanComplejoInverso))] =
+            Precision::planComplejo(N,e->Z,e->z,FFTW_BACKWARD,flags);
+    }
 }
-void controlVolume::inicializarH32(){
 
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.0000051726440015777536390439301;
-    double a_0 = 1.0;
-    double b_0 = -3.9983645237106202330323867;
-    double c_0 = 4.996729047853150973423908;
-    double e_0 = -4.996729047853150973423908;
-    double f_0 = 3.9983645237106202330323867;
-    double g_0 = -1.0;
+/**
+ * @brief latencia Latencia algoritmica en muestras del motor actual.
+ */
+template<typename Precision>
+int basicControlVolume<Precision>::latencia() const{
+
+    return (motor == MotorMultitasa) ? retardoMultitasa_.load() : 0;
+}
 
-    double b_1 = 5.9967453132568113716160951;
-    double c_1 = -14.983801901853976090706055;
-    double d_1 = 19.9677543230578251609586;
-    double e_1 = -14.967904692182449011284007;
-    double f_1 = 5.9840274563218738279601894;
-    double g_1 = -0.99682049860009280806139031;
+/**
+ * @brief reportarRespuestas Escribe el largo de h(n) y el error de truncamiento de cada banda del diseno publicado.
+ * @param os flujo de salida.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::reportarRespuestas(std::ostream& os){
 
-    //Se almacenan en el arreglo asociado a el filtro de 32Hz los valores de su H(k).
-    inicializarHK(f32,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
+    std::lock_guard<std::mutex> lock(cacheMutex_);
 
+    const EstadoBloque* e = actual_.load();
+    if(e == 0){
+        return;
+    }
+    const DisenoTasa* d = e->diseno;
+
+    os << "controlVolume: respuestas al impulso a " << d->sampleRate << " Hz" << endl;
+    for(int b = 0; b < bandas_; b++){
+        os << "  banda " << b << " (" << banco_.banda(b).inferior << "-" << banco_.banda(b).superior << " Hz): ";
+        if(d->largos[b] == 0){
+            os << "anulada" << endl;
+            continue;
+        }
+        os << d->largos[b] << " muestras, " << (d->larga[b] ? "particionada" : "una DFT")
+           << ", cola descartada ";
+        if(std::isinf(d->errores[b])){
+            os << "nula" << endl;
+        } else {
+            os << d->errores[b] << " dB" << endl;
+        }
+    }
 }
-void controlVolume::inicializarH64(){
 
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.000010341142425214124028623811;
-    double a_0 = 1.0;
-    double b_0 = -3.9934658733542631736668227;
-    double c_0 = 4.9869317536107633515030102;
-    double e_0 = -4.9869317536107633515030102;
-    double f_0 = 3.9934658733542631736668227;
-    double g_0 = -1.0;
-
-    double b_1 = 5.9933505401304589810251855;
-    double c_1 = -14.967054483387533636573608;
-    double d_1 = 19.934711294803655334817449;
-    double e_1 = -14.935312410443541963900316;
-    double f_1 = 5.9679561693283540435572831;
-    double g_1 = -0.99365111043196252538223234;
-
-    //Se almacenan en el arreglo asociado a el filtro de 64Hz los valores de su H(k).
-    inicializarHK(f64,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-}
-void controlVolume::inicializarH125(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.000019738188870821139823908894;
-    double a_0 = 1.0;
-    double b_0 = -3.9763100468322947200761064;
-    double c_0 = 4.9526201985423163876021135;
-    double e_0 = -4.9526201985423163876021135;
-    double f_0 = 3.9763100468322947200761064;
-    double g_0 = -1.0;
-
-    double b_1 = 5.9867734651203612372682983;
-    double c_1 = -14.935035264418475620118443;
-    double d_1 = 19.872396905624650997879144;
-    double e_1 = -14.874714159791597722914958;
-    double f_1 = 5.9385113334062298307003402;
-    double g_1 = -0.98793227997522281569331426;
+/**
+ * @brief usarUmbralBins Fija el umbral bajo el cual los terminos de H(k) de una banda se tratan como cero.
+ * @param dB umbral relativo al maximo de |H(k)| de cada banda, en dB.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::usarUmbralBins(double dB){
 
-    //Se almacenan en el arreglo asociado a el filtro de 125Hz los valores de su H(k).
-    inicializarHK(f125,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    umbralBins_ = (dB >= 0.0) ? 0.0 : pow(10.0,dB/20.0);
 }
-void controlVolume::inicializarH250(){
 
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.000040929054711206818079668318;
-    double a_0 = 1.0;
-    double b_0 = -3.902501155624368944785374;
-    double c_0 = 4.8050038824718228624988114;
-    double e_0 = -4.8050038824718228624988114;
-    double f_0 = 3.902501155624368944785374;
-    double g_0 = -1.0;
-
-    double b_1 = 5.970858033075922222110421;
-    double c_1 = -14.858935846164756711118571;
-    double d_1 = 19.72708134746538988224529;
-    double e_1 = -14.736215153719255610553773;
-    double f_1 = 5.8726394387280063114076256;
-    double g_1 = -0.97542782140164918658342685;
-
-    //Se almacenan en el arreglo asociado a el filtro de 250Hz los valores de su H(k).
-    inicializarHK(f250,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-
-}
-void controlVolume::inicializarH500(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.000086593064180069152921057074;
-    double a_0 = 1.0;
-    double b_0 = -3.6358483439687612204238576;
-    double c_0 = 4.2717201469857393192341988;
-    double e_0 = -4.2717201469857393192341988;
-    double f_0 = 3.6358483439687612204238576;
-    double g_0 = -1.0;
-
-    double b_1 = 5.9332745075537252077424455;
-    double c_1 = -14.685204622617673564377583;
-    double d_1 = 19.407335230768644862564543;
-    double e_1 = -14.443617387617392111565096;
-    double f_1 = 5.7396734044529704732440223;
-    double g_1 = -0.95146125988497265435483996;
-
-    //Se almacenan en el arreglo asociado a el filtro de 500Hz los valores de su H(k).
-    inicializarHK(f500,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-}
-void controlVolume::inicializarH1k(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.000213804126957497;
-    double a_0 = 1.0;
-    double b_0 = -2.8486080392648727155;
-    double c_0 = 2.6975120363417355307;
-    double e_0 = -2.6975120363417355307;
-    double f_0 = 2.8486080392648727155;
-    double g_0 = -1.0;
-
-    double b_1 = 5.8333303089089971749;
-    double c_1 = -14.244364370759852179;
-    double d_1 = 18.636922806015558507;
-    double e_1 = -13.779420871523798908;
-    double f_1 = 5.4588165829462678147;
-    double g_1 = -0.90529237899539838352;
-
-    //Se almacenan en el arreglo asociado a el filtro de 1kHz los valores de su H(k).
-    inicializarHK(f1k,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-}
-void controlVolume::inicializarH2k(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.00074926873545703097899417511;
-    double a_0 = 1.0;
-    double b_0 = -1.4947375892812146958021913;
-    double c_0 = -0.0079745402897966055633105498;
-    double e_0 = 0.0079745402897966055633105498;
-    double f_0 = 1.4947375892812146958021913;
-    double g_0 = -1.0;
-
-    double b_1 = 5.5387754475048005531334638;
-    double c_1 = -13.029374739156493134828452;
-    double d_1 = 16.651554296506425600910006;
-    double e_1 = -12.191866778059177178761274;
-    double f_1 = 4.8500890150686037927130201;
-    double g_1 = -0.81965335930735705449734496;
-
-    //Se almacenan en el arreglo asociado a el filtro de 2kHz los valores de su H(k).
-    inicializarHK(f2k,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-
-}
-void controlVolume::inicializarH4k(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.0038620598365113022187866676;
-    double a_0 = 1.0;
-    double b_0 = -0.4538632308826702210780013;
-    double c_0 = -2.0784018774208239399570175;
-    double e_0 = 2.0784018774208239399570175;
-    double f_0 = 0.4538632308826702210780013;
-    double g_0 = -1.0;
-
-    double b_1 = 4.6144062374193630660101917;
-    double c_1 = -9.6764649201924619603687461;
-    double d_1 = 11.642260519904482407582691;
-    double e_1 = -8.4704561841444778735876753;
-    double f_1 = 3.5365447408459269595937258;
-    double g_1 = -0.67244749821832905389840107;
-
-    //Se almacenan en el arreglo asociado a el filtro de 4kHz los valores de su H(k).
-    inicializarHK(f4k,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-}
-void controlVolume::inicializarH8k(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.023485908459061365094466822;
-    double a_0 = 1.0;
-    double b_0 = -0.053294510377427606329092669;
-    double c_0 = -2.8410023434563282940246154;
-    double e_0 = 2.8410023434563282940246154;
-    double f_0 = 0.053294510377427606329092669;
-    double g_0 = -1.0;
-
-    double b_1 = 1.8584813304477576512141468;
-    double c_1 = -3.0324829142244507096393136;
-    double d_1 = 2.8064965808216433273969415;
-    double e_1 = -2.3723134094008937466924181;
-    double f_1 = 1.0888038141957738780263298;
-    double g_1 = -0.4546435756375884484903338;
-
-    //Se almacenan en el arreglo asociado a el filtro de 8kHz los valores de su H(k).
-    inicializarHK(f8k,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
-
-}
-void controlVolume::inicializarH16k(){
-
-    //Coeficientes obtenidos al generar la funcion de transferencia y ecuacion de diferencias de los filtros de orden 6.
-    double G = 0.10997904749987028050206561;
-    double a_0 = 1.0;
-    double b_0 = 0.030250891271815127936406498;
-    double c_0 = -2.9393565409747353101010958;
-    double e_0 = 2.9393565409747353101010958;
-    double f_0 = -0.030250891271815127936406498;
-    double g_0 = -1.0;
-
-    double b_1 = -3.3343994032731112397982542;
-    double c_1 = -4.7727334282323425895810942;
-    double d_1 = -4.3522525193891041794813646;
-    double e_1 = -2.9690684783118825862402446;
-    double f_1 = -1.2885809650908786050393928;
-    double g_1 = -0.23414890805816163110719685;
-
-    //Se almacenan en el arreglo asociado a el filtro de 16kHz los valores de su H(k).
-    inicializarHK(f16k,G,a_0,b_0,c_0,e_0,f_0,g_0,b_1,c_1,d_1,e_1,f_1,g_1);
+/**
+ * @brief buscarPlan Retorna el plan guardado para el largo y el tipo dados, o 0 si no existe.
+ * @param N largo de la transformada.
+ * @param tipo PlanDirecto, PlanInverso, PlanComplejoDirecto o PlanComplejoInverso.
+ */
+template<typename Precision>
+typename basicControlVolume<Precision>::plan basicControlVolume<Precision>::buscarPlan(int N, int tipo) const{
+
+    typename planCache_type::const_iterator it = planes_.find(std::make_pair(N,tipo));
+    return (it == planes_.end()) ? 0 : it->second;
 }
 
 /**
@@ -391,101 +880,474 @@ void controlVolume::inicializarH16k(){
  * @param volumeGain numero entero que representa el escalado que se aplica a cada valor de la salida calculada.
  * @param in puntero al arreglo de valores de tipo float que conforman la entrada del sistema.
  * @param out puntero a un arreglo de valores tipo float que conforman la salida del ecualizador y son enviados a la tarjeta de audio a reproducirse.
- * @param hk puntero a un arreglo que contiene los valores complejos de H(k) de un filtro especifico.
+ * @param banda indice de la banda; se usan su tabla H(k) y su largo de DFT N_b.
  * @param temporal puntero al arreglo donde se almacenan los valores de la salida anterior que no se utilizaron y se guardaran los M-1 datos que sobren al filtrar.
+ * @param hilo juego de buffers de trabajo del estado que se utiliza.
+ *
+ * Se usan transformadas real a complejo / complejo a real. La salida coincide con la
+ * version de transformadas complejas dentro del redondeo de la conversion a float
+ * (diferencia maxima menor a 1e-6 relativa al pico de la senal).
  */
-void controlVolume::filtroGeneral(int blockSize, int volumeGain, float *in, float *out, fftw_complex *hk, float *temporal){
+template<typename Precision>
+void basicControlVolume<Precision>::filtroGeneral(int blockSize, int volumeGain, float *in, float *out, int banda, float *temporal, int hilo){
 
-    int dobleBloque = 2 * blockSize;
+    //Se utilizan los planes y buffers del estado del tamano de bloque actual. En el hilo de tiempo real nunca se planea.
+    EstadoBloque* e = enUso_;
 
-   //Inicializan los arreglos que almacenaran a x(n), X(k), y(n), Y(k).
-    fftw_complex *x = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * dobleBloque);
-    fftw_complex *X = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * dobleBloque);
-    fftw_complex *Y = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * dobleBloque);
-    fftw_complex *y = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * dobleBloque);
-
-    // CAMBIO
-    // Se agregan los valores que se van a utilizar en el bloque
-    if(inicio){
+    if((e == 0) || (e->blockSize != blockSize) || (hilo >= e->trabajos)){
         for(int i = 0; i < blockSize; i++){
+            out[i] = 0.0f;
+        }
+        return;
+    }
+
+    int N = e->largoBanda[banda];
+    int historia = N - blockSize; // N-B muestras anteriores que necesita la cola de h(n)
+    int terminos = N/2 + 1;       // N/2+1 terminos no redundantes de X(k), H(k) y Y(k)
+    complejo *hk = e->tablaBanda[banda];
+
+   //Se utilizan los buffers reservados del hilo que almacenan a x(n), X(k), y(n), Y(k).
+    real *x = e->xTrabajo[hilo];
+    complejo *X = e->XTrabajo[hilo];
+    complejo *Y = e->YTrabajo[hilo];
+    real *y = e->yTrabajo[hilo];
+
+    // Se agregan los valores que se van a utilizar en el bloque: x(n) = [historia, bloque actual]
+    for(int i = 0; i < historia; i++){
+
+        // Si es el inicio, la historia inicia en 0s
+        x[i] = inicio ? real(0) : temporal[i];
+
+    }
+    for(int i = historia; i < N; i++){
+
+        x[i] = in[i-historia];
+
+    }
+
+    // Se guardan las ultimas N-B muestras en temporal, para ser utilizadas en el siguiente ciclo
+    for(int i = 0; i < historia; i++){
+
+        temporal[i] = static_cast<float>(x[blockSize+i]);
 
-            // Si es el inicio, el bloque inicia en 0s
-            x[i][REAL] = 0.0;
-            x[i][IMAG] = 0.0;
+    }
+
+    //Se aplica la DFT real a x(n) para obtener los N/2+1 terminos de X(k).
+    Precision::directa(e->dftBanda[banda],x,X);
+
+    /*Se realiza la multiplicacion de los valores complejos de X(k)H(k) = Y(k)
+      A ser valores complejos dados en parte real e imaginaria se utiliza:
+        Re{Y(k)} = Re{X(k)}*Re{H(k)} - Im{X(k)}*Im{H(k)}
+        Im{Y(k)} = Re{X(k)}*Im{H(k)} + Re{H(k)}*Im{X(k)}
+      Solo se multiplican los N/2+1 terminos; el resto es el conjugado simetrico. */
+
+    //Fuera del rango significativo de la banda H(k) se trata como cero.
+    const RangoBins& rango = e->rangosBanda[banda];
+    memset(Y,0,sizeof(complejo) * rango.desde);
+    Precision::multiplicar(nucleos_,X + rango.desde,hk + rango.desde,Y + rango.desde,rango.hasta - rango.desde);
+    memset(Y + rango.hasta,0,sizeof(complejo) * (terminos - rango.hasta));
+
+    //Se aplica la IDFT complejo a real a Y(k) para obtener y(n). Y(k) queda destruido.
+    Precision::inversa(e->idftBanda[banda],Y,y);
+
+    double Div = static_cast<double>(N);
+
+    // Se almacenan los valores actuales en la salida (a partir de N-B), utilizando la ganancia del filtro
+    for(int i=0; i<blockSize;i++){
+       out[i] = static_cast<float>(0.02 * (volumeGain)* (y[historia+i]/Div));
+
+    }
+}
 
+/**
+ * @brief actualizarCompuesto Actualiza Hc(k) de forma incremental (Hc += 0.02*dg*H_i) para las bandas cuya ganancia cambio.
+ * @param ganancias posicion de los sliders de cada banda.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::actualizarCompuesto(const int* ganancias){
+
+    EstadoBloque* e = enUso_;
+    const int terminos = e->largoDFT/2 + 1;
+
+    // Cada cierta cantidad de actualizaciones se reconstruye Hc(k) desde cero para que
+    // el error de redondeo acumulado por las sumas incrementales no crezca.
+    if(e->actualizacionesHc >= 1024){
+        for(int k = 0; k < terminos; k++){
+            e->hc[k][REAL] = 0.0;
+            e->hc[k][IMAG] = 0.0;
+        }
+        for(int b = 0; b < bandas_; b++){
+            e->gananciasHc[b] = 0;
         }
-        for(int i = blockSize; i< dobleBloque; i++){
+        e->actualizacionesHc = 0;
+        e->hcCompletoAlDia = false;
+    }
 
-            // Se guarda el valor actual en temporal, para ser utilizado en el siguiente ciclo
-            // y se agregan los valores de entrada
-            temporal[i-blockSize] = in[i-blockSize];
-            x[i][REAL] = in[i-blockSize];
-            x[i][IMAG] = 0.0;
+    bool cambio = false;
+    for(int b = 0; b < bandas_; b++){
+        if(ganancias[b] != e->gananciasHc[b]){
+            const real delta = 0.02 * (ganancias[b] - e->gananciasHc[b]);
+            // Hc(k) += delta*H(k) en el rango de la banda, tratando los complejos como pares de reales.
+            const RangoBins& r = e->rangos[b];
+            Precision::acumularEscalado(nucleos_,e->tablas[b][r.desde],delta,e->hc[r.desde],2*(r.hasta - r.desde));
+            e->gananciasHc[b] = ganancias[b];
+            ++e->actualizacionesHc;
+            e->hcCompletoAlDia = false;
+            cambio = true;
+        }
+    }
 
+    // Hc(k) solo se recorre en la union de los rangos de las bandas con ganancia.
+    if(cambio){
+        e->rangoHc.desde = terminos;
+        e->rangoHc.hasta = 0;
+        for(int b = 0; b < bandas_; b++){
+            const RangoBins& r = e->rangos[b];
+            if((e->gananciasHc[b] != 0) && (r.hasta > r.desde)){
+                e->rangoHc.desde = std::min(e->rangoHc.desde,r.desde);
+                e->rangoHc.hasta = std::max(e->rangoHc.hasta,r.hasta);
+            }
         }
-    } else {
+        if(e->rangoHc.hasta == 0){
+            e->rangoHc.desde = 0;
+        }
+    }
+}
+
+/**
+ * @brief filtroCompuesto Aplica todas las bandas con una sola DFT directa e inversa utilizando el espectro compuesto Hc(k).
+ * @param blockSize numero de elementos que contiene la entrada.
+ * @param ganancias posicion del slider de cada banda, en el orden de bandas().
+ * @param in puntero al arreglo de valores de tipo float que conforman la entrada del sistema.
+ * @param out puntero al arreglo donde se almacena la suma de las salidas de todas las bandas.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::filtroCompuesto(int blockSize, const int* ganancias, float* in, float* out){
+
+    EstadoBloque* e = enUso_;
+
+    if((e == 0) || (e->blockSize != blockSize)){
+        for(int i = 0; i < blockSize; i++){
+            out[i] = 0.0f;
+        }
+        return;
+    }
+
+    int N = e->largoDFT;
+    int historia = e->historia;
+    int terminos = N/2 + 1;
+
+    actualizarCompuesto(ganancias);
+
+    // x(n) = [historia, bloque actual], igual que en filtroGeneral pero con una sola historia.
+    for(int i = 0; i < historia; i++){
+        e->x[i] = inicio ? real(0) : e->datosHc[0][i];
+    }
+    for(int i = 0; i < blockSize; i++){
+        e->x[historia+i] = in[i];
+    }
+    for(int i = 0; i < historia; i++){
+        e->datosHc[0][i] = static_cast<float>(e->x[blockSize+i]);
+    }
+
+    Precision::directa(e->dft,e->x,e->X);
+
+    // Y(k) = X(k)Hc(k) en el rango de Hc(k) y cero fuera de el. X(k) se conserva para que
+    // los medidores evaluen cada banda.
+    const RangoBins& rango = e->rangoHc;
+    memset(e->Y,0,sizeof(complejo) * rango.desde);
+    Precision::multiplicar(nucleos_,e->X + rango.desde,e->hc + rango.desde,e->Y + rango.desde,rango.hasta - rango.desde);
+    memset(e->Y + rango.hasta,0,sizeof(complejo) * (terminos - rango.hasta));
+
+    Precision::inversa(e->idft,e->Y,e->y);
+
+    double Div = static_cast<double>(N);
+
+    // Las ganancias de cada banda ya estan incluidas en Hc(k).
+    for(int i = 0; i < blockSize; i++){
+        out[i] = static_cast<float>(e->y[historia+i]/Div);
+    }
+}
+
+/**
+ * @brief filtroCompuestoEstereo Aplica Hc(k) a dos canales con una sola DFT compleja de N puntos.
+ * @param blockSize numero de elementos que contiene cada canal.
+ * @param ganancias posicion del slider de cada banda, en el orden de bandas().
+ * @param inL entrada del canal izquierdo.
+ * @param inR entrada del canal derecho.
+ * @param outL suma de las bandas del canal izquierdo.
+ * @param outR suma de las bandas del canal derecho.
+ *
+ * Una DFT compleja de N puntos cuesta lo mismo que dos reales, pero se ahorra
+ * el manejo de dos juegos de buffers y la multiplicacion recorre un solo arreglo.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::filtroCompuestoEstereo(int blockSize, const int* ganancias, float* inL, float* inR, float* outL, float* outR){
+
+    EstadoBloque* e = enUso_;
+
+    if((e == 0) || (e->blockSize != blockSize)){
         for(int i = 0; i < blockSize; i++){
+            outL[i] = 0.0f;
+            outR[i] = 0.0f;
+        }
+        return;
+    }
+
+    int N = e->largoDFT;
+    int historia = e->historia;
+    int terminos = N/2 + 1;
 
-            // Se utilizan los valores almacenados previamente en temporal
-            x[i][REAL] = temporal[i];
-            x[i][IMAG] = 0.0;
+    actualizarCompuesto(ganancias);
 
+    // Hc(k) se extiende a los N terminos solo cuando cambio alguna ganancia.
+    if(!e->hcCompletoAlDia){
+        memcpy(e->hcCompleto,e->hc,sizeof(complejo) * terminos);
+        for(int k = terminos; k < N; k++){
+            e->hcCompleto[k][REAL] = e->hc[N-k][REAL];
+            e->hcCompleto[k][IMAG] = -e->hc[N-k][IMAG];
         }
-        for(int i = blockSize; i< dobleBloque; i++){
+        e->hcCompletoAlDia = true;
+    }
+
+    // z(n) = xL(n) + j xR(n), con x = [historia, bloque actual] en cada canal.
+    for(int i = 0; i < historia; i++){
+        e->z[i][REAL] = inicio ? real(0) : e->datosHc[0][i];
+        e->z[i][IMAG] = inicio ? real(0) : e->datosHc[1][i];
+    }
+    for(int i = 0; i < blockSize; i++){
+        e->z[historia+i][REAL] = inL[i];
+        e->z[historia+i][IMAG] = inR[i];
+    }
+    for(int i = 0; i < historia; i++){
+        e->datosHc[0][i] = static_cast<float>(e->z[blockSize+i][REAL]);
+        e->datosHc[1][i] = static_cast<float>(e->z[blockSize+i][IMAG]);
+    }
 
-            // Se guarda el valor actual en temporal, para ser utilizado en el siguiente ciclo
-            // y se agregan los valores de entrada
-            temporal[i-blockSize] = in[i-blockSize];
-            x[i][REAL] = in[i-blockSize];
-            x[i][IMAG] = 0.0;
+    Precision::compleja(e->zdft,e->z,e->Z);
 
+    // Los medidores evaluan las bandas sobre el espectro del canal izquierdo,
+    // XL(k) = (Z(k) + Z*(N-k))/2, que se deja en X(k) como en el caso mono.
+    if(medirBandas){
+        for(int k = 0; k < terminos; k++){
+            const int espejo = (k == 0) ? 0 : N-k;
+            e->X[k][REAL] = 0.5f*(e->Z[k][REAL] + e->Z[espejo][REAL]);
+            e->X[k][IMAG] = 0.5f*(e->Z[k][IMAG] - e->Z[espejo][IMAG]);
         }
     }
 
-    //Se aplica la DFT a x(n) para obtener X(k).
-    fftw_plan dft = fftw_plan_dft_1d(dobleBloque,x,X,FFTW_FORWARD,FFTW_ESTIMATE);
-    fftw_execute(dft);
+    // Y(k) = Z(k)Hc(k) sobre los N terminos; la parte real de la IDFT es el
+    // canal izquierdo y la imaginaria el derecho. Hc(k) solo es distinto de cero
+    // en [desde,hasta) y en su reflejo (N-hasta,N-desde].
+    const int desde = e->rangoHc.desde;
+    const int hasta = e->rangoHc.hasta;
+    const int reflejoDesde = std::min(N,std::max(terminos,N - hasta + 1));
+    const int reflejoHasta = std::max(reflejoDesde,std::min(N,N - desde + 1));
+    memset(e->Z,0,sizeof(complejo) * desde);
+    Precision::multiplicar(nucleos_,e->Z + desde,e->hcCompleto + desde,e->Z + desde,hasta - desde);
+    memset(e->Z + hasta,0,sizeof(complejo) * (reflejoDesde - hasta));
+    Precision::multiplicar(nucleos_,e->Z + reflejoDesde,e->hcCompleto + reflejoDesde,e->Z + reflejoDesde,
+                                reflejoHasta - reflejoDesde);
+    memset(e->Z + reflejoHasta,0,sizeof(complejo) * (N - reflejoHasta));
+
+    Precision::compleja(e->zidft,e->Z,e->z);
+
+    double Div = static_cast<double>(N);
+
+    for(int i = 0; i < blockSize; i++){
+        outL[i] = static_cast<float>(e->z[historia+i][REAL]/Div);
+        outR[i] = static_cast<float>(e->z[historia+i][IMAG]/Div);
+    }
+}
 
-    /*Se realiza la multiplicacion de los valores complejos de X(k)H(k) = Y(k)
-      A ser valores complejos dados en parte real e imaginaria se utiliza:
-        Re{Y(k)} = Re{X(k)}*Re{H(k)} - Im{X(k)}*Im{H(k)}
-        Im{Y(k)} = Re{X(k)}*Im{H(k)} + Re{H(k)}*Im{X(k)} */
+/**
+ * @brief filtroLargas Calcula en tmpLargas la salida de las bandas largas, aplicadas con la convolucion particionada largas.
+ * @param canales 1 o 2.
+ * @param blockSize numero de elementos del bloque.
+ * @param pesos ganancia de cada banda; las bandas cortas se ignoran.
+ * @param in entrada de cada canal.
+ *
+ * Los medidores de las bandas largas quedan en muestrasBanda_.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::filtroLargas(int canales, int blockSize, const double* pesos, float* const* in){
+
+    EstadoBloque* e = enUso_;
+
+    if(e->diseno->cantidadLargas == 0){
+        return;
+    }
+    if(inicio){
+        e->largas->reiniciar();
+    }
+
+    float* muestras = medirBandas ? muestrasBanda_ : 0;
+    if(canales == 1){
+        e->largas->filtrar(blockSize,in[0],pesos,e->tmpLargas[0],muestras);
+    } else {
+        e->largas->filtrarEstereo(blockSize,in[0],in[1],pesos,e->tmpLargas[0],e->tmpLargas[1],muestras);
+    }
+}
 
-    for(int i = 0;i<dobleBloque;i++){
+/**
+ * @brief sumarLargas Suma tmpLargas a tmpOut si hay bandas largas.
+ * @param canales 1 o 2.
+ * @param blockSize numero de elementos del bloque.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::sumarLargas(int canales, int blockSize){
 
-        Y[i][REAL] = (X[i][REAL]*hk[i][REAL]) - (X[i][IMAG]*hk[i][IMAG]);
-        Y[i][IMAG] = (X[i][IMAG]*hk[i][REAL]) + (X[i][REAL]*hk[i][IMAG]);
+    EstadoBloque* e = enUso_;
 
+    if(e->diseno->cantidadLargas == 0){
+        return;
+    }
+    for(int c = 0; c < canales; c++){
+        nucleos_.acumularEscaladoF(e->tmpLargas[c],1.0f,e->tmpOut[c],blockSize);
     }
+}
+
+/**
+ * @brief usarHilos Inicia los trabajadores entre los que se reparte cada bloque.
+ * @param hilos cantidad de trabajadores; 0 procesa todo en el hilo de jack.
+ * @param prioridad prioridad SCHED_FIFO de los trabajadores; 0 usa la politica normal.
+ * @return false si algun trabajador no se pudo crear, fijar a su nucleo o subir de prioridad.
+ */
+template<typename Precision>
+bool basicControlVolume<Precision>::usarHilos(int hilos, int prioridad){
 
-    //Se aplica la IDFT a Y(k) para obtener y(n).
-    fftw_plan idft = fftw_plan_dft_1d(dobleBloque,Y,y,FFTW_BACKWARD,FFTW_ESTIMATE);
-    fftw_execute(idft);
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return grupo_.iniciar(hilos,prioridad);
+}
 
-    double Div = static_cast<double>(dobleBloque);
+/**
+ * @brief repartir Ejecuta las tareas de un bloque con grupo_.
+ * @param f funcion de cada tarea.
+ * @param reparto datos del bloque.
+ * @param tareas cantidad de tareas.
+ *
+ * Un estado construido antes de usarHilos() no tiene buffers para los trabajadores,
+ * por lo que sus tareas se ejecutan en orden en este hilo.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::repartir(rtPool::funcion f, Reparto& reparto, int tareas){
 
-    // CAMBIO
-    // Se almacenan los valores actuales en la salida (a partir de M-1), utilizando la ganancia del filtro
-    for(int i=0; i<blockSize;i++){
-       //out[i] = static_cast<float>(0.02 * (volumeGain)* (y[blockSize+i][REAL]/Div));
-       out[i] = static_cast<float>(0.02 * (volumeGain)* (y[blockSize+i][REAL]/Div));
+    if(reparto.e->trabajos > grupo_.hilos()){
+        grupo_.ejecutar(f,&reparto,tareas);
+    } else {
+        for(int t = 0; t < tareas; t++){
+            f(&reparto,t,0);
+        }
+    }
+}
+
+/**
+ * @brief tareaBandas Tarea de MotorBandas: la primera es la convolucion de las bandas largas
+ * (si las hay), la mas costosa, y las demas son cada banda corta de cada canal.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::tareaBandas(void* contexto, int tarea, int hilo){
+
+    Reparto& r = *static_cast<Reparto*>(contexto);
+    if(tarea < r.largas){
+        r.cv->filtroLargas(r.canales,r.blockSize,r.pesosLargas,r.in);
+        return;
+    }
+    const int c = (tarea - r.largas) / r.cortas;
+    const int b = r.banda[(tarea - r.largas) % r.cortas];
+    r.cv->filtroGeneral(r.blockSize,r.ganancias[b],r.in[c],r.e->salidas[c][b],b,r.e->datos[c][b],hilo);
+}
+
+/**
+ * @brief tareaCompuesto Tarea de MotorCompuesto y MotorMultitasa: la primera es la convolucion
+ * de las bandas largas (si las hay) y la otra aplica Hc(k) a todos los canales.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::tareaCompuesto(void* contexto, int tarea, int /*hilo*/){
+
+    Reparto& r = *static_cast<Reparto*>(contexto);
+    if(tarea < r.largas){
+        r.cv->filtroLargas(r.canales,r.blockSize,r.pesosLargas,r.in);
+    } else if(r.canales == 1){
+        r.cv->filtroCompuesto(r.blockSize,r.ganancias,r.in[0],r.e->tmpOut[0]);
+    } else {
+        r.cv->filtroCompuestoEstereo(r.blockSize,r.ganancias,r.in[0],r.in[1],r.e->tmpOut[0],r.e->tmpOut[1]);
+    }
+}
+
+/**
+ * @brief tareaIIR Tarea de MotorIIR: el banco de secciones de segundo orden de un canal.
+ * Los medidores siguen al izquierdo.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::tareaIIR(void* contexto, int tarea, int /*hilo*/){
+
+    Reparto& r = *static_cast<Reparto*>(contexto);
+    basicControlVolume* cv = r.cv;
+    sosBank* banco = r.e->diseno->iir[tarea];
+    if(cv->inicio){
+        banco->reiniciar();
+    }
+    banco->filtrar(r.blockSize,r.in[tarea],r.pesos,r.e->tmpOut[tarea],
+                   (cv->medirBandas && (tarea == 0)) ? cv->muestrasBanda_ : 0);
+}
+
+/**
+ * @brief tareaMultitasa Tarea de MotorMultitasa: el banco multitasa de un canal, que suma las
+ * bandas bajas a tmpOut ya completo con las demas bandas.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::tareaMultitasa(void* contexto, int tarea, int /*hilo*/){
+
+    Reparto& r = *static_cast<Reparto*>(contexto);
+    basicControlVolume* cv = r.cv;
+    multirateBank* banco = r.e->diseno->multitasa[tarea];
+    if(cv->inicio){
+        banco->reiniciar();
+    }
+    banco->filtrar(r.blockSize,r.in[tarea],r.e->tmpOut[tarea],r.pesos,r.e->tmpOut[tarea],
+                   (cv->medirBandas && (tarea == 0)) ? cv->muestrasBanda_ : 0);
+}
+
+/**
+ * @brief muestraBanda Calcula la muestra central del bloque de salida de una banda a partir de X(k), sin IDFT completa.
+ * @param blockSize numero de elementos del bloque.
+ * @param volumeGain posicion del slider de la banda.
+ * @param banda indice de la banda; se usan su tabla H(k) y su rango de terminos.
+ */
+template<typename Precision>
+float basicControlVolume<Precision>::muestraBanda(int blockSize, int volumeGain, int banda) const{
+
+    const EstadoBloque* e = enUso_;
 
+    if((e == 0) || (e->blockSize != blockSize)){
+        return 0.0f;
     }
 
-    //Se libera la memoria.
-    fftw_destroy_plan(dft);
-    fftw_destroy_plan(idft);
-    fftw_free(x);
-    fftw_free(X);
-    fftw_free(y);
-    fftw_free(Y);
-    fftw_cleanup();
+    const int N = e->largoDFT;
+    const int mitad = N/2;
+
+    // y(n0) = 1/N sum_k Y(k)e^{j2*pi*k*n0/N}. Por ser y(n) real, los terminos k y N-k
+    // son conjugados y basta con sumar dos veces la parte real de los N/2-1 intermedios.
+    // Fuera del rango de la banda Y(k) se trata como cero.
+    const complejo* hk = e->tablas[banda];
+    const RangoBins& rango = e->rangos[banda];
+    double acc = 0.0;
+    for(int k = rango.desde; k < rango.hasta; k++){
+        double re = (e->X[k][REAL]*hk[k][REAL]) - (e->X[k][IMAG]*hk[k][IMAG]);
+        double im = (e->X[k][IMAG]*hk[k][REAL]) + (e->X[k][REAL]*hk[k][IMAG]);
+        double v = re*e->giro[k][REAL] - im*e->giro[k][IMAG];
+        acc += ((k == 0) || (k == mitad)) ? v : 2.0*v;
+    }
+
+    return static_cast<float>(0.02 * (volumeGain) * (acc/N));
 }
 
-void controlVolume::spec(float* in, float* out, struct Spectral* spectral, int blockSize){
+template<typename Precision>
+void basicControlVolume<Precision>::spec(float* in, float* out, struct Spectral* spectral, int blockSize){
 
     float* unprocessed = in;
-    float* processed = (float*) calloc(blockSize, sizeof(float)); // Create an array with 0's
+    float* processed = enUso_->procesado; // Array with 0's, preallocated in the block state
 
     // Define constant a for differences equation
     const float a32 = 0.1657;
@@ -535,97 +1397,276 @@ void controlVolume::spec(float* in, float* out, struct Spectral* spectral, int b
 * @brief filter Funcion encargada de filtrar la entrada de datos pasandola por distintos filtros y luego sumando la salida de cada uno.
 * @param blockSize cantidad de muestras que contiene la entrada.
 * @param volumeGain valor entero que representa la posicion del slider y escala el valor final de la salida controlando asi el volumen.
-* @param g32 valor entero que representa la posicion del slider asociado al filtro de 32Hz y escala el valor de la salida especifica de dicho filtro.
-* @param g64 valor entero que representa la posicion del slider asociado al filtro de 64Hz y escala el valor de la salida especifica de dicho filtro.
-* @param g125 valor entero que representa la posicion del slider asociado al filtro de 125Hz y escala el valor de la salida especifica de dicho filtro.
-* @param g250 valor entero que representa la posicion del slider asociado al filtro de 250Hz y escala el valor de la salida especifica de dicho filtro.
-* @param g500 valor entero que representa la posicion del slider asociado al filtro de 500Hz y escala el valor de la salida especifica de dicho filtro.
-* @param g1k valor entero que representa la posicion del slider asociado al filtro de 1kHz y escala el valor de la salida especifica de dicho filtro.
-* @param g2k valor entero que representa la posicion del slider asociado al filtro de 2kHz y escala el valor de la salida especifica de dicho filtro.
-* @param g4k valor entero que representa la posicion del slider asociado al filtro de 4kHz y escala el valor de la salida especifica de dicho filtro.
-* @param g8k valor entero que representa la posicion del slider asociado al filtro de 8kHz y escala el valor de la salida especifica de dicho filtro.
-* @param g16k valor entero que representa la posicion del slider asociado al filtro de 16kHz y escala el valor de la salida especifica de dicho filtro.
+* @param ganancias posicion del slider de cada banda del banco, en el orden de bandas(); escala la salida especifica de cada filtro.
 * @param in puntero al arreglo de valores de tipo float que conforman la entrada del sistema.
 * @param out puntero a un arreglo de valores tipo float que conforman la salida del ecualizador y son enviados a la tarjeta de audio a reproducirse.
 */
-void controlVolume::filter(int blockSize, int volumeGain,int g32,int g64,int g125,int g250,int g500,int g1k,int g2k,int g4k,int g8k,int g16k, float *in, float *out, int aReverb, int dReverb, bool enabledReverb, int typeReverb, struct Spectral* spectral){
-
-    //Call spec system
-    this->spec(in,out, spectral, blockSize);
-
-
-    //Se inicializan los punteros que almacenaran la salida de cada filtro.
-    float* pf32 = new float[blockSize];
-    float* pf64 = new float[blockSize];
-    float* pf125 = new float[blockSize];
-    float* pf250 = new float[blockSize];
-    float* pf500 = new float[blockSize];
-    float* pf1k = new float[blockSize];
-    float* pf2k = new float[blockSize];
-    float* pf4k = new float[blockSize];
-    float* pf8k = new float[blockSize];
-    float* pf16k = new float[blockSize];
-
-    //Se llama la funcion que realiza el filtrado para cada uno de los filtros.
-    filtroGeneral(blockSize,g32,in,pf32,f32,datos32);
-    filtroGeneral(blockSize,g64,in,pf64,f64,datos64);
-    filtroGeneral(blockSize,g125,in,pf125,f125,datos125);
-    filtroGeneral(blockSize,g250,in,pf250,f250,datos250);
-    filtroGeneral(blockSize,g500,in,pf500,f500,datos500);
-    filtroGeneral(blockSize,g1k,in,pf1k,f1k,datos1k);
-    filtroGeneral(blockSize,g2k,in,pf2k,f2k,datos2k);
-    filtroGeneral(blockSize,g4k,in,pf4k,f4k,datos4k);
-    filtroGeneral(blockSize,g8k,in,pf8k,f8k,datos8k);
-    filtroGeneral(blockSize,g16k,in,pf16k,f16k,datos16k);
-
-    // Se define cada elemento de la salida como la suma de las salidas de los filtros para un n, escalado por una constante.
-    for (int n=0; n<blockSize;++n){
-
-        tmpOut[n] = 0.02 * (volumeGain)*(pf32[n]+pf64[n]+pf125[n]+pf250[n]+pf500[n]+pf1k[n]+pf2k[n]+pf4k[n]+pf8k[n]+pf16k[n]);
-
-        // Reverberacion
-        if(enabledReverb){
-
-            float y_nD;
-            float x_nD;
-            if(n-dReverb < 0){
-                int index = MAX_D + n - dReverb;
-                y_nD = lastReverb[index];
-                x_nD = lastOut[index];
-            } else {
-                y_nD = out[n-dReverb];
-                x_nD = tmpOut[n-dReverb];
-            }
+template<typename Precision>
+void basicControlVolume<Precision>::filter(int blockSize, int volumeGain, const int* ganancias, float *in, float *out, int aReverb, int dReverb, bool enabledReverb, int typeReverb, struct Spectral* spectral){
+
+    float* entradas[1] = { in };
+    float* salidas[1] = { out };
+    procesar(1,blockSize,volumeGain,ganancias,entradas,salidas,aReverb,dReverb,enabledReverb,typeReverb,spectral);
+}
+
+/**
+* @brief filter Version estereo: filtra los canales izquierdo y derecho con las mismas ganancias.
+* @param inL entrada del canal izquierdo.
+* @param inR entrada del canal derecho.
+* @param outL salida del canal izquierdo.
+* @param outR salida del canal derecho.
+*/
+template<typename Precision>
+void basicControlVolume<Precision>::filter(int blockSize, int volumeGain, const int* ganancias, float* inL, float* inR, float* outL, float* outR, int aReverb, int dReverb, bool enabledReverb, int typeReverb, struct Spectral* spectral){
+
+    float* entradas[2] = { inL, inR };
+    float* salidas[2] = { outL, outR };
+    procesar(2,blockSize,volumeGain,ganancias,entradas,salidas,aReverb,dReverb,enabledReverb,typeReverb,spectral);
+}
 
-            float alpha = 0.01 * aReverb;
-            float beta = alpha * 0.75;
-            float mul = alpha * beta;
-            switch (typeReverb) {
-            case 0: // y(n) = - a * y(n - D) + a * x(n) + x(n - D)
-                out[n] = - alpha * y_nD + alpha * tmpOut[n] + x_nD;
-                break;
-            case 1: // y(n) = x(n) + a y(n - D)
-                out[n] = tmpOut[n] +  alpha * y_nD;
-                break;
-            case 2: // y(n) = x(n) + a * x(n - D) - a * B * x(n - D) + a * B * y(n - D)
-                out[n] = tmpOut[n] + alpha * x_nD -  mul * x_nD + mul * y_nD;
-                break;
-            default: // caso 0
-                out[n] = - alpha * y_nD + alpha * tmpOut[n] + x_nD;
-                break;
+/**
+ * @brief procesar Cuerpo comun de las versiones mono y estereo de filter(): ejecuta las tres
+ * etapas (ecualizador, reverberacion y medidores) una tras otra en el hilo que llama.
+ * @param canales 1 o 2.
+ * @param in entrada de cada canal.
+ * @param out salida de cada canal.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::procesar(int canales, int blockSize, int volumeGain, const int* ganancias, float* const* in, float* const* out, int aReverb, int dReverb, bool enabledReverb, int typeReverb, struct Spectral* spectral){
+
+    float medidores[filterBank::Grupos];
+    bool omitir = false;
+    if(!ecualizar(canales,blockSize,volumeGain,ganancias,in,0,medidores,omitir)){
+        for(int c = 0; c < canales; c++){
+            for(int n = 0; n < blockSize; n++){
+                out[c][n] = 0.0f;
             }
+        }
+        return;
+    }
+
+    //Los medidores no pasan la entrada por spec(): escribirMedidores() sobrescribe todos sus valores.
+    reverberar(canales,blockSize,enUso_->tmpOut,out,aReverb,dReverb,enabledReverb,typeReverb,omitir);
+
+    escribirMedidores(out[0][blockSize/2],medidores,spectral);
+}
+
+/**
+ * @brief ecualizar Etapa del ecualizador: aplica las bandas del motor actual y el volumen a un bloque.
+ * @param canales 1 o 2.
+ * @param in entrada de cada canal.
+ * @param salida suma de las bandas con el volumen de cada canal; si es 0 queda en tmpOut del estado en uso.
+ * @param medidores recibe la salida de la banda que muestra cada medidor (filterBank::Grupos valores).
+ * @param omitir recibe si la salida es nula (modo de reposo o volumen en cero), para reverberar().
+ * @return false si no hay estado para este tamano de bloque o canales: no se escribe salida.
+ */
+template<typename Precision>
+bool basicControlVolume<Precision>::ecualizar(int canales, int blockSize, int volumeGain, const int* ganancias, float* const* in, float* const* salida, float* medidores, bool& omitir){
+
+    //Estado publicado por prepararPlanes() o por el hilo de diseno. Se declara en reservado_
+    //antes de usarlo y se verifica que siga publicado, para que el hilo de diseno no lo libere.
+    //Mientras no exista uno para este tamano la salida es silencio, igual que si se piden
+    //mas canales de los que tienen buffers (un canal con fuente solo procesa uno).
+    EstadoBloque* e = actual_.load();
+    for(;;){
+        reservado_.store(e);
+        EstadoBloque* publicado = actual_.load();
+        if(publicado == e){
+            break;
+        }
+        e = publicado;
+    }
+    if((e == 0) || (e->blockSize != blockSize) || (canales > canales_)){
+        return false;
+    }
+    float* const* destino = (salida != 0) ? salida : e->tmpOut;
+
+    //Al cambiar de tamano o de frecuencia las historias del estado nuevo no estan al dia, por lo que se reinician.
+    if(e != enUso_){
+        inicio = true;
+        enUso_ = e;
+    }
+
+    //Al cambiar de motor o de cantidad de canales las historias no estan al dia, por lo que se reinician.
+    if((motor != motorAnterior_) || (canales != canalesAnterior_)){
+        inicio = true;
+        motorAnterior_ = motor;
+        canalesAnterior_ = canales;
+    }
+
+    //Modo de reposo: la salida de los filtros es nula (salvo la cola de -80 dB que ya se
+    //descarta en su diseno) si la entrada lleva en silencio digital mas que la h(n) mas
+    //larga. Entonces no se calcula ninguna transformada; al salir del reposo las historias
+    //se reinician, pues ya son nulas. Con el volumen o todas las ganancias en cero la salida
+    //tambien es nula, pero la entrada no: los filtros siguen corriendo para que sus historias
+    //sigan al dia y al volver el sonido no haya transitorio ni cola cortada.
+    bool silencio = true;
+    for(int c = 0; c < canales; c++){
+        silencio = silencio && esSilencio(in[c],blockSize);
+    }
+    silencio_ = silencio ? std::min(silencio_ + blockSize,1 << 30) : 0;
+
+    bool sinBandas = (volumeGain == 0) && (volumenAnterior_ == 0);
+    if(!sinBandas){
+        sinBandas = true;
+        for(int b = 0; b < bandas_; b++){
+            sinBandas = sinBandas && (ganancias[b] == 0);
+        }
+    }
+
+    const int cola = e->diseno->cola + ((motor == MotorMultitasa) ? e->diseno->multitasa[0]->latencia() : 0);
+    const bool reposo = (silencio_ >= cola + blockSize);
+    omitir = reposo || sinBandas;
+    if(!reposo && omitido_){
+        inicio = true;
+    }
+    omitido_ = reposo;
+
+    //Pesos de las bandas largas, que los motores por DFT aplican con la convolucion particionada.
+    double pesosLargas[MaxBandas];
+    for(int b = 0; b < bandas_; b++){
+        pesosLargas[b] = 0.02 * ganancias[b];
+    }
 
+    //Las tareas independientes de cada motor se reparten entre los trabajadores de grupo_;
+    //sin trabajadores se ejecutan en orden en este hilo. Las salidas se suman al final.
+    Reparto reparto;
+    reparto.cv = this;
+    reparto.e = e;
+    reparto.canales = canales;
+    reparto.blockSize = blockSize;
+    reparto.ganancias = ganancias;
+    reparto.pesos = 0;
+    reparto.pesosLargas = pesosLargas;
+    reparto.in = in;
+    reparto.largas = (e->diseno->cantidadLargas > 0) ? 1 : 0;
+    reparto.cortas = 0;
+
+    if(reposo){
+
+        for(int b = 0; b < bandas_; b++){
+            muestrasBanda_[b] = 0.0f;
+        }
+
+    } else if(motor == MotorCompuesto){
+
+        //Una sola DFT directa e inversa con Hc(k) para las bandas cortas; tmpOut queda con la
+        //suma de todas las bandas. En estereo los dos canales van empacados en una sola DFT compleja.
+        //Las bandas largas se calculan a la vez en otro hilo.
+        int cortas[MaxBandas];
+        for(int b = 0; b < bandas_; b++){
+            cortas[b] = e->diseno->larga[b] ? 0 : ganancias[b];
+        }
+        reparto.ganancias = cortas;
+        repartir(tareaCompuesto,reparto,reparto.largas + 1);
+        sumarLargas(canales,blockSize);
+
+    } else if(motor == MotorIIR){
+
+        //Todas las bandas se evaluan en el tiempo a la vez, sin latencia algoritmica. Cada
+        //canal tiene su propio banco, que puede ir en otro hilo; los medidores siguen al izquierdo.
+        double pesos[MaxBandas];
+        for(int b = 0; b < bandas_; b++){
+            pesos[b] = 0.02 * ganancias[b];
+        }
+        reparto.pesos = pesos;
+        repartir(tareaIIR,reparto,canales);
+
+    } else if(motor == MotorParticionado){
+
+        //Una DFT pequena por particion de entrada y multiplicacion-acumulacion sobre la FDL.
+        if(inicio){
+            e->conv->reiniciar();
+        }
+        double pesos[MaxBandas];
+        for(int b = 0; b < bandas_; b++){
+            pesos[b] = 0.02 * ganancias[b];
+        }
+        if(canales == 1){
+            e->conv->filtrar(blockSize,in[0],pesos,e->tmpOut[0],medirBandas ? muestrasBanda_ : 0);
         } else {
-            out[n] = tmpOut[n];
+            e->conv->filtrarEstereo(blockSize,in[0],in[1],pesos,e->tmpOut[0],e->tmpOut[1],
+                                    medirBandas ? muestrasBanda_ : 0);
+        }
+
+    } else if(motor == MotorMultitasa){
+
+        //Las bandas altas van por Hc(k) (o por la convolucion particionada si son largas) a
+        //la tasa completa y las bajas por el banco multitasa de cada canal, que alinea ambas salidas.
+        int altas[MaxBandas];
+        double pesos[MaxBandas];
+        for(int b = 0; b < bandas_; b++){
+            const bool baja = e->diseno->multitasa[0]->baja(b);
+            altas[b] = (baja || e->diseno->larga[b]) ? 0 : ganancias[b];
+            pesos[b] = 0.02 * ganancias[b];
+            if(baja){
+                pesosLargas[b] = 0.0;
+            }
+        }
+        reparto.ganancias = altas;
+        reparto.pesos = pesos;
+        repartir(tareaCompuesto,reparto,reparto.largas + 1);
+        sumarLargas(canales,blockSize);
+        repartir(tareaMultitasa,reparto,canales);
+
+    } else {
+
+        //Se llama la funcion que realiza el filtrado para cada uno de los filtros. La salida
+        //de cada filtro de cada canal es parte de la memoria de trabajo del estado, por lo que
+        //en el hilo de tiempo real no se reserva ni se libera memoria, y cada banda de cada canal
+        //es una tarea independiente con sus propias historias. Los medidores siguen al izquierdo.
+        //Cada banda corta usa la menor DFT en la que cabe su h(n); las largas se suman
+        //despues con la convolucion particionada.
+        for(int b = 0; b < bandas_; b++){
+            if(!e->diseno->larga[b]){
+                reparto.banda[reparto.cortas++] = b;
+            }
         }
+        repartir(tareaBandas,reparto,reparto.largas + canales*reparto.cortas);
 
+        for(int c = 0; c < canales; c++){
+            memset(e->tmpOut[c],0,sizeof(float)*blockSize);
+            for(int i = 0; i < reparto.cortas; i++){
+                nucleos_.acumularEscaladoF(e->salidas[c][reparto.banda[i]],1.0f,e->tmpOut[c],blockSize);
+            }
+        }
+        sumarLargas(canales,blockSize);
 
+        for(int i = 0; i < reparto.cortas; i++){
+            muestrasBanda_[reparto.banda[i]] = e->salidas[0][reparto.banda[i]][blockSize/2];
+        }
     }
 
-    for (int n = 0; n < MAX_D;n++){
-        // Almacena los ultimos valores de salida
-        lastOut[n] = tmpOut[n];
-        lastReverb[n] = out[n];
+    // Volumen: la ganancia pasa del valor del bloque anterior al actual a lo largo del
+    // bloque, de modo que mover el slider no produce saltos en la salida.
+    const int volumenInicial = (volumenAnterior_ < 0) ? volumeGain : volumenAnterior_;
+    const float inicial = 0.02f * volumenInicial;
+    const float paso = (0.02f * volumeGain - inicial)/blockSize;
+    for(int c = 0; c < canales; c++){
+        if(omitir){
+            memset(destino[c],0,sizeof(float)*blockSize);
+        } else {
+            nucleos_.rampa(e->tmpOut[c],inicial,paso,destino[c],blockSize);
+        }
+    }
+    volumenAnterior_ = volumeGain;
+
+    //Los medidores muestran una banda por cada grupo de la interfaz: la mas cercana a la frecuencia nominal.
+    for(int g = 0; g < filterBank::Grupos; g++){
+        const int b = banco_.representante(g);
+        if((b < 0) || omitir){
+            medidores[g] = 0.0f;
+        } else if((motor == MotorBandas) && !e->diseno->larga[b]){
+            medidores[g] = muestrasBanda_[b];
+        } else if(!medirBandas){
+            medidores[g] = 0.0f;
+        } else if(((motor == MotorCompuesto) && !e->diseno->larga[b]) ||
+                  ((motor == MotorMultitasa) && !e->diseno->multitasa[0]->baja(b) && !e->diseno->larga[b])){
+            //El motor compuesto no calcula cada banda; solo se evalua la muestra que leen los medidores.
+            medidores[g] = muestraBanda(blockSize,ganancias[b],b);
+        } else {
+            medidores[g] = muestrasBanda_[b];
+        }
     }
 
     //Al realizar el procedimiento una vez se define que ya no es el inicio de la cancion.
@@ -633,31 +1674,54 @@ void controlVolume::filter(int blockSize, int volumeGain,int g32,int g64,int g12
         inicio = false;
     }
 
+    return true;
+}
 
+/**
+ * @brief reverberar Etapa de la reverberacion: y(n) = c*y(n - D) + a*x(n) + b*x(n - D) por canal.
+ * Solo usa las historias del reverberador, por lo que puede correr en otro hilo que ecualizar().
+ * @param canales 1 o 2.
+ * @param in salida de ecualizar() de cada canal.
+ * @param out salida de cada canal; puede ser in.
+ * @param omitir indica si la salida de ecualizar() es nula en este bloque.
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::reverberar(int canales, int blockSize, float* const* in, float* const* out, int aReverb, int dReverb, bool enabledReverb, int typeReverb, bool omitir){
 
+    // Con la salida del ecualizador nula la entrada del reverberador tambien lo es, por lo que su cola puede reposar.
+    reverb_.procesar(canales,blockSize,in,out,aReverb,dReverb,enabledReverb,typeReverb,omitir);
+}
 
-    spectral->main = out[blockSize/2];
-    spectral->f32 = pf32[blockSize/2];
-    spectral->f64 =  pf64[blockSize/2];
-    spectral->f125 = pf125[blockSize/2];
-    spectral->f250 = pf250[blockSize/2];
-    spectral->f500 = pf500[blockSize/2];
-    spectral->f1k = pf1k[blockSize/2];
-    spectral->f2k = pf2k[blockSize/2];
-    spectral->f4k = pf4k[blockSize/2];
-    spectral->f8k = pf8k[blockSize/2];
-    spectral->f16k = pf16k[blockSize/2];
+/**
+ * @brief escribirMedidores Etapa de los medidores: copia la muestra central de la salida y la de cada
+ * banda de los medidores a los valores que lee la interfaz.
+ * @param principal muestra central del bloque de salida del canal izquierdo.
+ * @param medidores salida de cada grupo, calculada por ecualizar().
+ */
+template<typename Precision>
+void basicControlVolume<Precision>::escribirMedidores(float principal, const float* medidores, struct Spectral* spectral){
+
+    spectral->main = principal;
+    spectral->f32 = medidores[0];
+    spectral->f64 = medidores[1];
+    spectral->f125 = medidores[2];
+    spectral->f250 = medidores[3];
+    spectral->f500 = medidores[4];
+    spectral->f1k = medidores[5];
+    spectral->f2k = medidores[6];
+    spectral->f4k = medidores[7];
+    spectral->f8k = medidores[8];
+    spectral->f16k = medidores[9];
+}
 
-    //Se libera la memoria solicitada.
-    delete pf32;
-    delete pf64;
-    delete pf125;
-    delete pf250;
-    delete pf500;
-    delete pf1k;
-    delete pf2k;
-    delete pf4k;
-    delete pf8k;
-    delete pf16k;
+/**
+ * @brief bandas Banco de bandas con el que se construyo el ecualizador.
+ * @return referencia al banco.
+ */
+template<typename Precision>
+const filterBank& basicControlVolume<Precision>::bandas() const{
+    return banco_;
 }
 
+template class basicControlVolume<precision<float> >;
+template class basicControlVolume<precision<double> >;
@@ -28,8 +28,23 @@
 
 #ifndef CONTROLVOLUME_H
 #define CONTROLVOLUME_H
-#include <fftw3.h>
+#include <atomic>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <semaphore.h>
 #include "spectralvalues.h"
+#include "sosbank.h"
+#include "partconvolver.h"
+#include "multiratebank.h"
+#include "banddesigner.h"
+#include "filterbank.h"
+#include "simdkernels.h"
+#include "precision.h"
+#include "rtpool.h"
+#include "reverbunit.h"
 
 /**
  * Control Volume class
@@ -40,66 +55,93 @@
  * \f[
  * y(n)=\cvGain x(n)
  * \f]
+ *
+ * Precision es la precision interna de los motores por DFT, precision<float>
+ * o precision<double> (ver precision.h); la aplicacion usa controlVolume.
  */
-
-class controlVolume {
+template<typename Precision>
+class basicControlVolume {
 public:
 
-    // Puntero de tipo double[][2] que almacena H(k) dividiendo cada termino en parte real y parte imaginaria.
-    fftw_complex *f32;
-    fftw_complex *f64;
-    fftw_complex *f125;
-    fftw_complex *f250;
-    fftw_complex *f500;
-    fftw_complex *f1k;
-    fftw_complex *f2k;
-    fftw_complex *f4k;
-    fftw_complex *f8k;
-    fftw_complex *f16k;
-
-    //Arreglos donde se almacenan las ultimas M-1 muestras del la salida anterior calculada. (Solapamiento y almacenamiento).
-    float* datos32;
-    float* datos64;
-    float* datos125;
-    float* datos250;
-    float* datos500;
-    float* datos1k;
-    float* datos2k;
-    float* datos4k;
-    float* datos8k;
-    float* datos16k;
+    /**
+     * Motores de filtrado disponibles.
+     */
+    enum {
+      MotorBandas=0,    /**< Una DFT directa e inversa por banda corta (referencia). */
+      MotorCompuesto=1, /**< Una sola DFT con el espectro compuesto Hc(k) de las bandas cortas. */
+      MotorIIR=2,       /**< Secciones de segundo orden en el tiempo, sin latencia. */
+      MotorParticionado=3, /**< Convolucion particionada uniforme con FDL. */
+      MotorMultitasa=4  /**< Bandas bajas diezmadas (multiratebank.h) y las demas con Hc(k). */
+    };
+
+    /**
+     * Constantes del ecualizador.
+     */
+    enum {
+      MaxBandas=filterBank::MaxBandas, /**< Cantidad maxima de bandas del ecualizador. */
+      LargoFIR=1025,       /**< Largo maximo de h(n) que se aplica con una sola DFT por bloque; las bandas mas largas van por convolucion particionada. */
+      LargoMaximo=65536,   /**< Largo maximo de h(n) de una banda. */
+      ParticionMaxima=256, /**< Tamano maximo de particion de MotorParticionado. */
+      FrecuenciaReferencia=44100, /**< Frecuencia de muestreo que se usa mientras jack no indique otra. */
+      MaxEstados=8,        /**< Estados (frecuencia, tamano de bloque) que se conservan en el cache. */
+      MaxCanales=2         /**< Canales que procesa filter(): mono o estereo (izquierdo, derecho). */
+    };
+
+    /**
+     * Umbral por omision de usarUmbralBins(), en dB.
+     */
+    static const double UmbralBinsOmision;
+
+    /**
+     * Precision interna de los motores por DFT (ver precision.h).
+     */
+    typedef typename Precision::real real;
+    typedef typename Precision::complejo complejo;
+    typedef typename Precision::plan plan;
+
     bool inicio;
 
-    //Arreglo para almacenar los ultimos 40 valores de out
-    float* lastOut;
-    float* lastReverb;
-    float* tmpOut;
+    // Motor de filtrado utilizado (MotorBandas, MotorCompuesto, MotorIIR, MotorParticionado o MotorMultitasa).
+    int motor;
+
+    // Indica si se calculan las salidas de cada banda para los medidores del espectro.
+    bool medirBandas;
 
-    const int MAX_D = 1024;
     /**
      * Constructor
+     * @param banco distribucion de las bandas (por omision las diez bandas de octava).
      */
-    controlVolume();
+    basicControlVolume(const filterBank& banco = filterBank());
+
+    /**
+     * Constructor de un canal que comparte los filtros de otro procesador.
+     *
+     * Las respuestas al impulso y las tablas H(k) solo se leen despues de
+     * construirse, de modo que muchos canales con las mismas bandas pueden
+     * usar las de un procesador fuente y tener solo su propio estado: las
+     * historias, el espectro compuesto, las FDL, las secciones de segundo
+     * orden, el banco multitasa y el reverberador. Cada estado del canal toma
+     * el de la fuente para la misma frecuencia y tamano de bloque (que la
+     * fuente construye si no lo tiene) y la fuente no lo descarta mientras
+     * algun canal lo use.
+     *
+     * El canal solo procesa un canal (la version mono de filter()); la estereo
+     * produce silencio. La fuente no debe procesar ni destruirse mientras
+     * existan canales que la usen.
+     * @param fuente procesador del que se toman las bandas, los disenos y las tablas.
+     */
+    explicit basicControlVolume(basicControlVolume* fuente);
 
     /**
      * Destructor
      */
-    ~controlVolume();
+    ~basicControlVolume();
 
     /**
     * @brief filter Funcion encargada de filtrar la entrada de datos pasandola por distintos filtros y luego sumando la salida de cada uno.
     * @param blockSize cantidad de muestras que contiene la entrada.
     * @param volumeGain valor entero que representa la posicion del slider y escala el valor final de la salida controlando asi el volumen.
-    * @param g32 valor entero que representa la posicion del slider asociado al filtro de 32Hz y escala el valor de la salida especifica de dicho filtro.
-    * @param g64 valor entero que representa la posicion del slider asociado al filtro de 64Hz y escala el valor de la salida especifica de dicho filtro.
-    * @param g125 valor entero que representa la posicion del slider asociado al filtro de 125Hz y escala el valor de la salida especifica de dicho filtro.
-    * @param g250 valor entero que representa la posicion del slider asociado al filtro de 250Hz y escala el valor de la salida especifica de dicho filtro.
-    * @param g500 valor entero que representa la posicion del slider asociado al filtro de 500Hz y escala el valor de la salida especifica de dicho filtro.
-    * @param g1k valor entero que representa la posicion del slider asociado al filtro de 1kHz y escala el valor de la salida especifica de dicho filtro.
-    * @param g2k valor entero que representa la posicion del slider asociado al filtro de 2kHz y escala el valor de la salida especifica de dicho filtro.
-    * @param g4k valor entero que representa la posicion del slider asociado al filtro de 4kHz y escala el valor de la salida especifica de dicho filtro.
-    * @param g8k valor entero que representa la posicion del slider asociado al filtro de 8kHz y escala el valor de la salida especifica de dicho filtro.
-    * @param g16k valor entero que representa la posicion del slider asociado al filtro de 16kHz y escala el valor de la salida especifica de dicho filtro.
+    * @param ganancias posicion del slider de cada banda, en el orden de bandas(); escala la salida de cada filtro.
     * @param in puntero al arreglo de valores de tipo float que conforman la entrada del sistema.
     * @param out puntero a un arreglo de valores tipo float que conforman la salida del ecualizador y son enviados a la tarjeta de audio a reproducirse.
     * @param aReverb
@@ -109,16 +151,7 @@ public:
     */
    void filter(int blockSize,
                int volumeGain,
-               int g32,
-               int g64,
-               int g125,
-               int g250,
-               int g500,
-               int g1k,
-               int g2k,
-               int g4k,
-               int g8k,
-               int g16k,
+               const int* ganancias,
                float* in,
                float* out,
                int aReverb,
@@ -127,54 +160,577 @@ public:
                int typeReverb,
                struct Spectral* spectral);
 
+   /**
+    * @brief filter Version estereo: filtra los canales izquierdo y derecho con las mismas ganancias.
+    * Cada canal tiene sus propias historias. MotorCompuesto y MotorParticionado empacan ambos
+    * canales en una sola DFT compleja (izquierdo en la parte real y derecho en la imaginaria),
+    * de modo que el costo en transformadas es similar al de un solo canal. Los medidores
+    * siguen al canal izquierdo.
+    * @param inL entrada del canal izquierdo.
+    * @param inR entrada del canal derecho.
+    * @param outL salida del canal izquierdo.
+    * @param outR salida del canal derecho.
+    * Los demas parametros son los de la version mono.
+    */
+   void filter(int blockSize,
+               int volumeGain,
+               const int* ganancias,
+               float* inL,
+               float* inR,
+               float* outL,
+               float* outR,
+               int aReverb,
+               int dReverb,
+               bool enabledReverb,
+               int typeReverb,
+               struct Spectral* spectral);
+
+   /**
+    * @brief bandas Distribucion de las bandas del ecualizador.
+    */
+   const filterBank& bandas() const;
+
    /**
     * @brief filtroGeneral Funcion encargada aplicar el filtrado por DFT a una arreglo de muestras de tipo float.
     * @param blockSize numero de elementos que contiene la entrada, son valores de tipo float.
     * @param volumeGain numero entero que representa el escalado que se aplica a cada valor de la salida calculada.
     * @param in puntero al arreglo de valores de tipo float que conforman la entrada del sistema.
     * @param out puntero a un arreglo de valores tipo float que conforman la salida del ecualizador y son enviados a la tarjeta de audio a reproducirse.
-    * @param hk puntero a un arreglo que contiene los valores complejos de H(k) de un filtro especifico.
+    * @param banda indice de la banda; se usan su tabla H(k) y su largo de DFT.
     * @param temporal puntero al arreglo donde se almacenan los valores de la salida anterior que no se utilizaron y se guardaran los M-1 datos que sobren al filtrar.
+    * @param hilo juego de buffers de trabajo del estado: 0 en el hilo de tiempo real y 1..hilos en los trabajadores de usarHilos().
     */
-   void filtroGeneral(int blockSize,int volumeGain, float* in, float* out,fftw_complex *hk,float* temporal);
+   void filtroGeneral(int blockSize,int volumeGain, float* in, float* out,int banda,float* temporal,int hilo = 0);
    void spec(float* in, float* out, struct Spectral* spectral, int blockSize);
 
+   /**
+    * @brief ecualizar Etapa del ecualizador de filter(): aplica las bandas del motor actual y el volumen.
+    * Usa el estado publicado, las historias de los filtros, inicio, motor y medirBandas, por lo que
+    * un solo hilo debe llamarla. Los parametros son los de filter().
+    * @param canales 1 o 2.
+    * @param in entrada de cada canal.
+    * @param salida suma de las bandas con el volumen de cada canal; si es 0 queda en el estado, donde la
+    * lee procesar().
+    * @param medidores recibe la salida de la banda que muestra cada medidor (filterBank::Grupos valores).
+    * @param omitir recibe si la salida es nula (modo de reposo o volumen en cero), para reverberar().
+    * @return false si no hay estado para este tamano de bloque o canales; entonces no se escribe la
+    * salida y la del bloque debe ser silencio.
+    */
+   bool ecualizar(int canales,int blockSize,int volumeGain,const int* ganancias,float* const* in,
+                  float* const* salida,float* medidores,bool& omitir);
+
+   /**
+    * @brief reverberar Etapa de la reverberacion de filter(). Solo usa las historias del reverberador,
+    * por lo que puede correr en un hilo distinto al de ecualizar(), siempre el mismo.
+    * @param canales 1 o 2.
+    * @param in salida de ecualizar() de cada canal.
+    * @param out salida de cada canal; puede ser in.
+    * @param omitir el valor que dio ecualizar() para el mismo bloque.
+    */
+   void reverberar(int canales,int blockSize,float* const* in,float* const* out,int aReverb,
+                   int dReverb,bool enabledReverb,int typeReverb,bool omitir);
+
+   /**
+    * @brief escribirMedidores Etapa de los medidores: escribe la muestra central de la salida y la de
+    * cada grupo de bandas en los valores que lee la interfaz.
+    * @param principal muestra central del bloque de salida del canal izquierdo.
+    * @param medidores salida de cada grupo, calculada por ecualizar().
+    * @param spectral valores de los medidores.
+    */
+   static void escribirMedidores(float principal,const float* medidores,struct Spectral* spectral);
+
+   /**
+    * @brief prepararPlanes Construye (o toma del cache) el diseno de las bandas, las tablas, planes y buffers
+    * de una frecuencia de muestreo y un tamano de bloque, y los publica.
+    * Debe llamarse fuera del hilo de tiempo real (dspSystem::init, setBufferSize y setSampleRate).
+    * El hilo de tiempo real empieza a usar el estado nuevo en el siguiente bloque.
+    * @param sampleRate frecuencia de muestreo en Hz.
+    * @param blockSize cantidad de muestras por bloque (cualquier tamano).
+    * @param flags bandera de planeacion de FFTW (FFTW_MEASURE o FFTW_PATIENT).
+    */
+   void prepararPlanes(int sampleRate, int blockSize, unsigned flags = FFTW_MEASURE);
+
+   /**
+    * @brief solicitarPlanes Pide al hilo de diseno el estado de una frecuencia de muestreo y un tamano de bloque.
+    * No bloquea: si el estado esta en el cache se publica de inmediato, y si no el hilo de diseno lo
+    * construye en buffers nuevos y lo publica al terminar. Mientras tanto el hilo de tiempo real sigue
+    * con el estado anterior (o produce silencio si el tamano de bloque ya cambio).
+    * Se puede llamar desde los callbacks de jack.
+    * @param sampleRate frecuencia de muestreo en Hz.
+    * @param blockSize cantidad de muestras por bloque.
+    */
+   void solicitarPlanes(int sampleRate, int blockSize);
+
+   /**
+    * @brief filtroCompuesto Aplica todas las bandas con una sola DFT directa e inversa utilizando el espectro compuesto Hc(k).
+    * Por linealidad, sum_i 0.02*g_i*IDFT{X(k)H_i(k)} = IDFT{X(k)Hc(k)} con Hc(k) = sum_i 0.02*g_i*H_i(k).
+    * @param blockSize numero de elementos que contiene la entrada.
+    * @param ganancias posicion del slider de cada banda, en el orden de bandas().
+    * @param in puntero al arreglo de valores de tipo float que conforman la entrada del sistema.
+    * @param out puntero al arreglo donde se almacena la suma de las salidas de todas las bandas.
+    */
+   void filtroCompuesto(int blockSize,const int* ganancias,float* in,float* out);
+
+   /**
+    * @brief filtroCompuestoEstereo Aplica Hc(k) a dos canales con una sola DFT compleja de N puntos.
+    * Con z(n) = xL(n) + j xR(n) y Hc(N-k) = Hc*(k), IDFT{Z(k)Hc(k)} = yL(n) + j yR(n).
+    * @param blockSize numero de elementos que contiene cada canal.
+    * @param ganancias posicion del slider de cada banda, en el orden de bandas().
+    * @param inL entrada del canal izquierdo.
+    * @param inR entrada del canal derecho.
+    * @param outL suma de las bandas del canal izquierdo.
+    * @param outR suma de las bandas del canal derecho.
+    */
+   void filtroCompuestoEstereo(int blockSize,const int* ganancias,float* inL,float* inR,float* outL,float* outR);
+
+   /**
+    * @brief latencia Latencia algoritmica en muestras del motor actual.
+    * Los demas motores producen la salida del bloque actual en el mismo periodo
+    * (MotorParticionado usa particiones que dividen al bloque, nunca mayores).
+    * MotorMultitasa retrasa la salida lo que tardan sus filtros de diezmado e
+    * interpolacion, que depende de la frecuencia de muestreo.
+    */
+   int latencia() const;
+
+   /**
+    * @brief reportarRespuestas Escribe, para cada banda del diseno publicado, el largo de h(n)
+    * elegido, si se aplica con una sola DFT o por convolucion particionada, y la energia de la
+    * cola descartada relativa a la total.
+    * @param os flujo de salida.
+    */
+   void reportarRespuestas(std::ostream& os);
+
+   /**
+    * @brief usarUmbralBins Fija el umbral bajo el cual los terminos de H(k) de una banda se tratan como cero.
+    * Las multiplicaciones espectrales y los medidores solo recorren los terminos de cada banda cuya
+    * magnitud supera el umbral relativo a su maximo. Se aplica a los estados que se construyan
+    * despues, por lo que debe llamarse antes de prepararPlanes().
+    * @param dB umbral relativo al maximo de |H(k)|, en dB (por ejemplo -90); 0 o mas no descarta nada.
+    */
+   void usarUmbralBins(double dB);
+
+   /**
+    * @brief usarHilos Inicia los trabajadores entre los que se reparte cada bloque.
+    * MotorBandas reparte cada banda corta de cada canal y la convolucion de las bandas largas;
+    * MotorCompuesto y MotorMultitasa aplican Hc(k) mientras otro hilo aplica las bandas largas,
+    * y MotorIIR y MotorMultitasa reparten los canales. Las salidas se suman al terminar todas
+    * las tareas, en el mismo orden que sin trabajadores, por lo que el resultado no cambia.
+    * Los estados solo reservan buffers para los trabajadores que existan al construirse, por
+    * lo que debe llamarse antes de prepararPlanes() y nunca mientras se procesa.
+    * @param hilos cantidad de trabajadores (a lo sumo rtPool::MaxHilos); 0 procesa todo en el hilo de jack.
+    * @param prioridad prioridad SCHED_FIFO de los trabajadores; 0 usa la politica normal.
+    * @return false si algun trabajador no se pudo crear, fijar a su nucleo o subir de prioridad.
+    */
+   bool usarHilos(int hilos,int prioridad);
+
 private:
 
    /**
-    * @brief inicializarHK Funcion encargada de generar H(k) utilizando la DFT para un filtro especifico.
-    * @param puntero puntero a un arreglo donde se almacenaran los valores de H(k).
-    * @param G valor que representa la ganancia total de la ecuacion de diferencias de grado 6.
-    * @param a_0 valor decimal que representa coeficiente que multiplica a x(n).
-    * @param b_0 valor decimal que representa coeficiente que multiplica a x(n-1).
-    * @param c_0 valor decimal que representa coeficiente que multiplica a x(n-2).
-    * @param e_0 valor decimal que representa coeficiente que multiplica a x(n-4).
-    * @param f_0 valor decimal que representa coeficiente que multiplica a x(n-5).
-    * @param g_0 valor decimal que representa coeficiente que multiplica a x(n-6).
-    * @param b_1 valor decimal que representa coeficiente que multiplica a y(n-1).
-    * @param c_1 valor decimal que representa coeficiente que multiplica a y(n-2).
-    * @param d_1 valor decimal que representa coeficiente que multiplica a y(n-3).
-    * @param e_1 valor decimal que representa coeficiente que multiplica a y(n-4).
-    * @param f_1 valor decimal que representa coeficiente que multiplica a y(n-5).
-    * @param g_1 valor decimal que representa coeficiente que multiplica a y(n-6).
-    */
-   void inicializarHK(fftw_complex* puntero,double G,double a_0,double b_0,
-                                      double c_0,double e_0,double f_0,double g_0,double b_1,
-                                      double c_1,double d_1,double e_1,double f_1,double g_1);
-
-   //Metodos que llaman a inicializarHk() con los coeficientes especificos de cada filtro
-   void inicializarH32();
-   void inicializarH64();
-   void inicializarH125();
-   void inicializarH250();
-   void inicializarH500();
-   void inicializarH1k();
-   void inicializarH2k();
-   void inicializarH4k();
-   void inicializarH8k();
-   void inicializarH16k();
+    * Filtros de las bandas disenados para una frecuencia de muestreo.
+    */
+   struct DisenoTasa {
+       int sampleRate;                        /**< Frecuencia de muestreo del diseno. */
+       DisenoTasa* prestado;                  /**< Diseno de la fuente del que se toman las respuestas, o 0 si son propias. */
+       int prestamos;                         /**< Disenos de otros canales que usan estas respuestas. */
+       sosBank* iir[MaxCanales];              /**< Secciones de segundo orden que utiliza MotorIIR, con el estado de cada canal. */
+       multirateBank* multitasa[MaxCanales];  /**< Bandas bajas de MotorMultitasa, con el estado de cada canal. */
+       double* memoria;                       /**< Una sola reserva con las respuestas de todas las bandas (0 si son prestadas). */
+       double* respuestas[MaxBandas];         /**< h(n) de cada banda, de largo largos[b]. */
+       int largos[MaxBandas];                 /**< Largo de h(n) donde la energia de la cola cae bajo la tolerancia (0 si la banda esta anulada). */
+       double errores[MaxBandas];             /**< Energia de la cola descartada relativa a la total, en dB. */
+       bool larga[MaxBandas];                 /**< La banda excede LargoFIR y se aplica por convolucion particionada. */
+       int cantidadLargas;                    /**< Cantidad de bandas largas. */
+       int cola;                              /**< Largo de la h(n) mas larga: tras esa cantidad de muestras en silencio la salida de los filtros es nula. */
+   };
+
+   /**
+    * Tipo del cache de disenos: frecuencia de muestreo -> diseno.
+    */
+   typedef std::map<int,DisenoTasa*> disenoCache_type;
+
+   /**
+    * Disenos de las frecuencias de muestreo de los estados del cache. Solo se
+    * modifica con cacheMutex_ tomado.
+    */
+   disenoCache_type disenos_;
+
+   /**
+    * Disenador de los pasabanda elipticos de orden 6.
+    */
+   bandDesigner disenador_;
+
+   /**
+    * Distribucion de las bandas y su cantidad.
+    */
+   filterBank banco_;
+   int bandas_;
+
+   /**
+    * Nucleos vectoriales elegidos para este procesador.
+    */
+   const simdKernels& nucleos_;
+
+   /**
+    * Salida de cada banda en la muestra central del bloque, calculada por MotorIIR, MotorParticionado
+    * y las bandas bajas de MotorMultitasa.
+    */
+   float muestrasBanda_[MaxBandas];
+
+   /**
+    * Motor utilizado en el bloque anterior, para detectar cambios.
+    */
+   int motorAnterior_;
+
+   /**
+    * Volumen del bloque anterior; la ganancia pasa de este al nuevo con una rampa dentro del bloque.
+    */
+   int volumenAnterior_;
+
+   /**
+    * Canales del bloque anterior; al pasar de mono a estereo las historias se reinician.
+    */
+   int canalesAnterior_;
+
+   /**
+    * Modo de reposo: muestras consecutivas de entrada en silencio digital (todas en cero),
+    * y si el bloque anterior omitio los filtros por ese silencio.
+    */
+   int silencio_;
+   bool omitido_;
+
+   /**
+    * Reverberador de reverberar(), con sus historias por canal.
+    */
+   reverbUnit reverb_;
+
+   /**
+    * Latencia de MotorMultitasa en el estado publicado, para latencia().
+    */
+   std::atomic<int> retardoMultitasa_;
+
+   /**
+    * Terminos [desde,hasta) de una tabla H(k) cuya magnitud supera el umbral; fuera de
+    * ellos H(k) se trata como cero. Un rango vacio tiene desde = hasta.
+    */
+   struct RangoBins {
+       int desde;
+       int hasta;
+   };
+
+   /**
+    * Umbral de magnitud relativo al maximo de cada tabla (no en dB); 0 conserva todos los terminos.
+    */
+   double umbralBins_;
+
+   /**
+    * Tablas y buffers que dependen del tamano de bloque B.
+    *
+    * Las bandas cortas (h(n) de a lo sumo LargoFIR muestras) se aplican con
+    * transformadas de N puntos, con N la menor potencia de dos tal que
+    * N >= B + L - 1 para la banda corta mas larga, de modo que h(n) siempre cabe
+    * completa y el filtro no cambia con el periodo de JACK. Cada bloque se
+    * filtra con x(n) = [ultimas N-B muestras de la entrada, bloque actual].
+    * MotorBandas usa para cada banda corta su propio N_b con su propio largo.
+    * Las bandas largas se aplican con la convolucion particionada largas.
+    */
+   struct EstadoBloque {
+       int blockSize;                   /**< Tamano de bloque B. */
+       DisenoTasa* diseno;              /**< Filtros de la frecuencia de muestreo del estado. */
+       EstadoBloque* prestado;          /**< Estado de la fuente del que se toman las tablas y planes, o 0 si son propios. */
+       int prestamos;                   /**< Estados de otros canales que usan las tablas de este. */
+       int largoDFT;                    /**< Largo N de las transformadas. */
+       int historia;                    /**< Muestras anteriores N-B que se guardan. */
+       plan dft;                        /**< Plan real a complejo de N puntos. */
+       plan idft;                       /**< Plan complejo a real de N puntos. */
+       plan zdft;                       /**< Plan complejo directo de N puntos, para estereo. */
+       plan zidft;                      /**< Plan complejo inverso de N puntos, para estereo. */
+       complejo* tablasH;               /**< Tabla contigua y alineada [banda][termino] con H(k) de todas las bandas. */
+       complejo* tablas[MaxBandas];     /**< H(k) de cada banda (N/2+1 terminos) dentro de tablasH; cero para las bandas largas. */
+       RangoBins rangos[MaxBandas];     /**< Terminos significativos de cada tabla de tablasH. */
+       int largoBanda[MaxBandas];       /**< Largo N_b de las transformadas de cada banda corta en MotorBandas. */
+       plan dftBanda[MaxBandas];        /**< Planes real a complejo y complejo a real de N_b puntos. */
+       plan idftBanda[MaxBandas];
+       complejo* tablasBandas;          /**< Tabla contigua con H(k) de N_b puntos de cada banda corta. */
+       complejo* tablaBanda[MaxBandas]; /**< H(k) de cada banda (N_b/2+1 terminos) dentro de tablasBandas. */
+       RangoBins rangosBanda[MaxBandas]; /**< Terminos significativos de cada tablaBanda. */
+       float* datos[MaxCanales][MaxBandas]; /**< Historia de N_b-B muestras de la entrada de cada canal y banda para MotorBandas. */
+       complejo* hc;                    /**< Espectro compuesto Hc(k) = sum_i 0.02*g_i*H_i(k). */
+       int gananciasHc[MaxBandas];      /**< Ganancias con las que esta construido hc. */
+       int actualizacionesHc;           /**< Actualizaciones incrementales desde la ultima reconstruccion de hc. */
+       RangoBins rangoHc;               /**< Union de los rangos de las bandas con ganancia; fuera de el hc se trata como cero. */
+       complejo* hcCompleto;            /**< Hc(k) extendido a los N terminos con Hc(N-k) = Hc*(k), para estereo. */
+       bool hcCompletoAlDia;            /**< Indica si hcCompleto corresponde a hc. */
+       float* datosHc[MaxCanales];      /**< Historia de la entrada de cada canal para MotorCompuesto. */
+       complejo* giro;                  /**< Factores e^{j2*pi*k*n0/N} con n0 = N-B + B/2, para los medidores. */
+       real* x;                         /**< Buffers alineados de x(n), X(k), Y(k) y y(n). */
+       complejo* X;
+       complejo* Y;
+       real* y;
+       real* xTrabajo[rtPool::MaxHilos+1]; /**< x(n), X(k), Y(k) y y(n) de cada hilo para MotorBandas; los del hilo 0 son x, X, Y y y. */
+       complejo* XTrabajo[rtPool::MaxHilos+1];
+       complejo* YTrabajo[rtPool::MaxHilos+1];
+       real* yTrabajo[rtPool::MaxHilos+1];
+       int trabajos;                    /**< Juegos de buffers de trabajo: los trabajadores que existian al construir el estado mas uno. */
+       complejo* z;                     /**< Buffers de N terminos de z(n) = xL(n) + j xR(n) y Z(k). */
+       complejo* Z;
+       float* arena;                    /**< Memoria de trabajo del bloque: una sola reserva alineada con tmpOut, tmpLargas, salidas y procesado. */
+       float* tmpOut[MaxCanales];       /**< Suma de las bandas de cada canal antes del volumen y la reverberacion. */
+       float* tmpLargas[MaxCanales];    /**< Suma de las bandas largas de cada canal. */
+       float* salidas[MaxCanales][MaxBandas]; /**< Salida de cada canal y banda para MotorBandas. */
+       float* procesado;                /**< Salida anterior de los medidores de spec. */
+       partConvolver<Precision>* conv;             /**< Convolucion particionada de todas las bandas con particiones que dividen a B. */
+       partConvolver<Precision>* largas;           /**< Convolucion particionada de las bandas largas, para los demas motores. */
+       unsigned long uso;               /**< Ultima publicacion del estado, para descartar el menos reciente. */
+   };
+
+   /**
+    * Tipo del cache de estados: (frecuencia de muestreo, tamano de bloque) -> estado.
+    */
+   typedef std::map<std::pair<int,int>,EstadoBloque*> estadoCache_type;
+
+   /**
+    * Estados de las ultimas MaxEstados frecuencias y tamanos de bloque usados. Solo se
+    * modifica con cacheMutex_ tomado, nunca en el hilo de tiempo real.
+    */
+   estadoCache_type estados_;
+
+   /**
+    * Estado publicado para el hilo de tiempo real.
+    */
+   std::atomic<EstadoBloque*> actual_;
+
+   /**
+    * Estado que el hilo de tiempo real declara en uso. Un estado descartado del
+    * cache solo se libera si no es actual_ ni reservado_.
+    */
+   std::atomic<EstadoBloque*> reservado_;
+
+   /**
+    * Protege los caches de disenos, estados y planes entre prepararPlanes() y el hilo de diseno.
+    */
+   std::mutex cacheMutex_;
+
+   /**
+    * Contador de publicaciones, para EstadoBloque::uso.
+    */
+   unsigned long publicaciones_;
+
+   /**
+    * Ultima configuracion solicitada al hilo de diseno: (frecuencia << 32) | tamano, o 0.
+    */
+   std::atomic<long long> pedido_;
+
+   /**
+    * Indica al hilo de diseno que debe terminar.
+    */
+   std::atomic<bool> terminar_;
+
+   /**
+    * Despierta al hilo de diseno; sem_post no bloquea.
+    */
+   sem_t pendiente_;
+
+   /**
+    * Hilo de diseno.
+    */
+   std::thread trabajador_;
+
+   /**
+    * @brief trabajar Ciclo del hilo de diseno: espera pedidos y construye sus estados.
+    */
+   void trabajar();
+
+   /**
+    * @brief obtenerEstado Toma del cache o construye el estado de una configuracion. Requiere cacheMutex_.
+    */
+   EstadoBloque* obtenerEstado(int sampleRate,int blockSize,unsigned flags);
+
+   /**
+    * @brief obtenerDiseno Toma del cache o construye el diseno de una frecuencia de muestreo. Requiere cacheMutex_.
+    */
+   DisenoTasa* obtenerDiseno(int sampleRate);
+
+   /**
+    * @brief publicarEstado Publica un estado y libera los que sobran en el cache. Requiere cacheMutex_.
+    */
+   void publicarEstado(EstadoBloque* e);
+
+   /**
+    * @brief podarCache Libera los estados menos recientes que sobran en el cache y los disenos
+    * sin estados. Nunca libera conservar, el publicado, el reservado ni los que usan otros canales.
+    * Requiere cacheMutex_.
+    */
+   void podarCache(EstadoBloque* conservar);
+
+   /**
+    * Constructor comun de los dos publicos; fuente es 0 si el procesador construye sus propios filtros.
+    */
+   basicControlVolume(const filterBank& banco,basicControlVolume* fuente);
+
+   /**
+    * Procesador del que se toman los disenos y tablas (ver basicControlVolume(basicControlVolume*)), o 0.
+    */
+   basicControlVolume* fuente_;
+
+   /**
+    * Canales para los que se reservan historias y buffers: MaxCanales, o 1 en un canal con fuente.
+    */
+   int canales_;
+
+   /**
+    * Estado utilizado en el bloque actual (solo lo usa el hilo de tiempo real).
+    */
+   EstadoBloque* enUso_;
+
+   /**
+    * @brief crearDiseno Disena las bandas para una frecuencia de muestreo y calcula sus respuestas al impulso.
+    */
+   DisenoTasa* crearDiseno(int sampleRate);
+
+   /**
+    * @brief liberarDiseno Libera la memoria de un diseno.
+    */
+   void liberarDiseno(DisenoTasa* d);
+
+   /**
+    * @brief crearEstado Construye las tablas, planes y buffers de un tamano de bloque a partir de un diseno.
+    */
+   EstadoBloque* crearEstado(DisenoTasa* d,int blockSize,unsigned flags);
+
+   /**
+    * @brief crearTablas Crea los planes y calcula las tablas H(k), sus rangos y los factores de los medidores de un estado.
+    */
+   void crearTablas(DisenoTasa* d,EstadoBloque* e,unsigned flags);
+
+   /**
+    * @brief liberarEstado Libera la memoria de un estado.
+    */
+   void liberarEstado(EstadoBloque* e);
+
+   /**
+    * @brief actualizarCompuesto Actualiza Hc(k) de forma incremental (Hc += 0.02*dg*H_i) para las bandas cuya ganancia cambio.
+    * @param ganancias posicion de los sliders de cada banda.
+    */
+   void actualizarCompuesto(const int* ganancias);
+
+   /**
+    * @brief muestraBanda Calcula la muestra central del bloque de salida de una banda a partir de X(k), sin IDFT completa.
+    * @param blockSize numero de elementos del bloque.
+    * @param volumeGain posicion del slider de la banda.
+    * @param banda indice de la banda; se usan su tabla H(k) y su rango de terminos.
+    */
+   float muestraBanda(int blockSize,int volumeGain,int banda) const;
+
+   /**
+    * @brief filtroLargas Calcula en tmpLargas la salida de las bandas largas, aplicadas con la convolucion particionada largas.
+    * @param canales 1 o 2.
+    * @param blockSize numero de elementos del bloque.
+    * @param pesos ganancia de cada banda; las bandas cortas se ignoran.
+    * @param in entrada de cada canal.
+    */
+   void filtroLargas(int canales,int blockSize,const double* pesos,float* const* in);
+
+   /**
+    * @brief sumarLargas Suma tmpLargas a tmpOut si hay bandas largas.
+    */
+   void sumarLargas(int canales,int blockSize);
+
+   /**
+    * Trabajadores entre los que se reparte cada bloque (ver usarHilos()).
+    */
+   rtPool grupo_;
+
+   /**
+    * Datos de un bloque que se reparten entre los hilos de grupo_. Las tareas solo
+    * escriben en buffers propios; las salidas se suman despues de ejecutar().
+    */
+   struct Reparto {
+       basicControlVolume* cv;
+       EstadoBloque* e;
+       int canales;
+       int blockSize;
+       const int* ganancias;      /**< Ganancias de las bandas que se aplican con Hc(k) o por banda. */
+       const double* pesos;       /**< Pesos de las bandas para MotorIIR y MotorMultitasa. */
+       const double* pesosLargas; /**< Pesos de las bandas largas. */
+       float* const* in;
+       int largas;                /**< 1 si la primera tarea es la convolucion de las bandas largas. */
+       int cortas;                /**< Bandas cortas de MotorBandas. */
+       int banda[MaxBandas];      /**< Indice de cada banda corta. */
+   };
+
+   /**
+    * @brief repartir Ejecuta las tareas de un bloque con grupo_, o en orden en este hilo si el
+    * estado no tiene buffers para todos los trabajadores.
+    */
+   void repartir(rtPool::funcion f,Reparto& reparto,int tareas);
+
+   /**
+    * Tareas de repartir(): bandas largas y luego cada (canal, banda corta) de MotorBandas;
+    * bandas largas y luego Hc(k); y cada canal de MotorIIR o del banco multitasa.
+    */
+   static void tareaBandas(void* contexto,int tarea,int hilo);
+   static void tareaCompuesto(void* contexto,int tarea,int hilo);
+   static void tareaIIR(void* contexto,int tarea,int hilo);
+   static void tareaMultitasa(void* contexto,int tarea,int hilo);
+
+   /**
+    * @brief procesar Cuerpo comun de las versiones mono y estereo de filter(): ecualizar(),
+    * reverberar() y escribirMedidores() en el hilo que llama.
+    * @param canales 1 o 2.
+    * @param in entrada de cada canal.
+    * @param out salida de cada canal.
+    */
+   void procesar(int canales,int blockSize,int volumeGain,const int* ganancias,
+                 float* const* in,float* const* out,int aReverb,int dReverb,
+                 bool enabledReverb,int typeReverb,struct Spectral* spectral);
+
+   /**
+    * Tipos de plan del cache. Los reales usan las direcciones de FFTW.
+    */
+   enum {
+     PlanDirecto=FFTW_FORWARD,           /**< Real a complejo. */
+     PlanInverso=FFTW_BACKWARD,          /**< Complejo a real. */
+     PlanComplejoDirecto=2*FFTW_FORWARD, /**< Complejo a complejo, FFTW_FORWARD. */
+     PlanComplejoInverso=2*FFTW_BACKWARD /**< Complejo a complejo, FFTW_BACKWARD. */
+   };
+
+   /**
+    * Tipo del cache de planes: (largo de la transformada, tipo de plan) -> plan.
+    */
+   typedef std::map<std::pair<int,int>,plan> planCache_type;
+
+   /**
+    * Cache de planes de FFTW. Solo se modifica con cacheMutex_ tomado (el planeador
+    * de FFTW no es reentrante); el hilo de tiempo real usa los planes copiados en su estado.
+    */
+   planCache_type planes_;
+
+   /**
+    * @brief buscarPlan Retorna el plan guardado para el largo y el tipo dados, o 0 si no existe.
+    * @param N largo de la transformada.
+    * @param tipo PlanDirecto, PlanInverso, PlanComplejoDirecto o PlanComplejoInverso.
+    */
+   plan buscarPlan(int N,int tipo) const;
+
+   /**
+    * @brief crearPlanes Crea, si no existen, los planes reales y complejos de N puntos
+    * sobre los buffers de un estado.
+    */
+   void crearPlanes(int N,unsigned flags,EstadoBloque* e);
+
 
 };
 
+/**
+ * Las dos precisiones se instancian en controlvolume.cpp.
+ */
+extern template class basicControlVolume<precision<float> >;
+extern template class basicControlVolume<precision<double> >;
+
+/**
+ * Ecualizador de la aplicacion, con la precision elegida al compilar (precisionMotor).
+ */
+typedef basicControlVolume<precisionMotor> controlVolume;
+
 
 #endif // CONTROLVOLUME_H
@@ -27,7 +27,10 @@
 
 #include "dspsystem.h"
 #include "spectralvalues.h"
+#include "graphnodes.h"
+#include <algorithm>
 #include <cstring>
+#include <iostream>
 
 #undef _DSP_DEBUG
 #define _DSP_DEBUG
@@ -41,10 +44,25 @@
 
 
 dspSystem::dspSystem()
-  :sampleRate_(0),bufferSize_(0),cv_(0){
+  :sampleRate_(0),bufferSize_(0),cv_(0),umbralBins_(controlVolume::UmbralBinsOmision),hilos_(0),prioridadHilos_(0),etapas_(0),prioridadEtapas_(0),tuberia_(0),grafo_(0),cambiosAbiertos_(0),reiniciosVistos_(0){
+
+  parametros_.volumeGain = 25;
+  for (int b=0;b<filterBank::MaxBandas;++b) {
+    parametros_.ganancias[b] = 25;
+  }
+  parametros_.aReverb = 70;
+  parametros_.dReverb = 1024;
+  parametros_.reverbEnabled = true;
+  parametros_.typeReverb = 0;
+  parametros_.engine = controlVolume::MotorCompuesto;
+  parametros_.metering = true;
+  parametros_.reinicios = 0;
+  publicar();
 }
 
 dspSystem::~dspSystem() {
+    delete grafo_;
+    delete tuberia_;
     delete cv_;
     cv_;
 }
@@ -54,7 +72,8 @@ void dspSystem::updateVolume(int value){
    /*
     * Updating volume value
     */
-   volumeGain_=value;
+   parametros_.volumeGain=value;
+   publicar();
 
 }
 /**
@@ -63,7 +82,7 @@ void dspSystem::updateVolume(int value){
  */
 void dspSystem::updateG32(int value){
 
-    g32_ = value;
+    actualizarGrupo(0,value);
 }
 /**
  * @brief dspSystem::updateG64 Metodo que escala la salida del filtro de 64Hz
@@ -71,7 +90,7 @@ void dspSystem::updateG32(int value){
  */
 void dspSystem::updateG64(int value){
 
-    g64_ = value;
+    actualizarGrupo(1,value);
 }
 /**
  * @brief dspSystem::updateG125 Metodo que escala la salida del filtro de 125Hz
@@ -79,7 +98,7 @@ void dspSystem::updateG64(int value){
  */
 void dspSystem::updateG125(int value){
 
-    g125_ = value;
+    actualizarGrupo(2,value);
 }
 /**
  * @brief dspSystem::updateG250 Metodo que escala la salida del filtro de 250Hz
@@ -87,7 +106,7 @@ void dspSystem::updateG125(int value){
  */
 void dspSystem::updateG250(int value){
 
-    g250_ = value;
+    actualizarGrupo(3,value);
 }
 /**
  * @brief dspSystem::updateG500 Metodo que escala la salida del filtro de 500Hz
@@ -95,7 +114,7 @@ void dspSystem::updateG250(int value){
  */
 void dspSystem::updateG500(int value){
 
-    g500_ = value;
+    actualizarGrupo(4,value);
 }
 /**
  * @brief dspSystem::updateG1k Metodo que escala la salida del filtro de 1kHz
@@ -103,7 +122,7 @@ void dspSystem::updateG500(int value){
  */
 void dspSystem::updateG1k(int value){
 
-    g1k_ = value;
+    actualizarGrupo(5,value);
 }
 /**
  * @brief dspSystem::updateG2k Metodo que escala la salida del filtro de 2kHz
@@ -111,7 +130,7 @@ void dspSystem::updateG1k(int value){
  */
 void dspSystem::updateG2k(int value){
 
-    g2k_ = value;
+    actualizarGrupo(6,value);
 }
 /**
  * @brief dspSystem::updateG4k Metodo que escala la salida del filtro de 4kHz
@@ -119,7 +138,7 @@ void dspSystem::updateG2k(int value){
  */
 void dspSystem::updateG4k(int value){
 
-    g4k_ = value;
+    actualizarGrupo(7,value);
 }
 /**
  * @brief dspSystem::updateG8k Metodo que escala la salida del filtro de 8kHz
@@ -127,7 +146,7 @@ void dspSystem::updateG4k(int value){
  */
 void dspSystem::updateG8k(int value){
 
-    g8k_ = value;
+    actualizarGrupo(8,value);
 }
 /**
  * @brief dspSystem::updateG16k Metodo que escala la salida del filtro de 16kHz
@@ -135,7 +154,88 @@ void dspSystem::updateG8k(int value){
  */
 void dspSystem::updateG16k(int value){
 
-    g16k_ = value;
+    actualizarGrupo(9,value);
+}
+
+/**
+ * @brief dspSystem::actualizarGrupo Asigna la posicion de un slider a todas las bandas de su grupo.
+ * @param grupo slider de la interfaz (0 para 32Hz ... 9 para 16kHz).
+ * @param value numero entero que representa la posicion del slider.
+ */
+void dspSystem::actualizarGrupo(int grupo,int value){
+
+    for (int b=0;b<banco_.bandas();++b) {
+        if (banco_.grupo(b) == grupo) {
+            parametros_.ganancias[b] = value;
+        }
+    }
+    publicar();
+}
+
+/**
+ * @brief dspSystem::usarBandas Cambia el banco de bandas del ecualizador. Solo tiene efecto
+ * si se llama antes de init(), pues el banco se fija al construir el controlVolume.
+ * @param banco bandas a utilizar.
+ * @return false si el procesador ya fue inicializado.
+ */
+bool dspSystem::usarBandas(const filterBank& banco){
+
+    if (cv_ != 0) {
+        return false;
+    }
+    banco_ = banco;
+    return true;
+}
+
+/**
+ * @brief dspSystem::usarUmbralBins Cambia el umbral de los terminos de H(k). Solo tiene efecto
+ * si se llama antes de init(), pues las tablas se construyen al preparar los planes.
+ * @param dB umbral relativo al maximo de |H(k)| de cada banda.
+ * @return false si el procesador ya fue inicializado.
+ */
+bool dspSystem::usarUmbralBins(double dB){
+
+    if (cv_ != 0) {
+        return false;
+    }
+    umbralBins_ = dB;
+    return true;
+}
+
+/**
+ * @brief dspSystem::usarHilos Elige los trabajadores entre los que se reparte cada periodo.
+ * Solo tiene efecto si se llama antes de init(), pues los estados reservan sus buffers
+ * para los trabajadores que existen al preparar los planes.
+ * @param hilos cantidad de trabajadores; 0 procesa todo en el hilo de jack.
+ * @param prioridad prioridad SCHED_FIFO de los trabajadores; 0 usa la politica normal.
+ * @return false si el procesador ya fue inicializado.
+ */
+bool dspSystem::usarHilos(int hilos,int prioridad){
+
+    if (cv_ != 0) {
+        return false;
+    }
+    hilos_ = hilos;
+    prioridadHilos_ = prioridad;
+    return true;
+}
+
+/**
+ * @brief dspSystem::usarEtapas Elige si cada etapa corre en su propio nucleo, con periodos de latencia extra.
+ * Solo tiene efecto si se llama antes de init(), pues la tuberia se crea con el controlVolume.
+ * @param periodos periodos de latencia que se agregan (a lo sumo stagePipeline::MaxPeriodos); 0 procesa
+ * todo en el hilo de jack.
+ * @param prioridad prioridad SCHED_FIFO de las etapas; 0 usa la politica normal.
+ * @return false si el procesador ya fue inicializado.
+ */
+bool dspSystem::usarEtapas(int periodos,int prioridad){
+
+    if (cv_ != 0) {
+        return false;
+    }
+    etapas_ = periodos;
+    prioridadEtapas_ = prioridad;
+    return true;
 }
 
 /**
@@ -144,7 +244,8 @@ void dspSystem::updateG16k(int value){
  */
 void dspSystem::updateReverbA(int value){
 
-    aReverb_ = value;
+    parametros_.aReverb = value;
+    publicar();
 }
 
 /**
@@ -153,7 +254,8 @@ void dspSystem::updateReverbA(int value){
  */
 void dspSystem::updateReverbD(int value){
 
-    dReverb_ = value;
+    parametros_.dReverb = value;
+    publicar();
 }
 
 /**
@@ -162,7 +264,8 @@ void dspSystem::updateReverbD(int value){
  */
 void dspSystem::updateReverbEnabled(bool enabled){
 
-    reverbEnabled = enabled;
+    parametros_.reverbEnabled = enabled;
+    publicar();
 }
 
 /**
@@ -171,7 +274,69 @@ void dspSystem::updateReverbEnabled(bool enabled){
  */
 void dspSystem::updateReverbType(int value){
 
-    typeReverb = value;
+    parametros_.typeReverb = value;
+    publicar();
+}
+
+/**
+ * @brief dspSystem::updateEngine Metodo que selecciona el motor de filtrado del ecualizador
+ * @param value controlVolume::MotorBandas, controlVolume::MotorCompuesto, controlVolume::MotorIIR,
+ *        controlVolume::MotorParticionado o controlVolume::MotorMultitasa
+ */
+void dspSystem::updateEngine(int value){
+
+    parametros_.engine = value;
+    publicar();
+}
+
+/**
+ * @brief dspSystem::updateMetering Metodo que activa el calculo de la salida de cada banda para los medidores
+ * @param enabled booleano que indica si los medidores estan activos
+ */
+void dspSystem::updateMetering(bool enabled){
+
+    parametros_.metering = enabled;
+    publicar();
+}
+
+/**
+ * @brief dspSystem::beginUpdate Inicia un grupo de cambios que se publica completo en endUpdate()
+ */
+void dspSystem::beginUpdate(){
+
+    ++cambiosAbiertos_;
+}
+
+/**
+ * @brief dspSystem::endUpdate Termina un grupo de cambios y lo publica
+ */
+void dspSystem::endUpdate(){
+
+    if (cambiosAbiertos_ > 0) {
+        --cambiosAbiertos_;
+    }
+    publicar();
+}
+
+/**
+ * @brief dspSystem::restart Pide reiniciar las historias de los filtros en el siguiente periodo
+ */
+void dspSystem::restart(){
+
+    ++parametros_.reinicios;
+    publicar();
+}
+
+/**
+ * @brief dspSystem::publicar Copia los parametros completos a la copia del escritor y la publica.
+ * Dentro de beginUpdate()/endUpdate() no publica, para no entregar cambios a medias.
+ */
+void dspSystem::publicar(){
+
+    if (cambiosAbiertos_ == 0) {
+        publicados_.escribir() = parametros_;
+        publicados_.publicar();
+    }
 }
 
 /**
@@ -182,24 +347,53 @@ bool dspSystem::init(const int sampleRate,const int bufferSize) {
 
   sampleRate_ = sampleRate;
   bufferSize_ = bufferSize;
-  volumeGain_ = 25;
-  g32_ = 25;
-  g64_ = 25;
-  g125_ = 25;
-  g250_ = 25;
-  g500_ = 25;
-  g1k_ = 25;
-  g2k_ = 25;
-  g4k_ = 25;
-  g8k_ = 25;
-  g16k_ = 25;
-  aReverb_ = 70;
-  dReverb_ = 1024;
-  reverbEnabled = true;
-  typeReverb = 0;
 
+  beginUpdate();
+  parametros_.volumeGain = 25;
+  for (int b=0;b<filterBank::MaxBandas;++b) {
+    parametros_.ganancias[b] = 25;
+  }
+  parametros_.aReverb = 70;
+  parametros_.dReverb = 1024;
+  parametros_.reverbEnabled = true;
+  parametros_.typeReverb = 0;
+  endUpdate();
+
+  delete grafo_;
+  grafo_=0;
+  delete tuberia_;
+  tuberia_=0;
   delete cv_;
-  cv_=new controlVolume();
+  cv_=new controlVolume(banco_);
+  cv_->usarUmbralBins(umbralBins_);
+  if (hilos_ > 0) {
+    cv_->usarHilos(hilos_,prioridadHilos_);
+  }
+  std::cerr << "SIMD kernels: " << simdKernels::seleccionados().nombre << std::endl;
+
+  // Los filtros y los planes de FFTW se crean aqui, fuera del hilo de tiempo real.
+  cv_->prepararPlanes(sampleRate_,bufferSize_);
+  cv_->reportarRespuestas(std::cerr);
+
+  // Las etapas van en los nucleos que siguen a los de los trabajadores.
+  if (etapas_ > 0) {
+    tuberia_=new stagePipeline(cv_,etapas_);
+    tuberia_->iniciar(hilos_+1,prioridadEtapas_);
+    std::cerr << "Pipelined stages: " << tuberia_->periodos()
+              << " periods of added latency" << std::endl;
+  } else {
+    periodo_ = parametros_;
+    grafo_=new processorGraph;
+    eqNode* ecualizador=new eqNode(cv_,&periodo_);
+    const int eq=grafo_->addNode(ecualizador);
+    const int reverb=grafo_->addNode(new reverbNode(&periodo_,ecualizador));
+    const int medidores=grafo_->addNode(new analyzerNode(&spectral_,ecualizador));
+    grafo_->connect(processorGraph::Input,eq);
+    grafo_->connect(eq,reverb);
+    grafo_->connect(reverb,processorGraph::Output);
+    grafo_->connect(reverb,medidores);
+    grafo_->init(sampleRate_,bufferSize_);
+  }
 
   return true;
 }
@@ -207,14 +401,42 @@ bool dspSystem::init(const int sampleRate,const int bufferSize) {
 
 /**
  * Processing function
+ *
+ * The block size is the one given by jack in this call.  If the tables for it
+ * are not ready yet, controlVolume produces silence until the design thread
+ * publishes them.  controlVolume only writes each output after reading the
+ * whole input block, so in-place blocks need no special handling.  With
+ * pipelined stages the block is copied into the pipeline and the output is
+ * the one of the block given usarEtapas() periods before; otherwise it runs
+ * through the processing graph, whose nodes read the parameters of the block.
  */
-bool dspSystem::process(float* in,float* out) {
-
-  float* tmpIn = in;
-  float* tmpOut = out;
-
-  cv_->filter(bufferSize_,volumeGain_,g32_,g64_,g125_,g250_,g500_,g1k_,g2k_,g4k_,g8k_,g16k_,tmpIn,tmpOut,aReverb_, dReverb_, reverbEnabled, typeReverb,&this->spectral_);
-
+bool dspSystem::process(float* const* in,
+                        float* const* out,
+                        const int channels,
+                        const int nframes,
+                        const bool inPlace,
+                        const processContext& context) {
+
+  // Una sola lectura por periodo de la ultima copia completa de los parametros.
+  const Parametros& p = publicados_.tomar();
+
+  const bool reiniciar = (p.reinicios != reiniciosVistos_);
+  reiniciosVistos_ = p.reinicios;
+
+  // En la tuberia los parametros viajan con el bloque hasta el hilo del ecualizador.
+  if (tuberia_ != 0) {
+    if (channels >= 1) {
+      tuberia_->procesar(p,reiniciar,in,out,std::min(channels,2),nframes,&this->spectral_);
+    }
+    for (int c=2;c<channels;++c) {
+      memset(out[c],0,sizeof(float)*nframes);
+    }
+    return true;
+  }
+
+  // El ecualizador del grafo atiende los reinicios de periodo_.
+  periodo_ = p;
+  grafo_->process(in,out,channels,nframes,inPlace,context);
   return true;
 }
 
@@ -227,16 +449,45 @@ bool dspSystem::shutdown() {
 
 /**
  * Set buffer size (call-back)
+ *
+ * The tables for the new size are taken from the cache, if the size was used
+ * before, or built by the design thread of controlVolume, and published
+ * atomically to the real-time thread. The processing graph compiles and
+ * publishes its plan for the new size in its own design thread as well.
+ * This call never blocks.
  */
 int dspSystem::setBufferSize(const int bufferSize) {
+  if (grafo_!=0) {
+    grafo_->setBufferSize(bufferSize);
+  } else if (cv_!=0) {
+    cv_->solicitarPlanes(sampleRate_,bufferSize);
+  }
   bufferSize_=bufferSize;
   return 1;
 }
 
 /**
  * Set sample rate (call-back)
+ *
+ * The band filters are redesigned for the new rate (or taken from the cache,
+ * if the rate was used before) together with the tables of the current
+ * buffer size, in the design thread of controlVolume.
  */
 int dspSystem::setSampleRate(const int sampleRate) {
+  if (grafo_!=0) {
+    grafo_->setSampleRate(sampleRate);
+  } else if ((cv_!=0) && (bufferSize_>0)) {
+    cv_->solicitarPlanes(sampleRate,bufferSize_);
+  }
   sampleRate_=sampleRate;
   return 1;
 }
+
+/**
+ * Algorithmic latency of the equalizer engine, plus the periods added by
+ * the pipelined stages
+ */
+int dspSystem::latency() const {
+  const int tuberia = (tuberia_!=0) ? tuberia_->periodos()*bufferSize_ : 0;
+  return ((cv_!=0) ? cv_->latencia() : 0) + tuberia;
+}
@@ -28,11 +28,16 @@
 #ifndef DSPSYSTEM_H
 #define DSPSYSTEM_H
 
-#include "processor.h"
+#include "processorv2.h"
 #include "controlvolume.h"
+#include "stagepipeline.h"
+#include "processorgraph.h"
+#include "filterbank.h"
 #include "spectralvalues.h"
+#include "parametros.h"
+#include "triplebuffer.h"
 
-class dspSystem : public processor {
+class dspSystem : public processorV2 {
 public:
 
   /**
@@ -52,8 +57,18 @@ public:
 
   /**
    * Processing function
+   *
+   * Mono blocks and the first two channels of larger blocks (left and
+   * right) are equalized; any other channel is silenced.  In-place blocks
+   * are supported.  Unless the stages are pipelined, the block runs through
+   * the processing graph (equalizer, reverberator and analyzer).
    */
-  virtual bool process(float* in,float* out);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
 
   /**
    * Shutdown the processor
@@ -70,6 +85,12 @@ public:
    */
   virtual int setSampleRate(const int sampleRate);
 
+  /**
+   * Algorithmic latency of the equalizer engine, plus the periods added by
+   * the pipelined stages
+   */
+  virtual int latency() const;
+
   void updateVolume(int value);
 
   /*
@@ -86,6 +107,32 @@ public:
   void updateG8k(int value);
   void updateG16k(int value);
 
+  /*
+   * Selecciona las bandas del ecualizador (por defecto las 10 de octava).
+   * Debe llamarse antes de init(); cada slider controla las bandas de su grupo.
+   */
+  bool usarBandas(const filterBank& banco);
+
+  /*
+   * Fija el umbral, en dB respecto al maximo de cada banda, bajo el cual los
+   * terminos de H(k) se tratan como cero. Debe llamarse antes de init().
+   */
+  bool usarUmbralBins(double dB);
+
+  /*
+   * Reparte cada periodo entre hilos trabajadores fijos a otros nucleos, con
+   * la prioridad SCHED_FIFO dada (0: politica normal). Debe llamarse antes
+   * de init(); 0 trabajadores procesa todo en el hilo de jack.
+   */
+  bool usarHilos(int hilos,int prioridad);
+
+  /*
+   * Ejecuta el ecualizador y la reverberacion cada uno en su propio nucleo
+   * (ver stagePipeline), a cambio de periodos de latencia extra. Debe llamarse antes de init(); 0 periodos procesa todo en el hilo
+   * de jack.
+   */
+  bool usarEtapas(int periodos,int prioridad);
+
   /*
    * Metodos que se utilizan en la reverberacion
    */
@@ -94,6 +141,24 @@ public:
   void updateReverbEnabled(bool enabled);
   void updateReverbType(int value);
 
+  /*
+   * Metodos que seleccionan el motor de filtrado y la medicion por banda
+   */
+  void updateEngine(int value);
+  void updateMetering(bool enabled);
+
+  /*
+   * Metodos que agrupan varios cambios (por ejemplo un preset) en una sola
+   * publicacion, de modo que el hilo de tiempo real nunca ve uno a medias.
+   */
+  void beginUpdate();
+  void endUpdate();
+
+  /*
+   * Pide reiniciar las historias de los filtros (al cambiar de archivo).
+   */
+  void restart();
+
   /**
    * Sample rate
    */
@@ -105,28 +170,10 @@ public:
   int bufferSize_;
 
   /**
-   * VolumeGain
+   * Parametros que modifica la interfaz grafica. Solo los usa el hilo de la
+   * interfaz; cada cambio se publica completo en publicados_.
    */
-
-  int volumeGain_;
-
-  // Constantes donde se almacena el valor de cada slider.
-  int g32_;
-  int g64_;
-  int g125_;
-  int g250_;
-  int g500_;
-  int g1k_;
-  int g2k_;
-  int g4k_;
-  int g8k_;
-  int g16k_;
-
-  // Constantes para la reverberacion
-  int aReverb_;
-  int dReverb_;
-  bool reverbEnabled;
-  int typeReverb;
+  Parametros parametros_;
 
   // Struct Estimación Espectral
   Spectral spectral_;
@@ -136,6 +183,65 @@ public:
    */
   controlVolume* cv_;
 
+private:
+
+  /**
+   * @brief actualizarGrupo Asigna value a las bandas del grupo de un slider y publica.
+   */
+  void actualizarGrupo(int grupo,int value);
+
+  /**
+   * Bandas con las que se construye el controlVolume.
+   */
+  filterBank banco_;
+
+  /**
+   * Umbral de los terminos de H(k) con el que se construye el controlVolume, en dB.
+   */
+  double umbralBins_;
+
+  /**
+   * Trabajadores y su prioridad con los que se inicia el controlVolume.
+   */
+  int hilos_;
+  int prioridadHilos_;
+
+  /**
+   * Periodos de latencia y prioridad con los que se crea la tuberia, y la
+   * tuberia (0 si se procesa en el hilo de jack).
+   */
+  int etapas_;
+  int prioridadEtapas_;
+  stagePipeline* tuberia_;
+
+  /**
+   * Grafo de procesamiento del hilo de jack (0 con la tuberia): entrada ->
+   * ecualizador -> reverberador -> salida, con el analizador leyendo la
+   * salida del reverberador. Sus nodos leen los parametros de periodo_, la
+   * copia del bloque en curso.
+   */
+  processorGraph* grafo_;
+  Parametros periodo_;
+
+  /**
+   * @brief publicar Publica parametros_ al hilo de tiempo real, salvo dentro de beginUpdate()/endUpdate().
+   */
+  void publicar();
+
+  /**
+   * Copias de los parametros entre la interfaz (escritor) y process() (lector).
+   */
+  tripleBuffer<Parametros> publicados_;
+
+  /**
+   * Cantidad de beginUpdate() sin su endUpdate().
+   */
+  int cambiosAbiertos_;
+
+  /**
+   * Ultimo valor de Parametros::reinicios visto por process().
+   */
+  int reiniciosVistos_;
 
 };
 
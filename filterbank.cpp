@@ -0,0 +1,187 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   filterbank.cpp
+ *         Band layout of the equalizer: an arbitrary list of band-pass
+ *         bands, loadable from a configuration file.
+ *
+ * $Id: filterbank.cpp $
+ */
+
+#include "filterbank.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+  /*
+   * Bordes de las diez bandas de octava en Hz, de 32Hz a 16kHz. Con fs = 44100 Hz
+   * reproducen los coeficientes con los que se diseno originalmente el ecualizador.
+   */
+  const double bordesOctava[filterBank::Grupos][2] = {
+    {   22.627416998,   45.254833996},
+    {   45.254833996,   90.509667992},
+    {   90.509667992,  176.776695297},
+    {  176.776695297,  353.553390593},
+    {  353.553390593,  707.106781187},
+    {  707.106781187, 1414.213562373},
+    { 1414.213562373, 2828.427124746},
+    { 2828.427124746, 5656.854249492},
+    { 5656.854249492,11313.708498985},
+    {11313.708498985,22627.416997970}
+  };
+
+  /*
+   * Frecuencia nominal de cada slider.
+   */
+  const double nominales[filterBank::Grupos] = {
+    32.0,64.0,125.0,250.0,500.0,1000.0,2000.0,4000.0,8000.0,16000.0
+  };
+}
+
+/*
+ * Constructor
+ */
+filterBank::filterBank()
+  : bandas_(Grupos) {
+
+  for (int b=0;b<bandas_;++b) {
+    lista_[b].inferior = bordesOctava[b][0];
+    lista_[b].superior = bordesOctava[b][1];
+  }
+  agrupar();
+}
+
+filterBank filterBank::tercioDeOctava() {
+
+  // Centros de base 10 de la norma: 1000*10^(k/10) con k=-17..13 (20Hz ... 20kHz),
+  // y bordes a medio tercio de octava (10^(1/20)) de cada lado.
+  filterBank banco;
+  banco.bandas_ = 31;
+  const double medio = std::pow(10.0,1.0/20.0);
+  for (int b=0;b<banco.bandas_;++b) {
+    const double centro = 1000.0*std::pow(10.0,(b-17)/10.0);
+    banco.lista_[b].inferior = centro/medio;
+    banco.lista_[b].superior = centro*medio;
+  }
+  banco.agrupar();
+  return banco;
+}
+
+bool filterBank::cargar(const char* archivo) {
+
+  std::ifstream entrada(archivo);
+  if (!entrada) {
+    std::cerr << "filterBank: no se pudo abrir " << archivo << std::endl;
+    return false;
+  }
+
+  Banda leidas[MaxBandas];
+  int n = 0;
+  int linea = 0;
+  std::string texto;
+  while (std::getline(entrada,texto)) {
+    ++linea;
+    const std::string::size_type comentario = texto.find('#');
+    if (comentario != std::string::npos) {
+      texto.erase(comentario);
+    }
+
+    std::istringstream campos(texto);
+    double inferior,superior;
+    if (!(campos >> inferior)) {
+      continue; // linea vacia
+    }
+    std::string resto;
+    if (!(campos >> superior) || (campos >> resto) ||
+        !(inferior > 0.0) || !(superior > inferior)) {
+      std::cerr << "filterBank: " << archivo << ":" << linea
+                << ": se esperan dos frecuencias de borde en Hz" << std::endl;
+      return false;
+    }
+    if (n == MaxBandas) {
+      std::cerr << "filterBank: " << archivo << " tiene mas de "
+                << int(MaxBandas) << " bandas" << std::endl;
+      return false;
+    }
+    leidas[n].inferior = inferior;
+    leidas[n].superior = superior;
+    ++n;
+  }
+
+  if (n == 0) {
+    std::cerr << "filterBank: " << archivo << " no tiene bandas" << std::endl;
+    return false;
+  }
+
+  bandas_ = n;
+  for (int b=0;b<n;++b) {
+    lista_[b] = leidas[b];
+  }
+  agrupar();
+  return true;
+}
+
+int filterBank::bandas() const {
+  return bandas_;
+}
+
+const filterBank::Banda& filterBank::banda(int b) const {
+  return lista_[b];
+}
+
+double filterBank::centro(int b) const {
+  return std::sqrt(lista_[b].inferior*lista_[b].superior);
+}
+
+int filterBank::grupo(int b) const {
+  return grupos_[b];
+}
+
+int filterBank::representante(int g) const {
+  return representantes_[g];
+}
+
+void filterBank::agrupar() {
+
+  for (int b=0;b<bandas_;++b) {
+    const double lc = std::log(centro(b));
+    int mejor = 0;
+    for (int g=1;g<Grupos;++g) {
+      if (std::fabs(lc-std::log(nominales[g])) < std::fabs(lc-std::log(nominales[mejor]))) {
+        mejor = g;
+      }
+    }
+    grupos_[b] = mejor;
+  }
+
+  for (int g=0;g<Grupos;++g) {
+    const double ln = std::log(nominales[g]);
+    int mejor = 0;
+    for (int b=1;b<bandas_;++b) {
+      if (std::fabs(std::log(centro(b))-ln) < std::fabs(std::log(centro(mejor))-ln)) {
+        mejor = b;
+      }
+    }
+    representantes_[g] = mejor;
+  }
+}
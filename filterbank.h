@@ -0,0 +1,122 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   filterbank.h
+ *         Band layout of the equalizer: an arbitrary list of band-pass
+ *         bands, loadable from a configuration file.
+ *
+ * $Id: filterbank.h $
+ */
+
+#ifndef FILTERBANK_H
+#define FILTERBANK_H
+
+/**
+ * Distribucion de las bandas del ecualizador.
+ *
+ * Cada banda es un pasabanda entre dos frecuencias de borde. Por omision son
+ * las diez bandas de octava de 32Hz a 16kHz; tercioDeOctava() da las 31 bandas
+ * de tercio de octava de 20Hz a 20kHz y cargar() lee cualquier otra lista de
+ * un archivo de texto.
+ *
+ * La interfaz grafica tiene diez sliders, uno por octava nominal (32Hz ...
+ * 16kHz). Cada banda pertenece al grupo del slider cuya frecuencia nominal
+ * esta mas cerca de su centro en escala logaritmica.
+ */
+class filterBank {
+public:
+
+    /**
+     * Constantes del banco.
+     */
+    enum {
+      MaxBandas=64, /**< Cantidad maxima de bandas. */
+      Grupos=10     /**< Sliders de la interfaz (octavas nominales de 32Hz a 16kHz). */
+    };
+
+    /**
+     * Bordes de una banda en Hz.
+     */
+    struct Banda {
+      double inferior; /**< Frecuencia de borde inferior. */
+      double superior; /**< Frecuencia de borde superior. */
+    };
+
+    /**
+     * Constructor: las diez bandas de octava del ecualizador.
+     */
+    filterBank();
+
+    /**
+     * @brief tercioDeOctava Las 31 bandas de tercio de octava de 20Hz a 20kHz (ISO 266).
+     */
+    static filterBank tercioDeOctava();
+
+    /**
+     * @brief cargar Lee la lista de bandas de un archivo de texto.
+     *
+     * Cada linea tiene las frecuencias de borde inferior y superior de una
+     * banda en Hz, separadas por espacios. Las lineas vacias y lo que sigue a
+     * '#' se ignoran. Si el archivo no se puede leer, alguna linea no es valida
+     * o hay mas de MaxBandas bandas, la distribucion anterior no cambia.
+     * @param archivo ruta del archivo.
+     * @return false si no se cargo.
+     */
+    bool cargar(const char* archivo);
+
+    /**
+     * Cantidad de bandas.
+     */
+    int bandas() const;
+
+    /**
+     * @brief banda Bordes de la banda b.
+     */
+    const Banda& banda(int b) const;
+
+    /**
+     * @brief centro Frecuencia central (media geometrica de los bordes) de la banda b.
+     */
+    double centro(int b) const;
+
+    /**
+     * @brief grupo Slider de la interfaz al que pertenece la banda b (0 para 32Hz ... 9 para 16kHz).
+     */
+    int grupo(int b) const;
+
+    /**
+     * @brief representante Banda cuyo centro esta mas cerca de la frecuencia nominal de un grupo;
+     * es la que muestran los medidores de ese slider.
+     */
+    int representante(int g) const;
+
+private:
+
+    /**
+     * @brief agrupar Calcula el grupo de cada banda y el representante de cada grupo.
+     */
+    void agrupar();
+
+    int bandas_;
+    Banda lista_[MaxBandas];
+    int grupos_[MaxBandas];
+    int representantes_[Grupos];
+};
+
+#endif // FILTERBANK_H
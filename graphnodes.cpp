@@ -0,0 +1,305 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   graphnodes.cpp
+ *         Processing graph nodes: equalizer, reverberator, gain and
+ *         analyzer, each one a processorV2.
+ *
+ * $Id: graphnodes.cpp $
+ */
+
+#include "graphnodes.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+  /*
+   * Indica si las n muestras son todas cero.
+   */
+  bool esSilencio(const float* x,int n) {
+    for (int i=0;i<n;++i) {
+      if (x[i] != 0.0f) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*
+   * Escribe silencio en los canales [desde,hasta) de out.
+   */
+  void silenciar(float* const* out,int desde,int hasta,int nframes) {
+    for (int c=desde;c<hasta;++c) {
+      memset(out[c],0,sizeof(float)*nframes);
+    }
+  }
+}
+
+/*
+ * Constructor
+ */
+eqNode::eqNode(controlVolume* cv,const Parametros* parametros)
+  : cv_(cv),parametros_(parametros),sampleRate_(0),bufferSize_(0),
+    reiniciosVistos_(parametros->reinicios),valido_(false),omitido_(false) {
+  for (int g=0;g<filterBank::Grupos;++g) {
+    medidores_[g]=0.0f;
+  }
+}
+
+bool eqNode::init(const int frameRate,const int bufferSize) {
+  sampleRate_=frameRate;
+  bufferSize_=bufferSize;
+  cv_->prepararPlanes(frameRate,bufferSize);
+  return true;
+}
+
+/*
+ * Processing function
+ */
+bool eqNode::process(float* const* in,
+                     float* const* out,
+                     const int channels,
+                     const int nframes,
+                     const bool /*inPlace*/,
+                     const processContext& /*context*/) {
+
+  const Parametros& p = *parametros_;
+  if (p.reinicios != reiniciosVistos_) {
+    cv_->inicio = true;
+    reiniciosVistos_ = p.reinicios;
+  }
+  cv_->motor = p.engine;
+  cv_->medirBandas = p.metering;
+
+  const int canales = std::min(channels,int(controlVolume::MaxCanales));
+  valido_ = (canales >= 1) &&
+    cv_->ecualizar(canales,nframes,p.volumeGain,p.ganancias,in,out,medidores_,omitido_);
+  if (!valido_) {
+    silenciar(out,0,canales,nframes);
+  }
+  silenciar(out,canales,channels,nframes);
+  return valido_;
+}
+
+bool eqNode::shutdown() {
+  return true;
+}
+
+/*
+ * El estado del tamano nuevo lo construye el hilo de diseno del
+ * controlVolume; mientras tanto la salida es silencio.
+ */
+int eqNode::setBufferSize(const int bufferSize) {
+  cv_->solicitarPlanes(sampleRate_,bufferSize);
+  bufferSize_=bufferSize;
+  return 1;
+}
+
+int eqNode::setSampleRate(const int sampleRate) {
+  if (bufferSize_ > 0) {
+    cv_->solicitarPlanes(sampleRate,bufferSize_);
+  }
+  sampleRate_=sampleRate;
+  return 1;
+}
+
+int eqNode::latency() const {
+  return cv_->latencia();
+}
+
+bool eqNode::valido() const {
+  return valido_;
+}
+
+bool eqNode::omitido() const {
+  return omitido_;
+}
+
+const float* eqNode::medidores() const {
+  return medidores_;
+}
+
+/*
+ * Constructor
+ */
+reverbNode::reverbNode(const Parametros* parametros,const eqNode* ecualizador)
+  : parametros_(parametros),ecualizador_(ecualizador) {
+}
+
+bool reverbNode::init(const int /*frameRate*/,const int /*bufferSize*/) {
+  reverb_.reiniciar();
+  return true;
+}
+
+/*
+ * Processing function
+ */
+bool reverbNode::process(float* const* in,
+                         float* const* out,
+                         const int channels,
+                         const int nframes,
+                         const bool /*inPlace*/,
+                         const processContext& /*context*/) {
+
+  const Parametros& p = *parametros_;
+  const int canales = std::min(channels,int(reverbUnit::MaxCanales));
+  silenciar(out,canales,channels,nframes);
+  if (canales < 1) {
+    return true;
+  }
+
+  // Sin ecualizacion el bloque es silencio y las historias no avanzan.
+  if ((ecualizador_ != 0) && !ecualizador_->valido()) {
+    silenciar(out,0,canales,nframes);
+    return true;
+  }
+
+  bool reposo = true;
+  if (ecualizador_ != 0) {
+    reposo = ecualizador_->omitido();
+  } else {
+    for (int c=0;c<canales;++c) {
+      reposo = reposo && esSilencio(in[c],nframes);
+    }
+  }
+
+  reverb_.procesar(canales,nframes,in,out,p.aReverb,p.dReverb,p.reverbEnabled,p.typeReverb,reposo);
+  return true;
+}
+
+bool reverbNode::shutdown() {
+  return true;
+}
+
+int reverbNode::setBufferSize(const int /*bufferSize*/) {
+  return 1;
+}
+
+int reverbNode::setSampleRate(const int /*sampleRate*/) {
+  return 1;
+}
+
+/*
+ * Constructor
+ */
+gainNode::gainNode(int ganancia)
+  : ganancia_(ganancia),anterior_(-1),nucleos_(simdKernels::seleccionados()) {
+}
+
+void gainNode::fijar(int ganancia) {
+  ganancia_.store(ganancia,std::memory_order_relaxed);
+}
+
+bool gainNode::init(const int /*frameRate*/,const int /*bufferSize*/) {
+  return true;
+}
+
+/*
+ * Processing function
+ */
+bool gainNode::process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool /*inPlace*/,
+                       const processContext& /*context*/) {
+
+  // La ganancia pasa de la del bloque anterior a la actual a lo largo del
+  // bloque; rampa() lee cada muestra antes de escribirla, por lo que en
+  // sitio no hace falta copiar.
+  const int ganancia = ganancia_.load(std::memory_order_relaxed);
+  const float inicial = 0.02f * ((anterior_ < 0) ? ganancia : anterior_);
+  const float paso = (0.02f * ganancia - inicial)/std::max(1,nframes);
+  for (int c=0;c<channels;++c) {
+    nucleos_.rampa(in[c],inicial,paso,out[c],nframes);
+  }
+  anterior_ = ganancia;
+  return true;
+}
+
+bool gainNode::shutdown() {
+  return true;
+}
+
+int gainNode::setBufferSize(const int /*bufferSize*/) {
+  return 1;
+}
+
+int gainNode::setSampleRate(const int /*sampleRate*/) {
+  return 1;
+}
+
+/*
+ * Constructor
+ */
+analyzerNode::analyzerNode(Spectral* spectral,const eqNode* ecualizador)
+  : spectral_(spectral),ecualizador_(ecualizador) {
+}
+
+bool analyzerNode::init(const int /*frameRate*/,const int /*bufferSize*/) {
+  return true;
+}
+
+/*
+ * Processing function
+ *
+ * Como en controlVolume::filter(), la entrada no pasa por spec(), pues
+ * escribirMedidores() sobrescribe todos sus valores.
+ */
+bool analyzerNode::process(float* const* in,
+                           float* const* out,
+                           const int channels,
+                           const int nframes,
+                           const bool inPlace,
+                           const processContext& /*context*/) {
+
+  if (!inPlace) {
+    for (int c=0;c<channels;++c) {
+      memcpy(out[c],in[c],sizeof(float)*nframes);
+    }
+  }
+  if ((channels < 1) || (nframes < 1) ||
+      ((ecualizador_ != 0) && !ecualizador_->valido())) {
+    return true;
+  }
+
+  static const float sinBandas[filterBank::Grupos] = {};
+  controlVolume::escribirMedidores(in[0][nframes/2],
+                                   (ecualizador_ != 0) ? ecualizador_->medidores() : sinBandas,
+                                   spectral_);
+  return true;
+}
+
+bool analyzerNode::shutdown() {
+  return true;
+}
+
+int analyzerNode::setBufferSize(const int /*bufferSize*/) {
+  return 1;
+}
+
+int analyzerNode::setSampleRate(const int /*sampleRate*/) {
+  return 1;
+}
+
+bool analyzerNode::readOnly() const {
+  return true;
+}
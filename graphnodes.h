@@ -0,0 +1,230 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   graphnodes.h
+ *         Processing graph nodes: equalizer, reverberator, gain and
+ *         analyzer, each one a processorV2.
+ *
+ * $Id: graphnodes.h $
+ */
+
+#ifndef GRAPHNODES_H
+#define GRAPHNODES_H
+
+#include <atomic>
+
+#include "processorv2.h"
+#include "controlvolume.h"
+#include "reverbunit.h"
+#include "filterbank.h"
+#include "spectralvalues.h"
+#include "parametros.h"
+#include "simdkernels.h"
+
+/**
+ * Nodo del ecualizador: las bandas y el volumen de un controlVolume
+ * (controlVolume::ecualizar()).
+ *
+ * Los parametros se leen de *parametros en cada bloque, que el dueno del
+ * grafo actualiza en el hilo de tiempo real antes de procesarlo (por
+ * ejemplo con la copia del periodo de un tripleBuffer). Procesa los dos
+ * primeros canales; los demas quedan en silencio. Admite bloques en sitio
+ * sin copias, pues ecualizar() lee toda la entrada antes de escribir.
+ */
+class eqNode : public processorV2 {
+public:
+
+  /**
+   * Constructor
+   * @param cv ecualizador (no pertenece al nodo; ningun otro hilo debe procesar con el).
+   * @param parametros parametros del bloque en curso.
+   */
+  eqNode(controlVolume* cv,const Parametros* parametros);
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+  virtual int latency() const;
+
+  /**
+   * Indica si el ultimo bloque se ecualizo; si no, su salida fue silencio
+   * (aun no hay estado para el tamano de bloque).
+   */
+  bool valido() const;
+
+  /**
+   * Indica si la salida del ultimo bloque es nula (modo de reposo o volumen
+   * en cero).
+   */
+  bool omitido() const;
+
+  /**
+   * Salida de la banda de cada medidor en el ultimo bloque (filterBank::Grupos valores).
+   */
+  const float* medidores() const;
+
+private:
+
+  controlVolume* cv_;
+  const Parametros* parametros_;
+  int sampleRate_;
+  int bufferSize_;
+
+  /**
+   * Ultimo valor de Parametros::reinicios visto.
+   */
+  int reiniciosVistos_;
+
+  bool valido_;
+  bool omitido_;
+  float medidores_[filterBank::Grupos];
+
+  eqNode(const eqNode&);
+  eqNode& operator=(const eqNode&);
+};
+
+/**
+ * Nodo del reverberador (reverbUnit).
+ *
+ * Los parametros se leen de *parametros como en eqNode. Si se conoce el
+ * ecualizador que lo alimenta, su omitido() indica el reposo del
+ * reverberador y un bloque que el ecualizador no proceso queda en silencio
+ * sin avanzar las historias, igual que en controlVolume::filter(); si no, el
+ * reposo es un bloque de entrada en silencio digital. Admite bloques en
+ * sitio sin copias, pues reverbUnit lee x(n - D) de su linea de retardo.
+ */
+class reverbNode : public processorV2 {
+public:
+
+  /**
+   * Constructor
+   * @param parametros parametros del bloque en curso.
+   * @param ecualizador nodo que alimenta al reverberador, o 0.
+   */
+  reverbNode(const Parametros* parametros,const eqNode* ecualizador = 0);
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+
+private:
+
+  reverbUnit reverb_;
+  const Parametros* parametros_;
+  const eqNode* ecualizador_;
+
+  reverbNode(const reverbNode&);
+  reverbNode& operator=(const reverbNode&);
+};
+
+/**
+ * Nodo de ganancia: multiplica todos los canales por 0.02 veces la posicion
+ * de un slider (la misma escala del volumen), con una rampa dentro del
+ * bloque cuando la ganancia cambia. fijar() puede llamarse desde cualquier
+ * hilo. Admite bloques en sitio sin copias.
+ */
+class gainNode : public processorV2 {
+public:
+
+  /**
+   * Constructor
+   * @param ganancia posicion inicial del slider (50 es ganancia unitaria).
+   */
+  gainNode(int ganancia = 50);
+
+  /**
+   * @brief fijar Cambia la ganancia; se aplica desde el siguiente bloque.
+   */
+  void fijar(int ganancia);
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+
+private:
+
+  std::atomic<int> ganancia_;
+
+  /**
+   * Ganancia del bloque anterior; -1 antes del primero.
+   */
+  int anterior_;
+
+  const simdKernels& nucleos_;
+};
+
+/**
+ * Nodo analizador: escribe los medidores de la interfaz a partir de su
+ * entrada, sin modificarla (readOnly()).
+ *
+ * La muestra principal es la muestra central del primer canal; la de cada
+ * grupo de bandas se toma del ecualizador dado, si lo hay. Como en
+ * controlVolume::filter(), un bloque que el ecualizador no proceso no
+ * cambia los medidores.
+ */
+class analyzerNode : public processorV2 {
+public:
+
+  /**
+   * Constructor
+   * @param spectral valores de los medidores que lee la interfaz.
+   * @param ecualizador nodo del que se toman los medidores de cada banda, o 0.
+   */
+  analyzerNode(Spectral* spectral,const eqNode* ecualizador = 0);
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+  virtual bool readOnly() const;
+
+private:
+
+  Spectral* spectral_;
+  const eqNode* ecualizador_;
+};
+
+#endif // GRAPHNODES_H
@@ -26,10 +26,14 @@
  */
 
 #include "jack.h"
+#include "rtguard.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
+
+#include <algorithm>
 
 #include <iostream>
 
@@ -127,14 +131,19 @@ int jack::sampleRate_=0;
 int jack::bufferSize_=0;
 
 /*
- * Input port
+ * Number of ports in use
+ */
+int jack::ports_=jack::Channels;
+
+/*
+ * Input ports
  */
-jack_port_t* jack::inputPort_=0;
+jack_port_t* jack::inputPorts_[jack::MaxPorts]={0};
 
 /*
- * Output port
+ * Output ports
  */
-jack_port_t* jack::outputPort_=0;
+jack_port_t* jack::outputPorts_[jack::MaxPorts]={0};
 
 /*
  * Jack client
@@ -144,7 +153,18 @@ jack_client_t* jack::client_=0;
 /*
  * Pointer to the current used processor
  */
-processor* jack::dsp_=0;
+processorV2* jack::dsp_=0;
+
+/*
+ * Adapter for processors of the first interface revision
+ */
+processorAdapter jack::adapter_;
+
+/*
+ * Xruns reported by jack and already seen by process
+ */
+std::atomic<int> jack::xruns_(0);
+int jack::xrunsSeen_=0;
 
 /*
  * Handler to file being played
@@ -261,10 +281,16 @@ void jack::close() {
 }
 
 void jack::init(processor* proc) {
+  adapter_.use(proc);
+  init(&adapter_);
+}
+
+void jack::init(processorV2* proc,int channels) {
 
   _debug("jack::init()\n");
 
   dsp_ = proc;
+  ports_ = std::max(1,std::min(channels,int(MaxPorts)));
 
   const char **ports;
   static const char *clientName = "simple";
@@ -317,6 +343,14 @@ void jack::init(processor* proc) {
     std::cerr << "Unable to set sample rate callback" << std::endl;
   }
 
+  if (jack_set_latency_callback(client_,jack::latencyChanged,dsp_)!=0) {
+    std::cerr << "Unable to set latency callback" << std::endl;
+  }
+
+  if (jack_set_xrun_callback(client_,jack::xrunOccurred,dsp_)!=0) {
+    std::cerr << "Unable to set xrun callback" << std::endl;
+  }
+
   /*
    * Get sample rate and buffer size
    */
@@ -329,17 +363,31 @@ void jack::init(processor* proc) {
 
   _debug(" create ports\n");
 
-  /* create two ports */
-  inputPort_ = jack_port_register (client_, "input",
-                                   JACK_DEFAULT_AUDIO_TYPE,
-                                   JackPortIsInput, 0);
-  outputPort_ = jack_port_register (client_, "output",
-                                    JACK_DEFAULT_AUDIO_TYPE,
-                                    JackPortIsOutput, 0);
+  /* create the left and right ports, or numbered ports for more channels */
+  static const char* inputNames[Channels]  = { "input_left", "input_right" };
+  static const char* outputNames[Channels] = { "output_left", "output_right" };
 
-  if ((inputPort_ == NULL) || (outputPort_ == NULL)) {
-    std::cerr << "no more JACK ports available" << std::endl;
-    exit (1);
+  for (int c=0;c<ports_;++c) {
+    char inputName[32], outputName[32];
+    if (ports_ == Channels) {
+      snprintf(inputName,sizeof(inputName),"%s",inputNames[c]);
+      snprintf(outputName,sizeof(outputName),"%s",outputNames[c]);
+    } else {
+      snprintf(inputName,sizeof(inputName),"input_%d",c+1);
+      snprintf(outputName,sizeof(outputName),"output_%d",c+1);
+    }
+
+    inputPorts_[c] = jack_port_register (client_, inputName,
+                                         JACK_DEFAULT_AUDIO_TYPE,
+                                         JackPortIsInput, 0);
+    outputPorts_[c] = jack_port_register (client_, outputName,
+                                          JACK_DEFAULT_AUDIO_TYPE,
+                                          JackPortIsOutput, 0);
+
+    if ((inputPorts_[c] == NULL) || (outputPorts_[c] == NULL)) {
+      std::cerr << "no more JACK ports available" << std::endl;
+      exit (1);
+    }
   }
 
   /* Tell the JACK server that we are ready to roll.  Our
@@ -365,13 +413,37 @@ void jack::init(processor* proc) {
     exit (1);
   }
 
+  if (ports_ != Channels) {
+    /* connect each port to the physical port with the same number */
+    for (int c=0;(c<ports_) && (ports[c] != NULL);++c) {
+      if (jack_connect(client_, ports[c], jack_port_name (inputPorts_[c]))) {
+        std::cerr << "cannot connect input ports" << std::endl;
+      }
+    }
+    free(ports);
+
+    ports=jack_get_ports(client_, NULL,NULL,JackPortIsPhysical|JackPortIsInput);
+    if (ports == NULL) {
+      std::cerr << "no physical playback ports" << std::endl;
+      exit (1);
+    }
+    for (int c=0;(c<ports_) && (ports[c] != NULL);++c) {
+      if (jack_connect(client_,jack_port_name(outputPorts_[c]), ports[c])) {
+        std::cerr << "cannot connect output ports" << std::endl;
+      }
+    }
+    free(ports);
+    return;
+  }
+
   /* connect left microphone */
-  if (jack_connect(client_, ports[0], jack_port_name (inputPort_))) {
+  if (jack_connect(client_, ports[0], jack_port_name (inputPorts_[Left]))) {
     std::cerr << "cannot connect input ports" << std::endl;
   }
 
-  /* connect right microphone */
-  if (jack_connect(client_, ports[1], jack_port_name (inputPort_))) {
+  /* connect right microphone (or the left one again on mono cards) */
+  if (jack_connect(client_, ports[ports[1] != NULL ? 1 : 0],
+                   jack_port_name (inputPorts_[Right]))) {
     std::cerr << "cannot connect input ports" << std::endl;
   }
 
@@ -384,12 +456,12 @@ void jack::init(processor* proc) {
   }
 
   /* connect left speaker */
-  if (jack_connect(client_,jack_port_name(outputPort_), ports[0])) {
+  if (jack_connect(client_,jack_port_name(outputPorts_[Left]), ports[0])) {
     std::cerr << "cannot connect output ports" << std::endl;
   }
 
   /* connect right speaker */
-  if (jack_connect(client_,jack_port_name(outputPort_), ports[1])) {
+  if (jack_connect(client_,jack_port_name(outputPorts_[Right]), ports[1])) {
     std::cerr << "cannot connect output ports" << std::endl;
   }
 
@@ -397,12 +469,12 @@ void jack::init(processor* proc) {
 #ifdef ASUS_EEE
 
   /* connect left speaker */
-  if (jack_connect(client_,jack_port_name(outputPort_), ports[2])) {
+  if (jack_connect(client_,jack_port_name(outputPorts_[Left]), ports[2])) {
     std::cerr << "cannot connect output ports" << std::endl;
   }
 
   /* connect right speaker */
-  if (jack_connect(client_,jack_port_name(outputPort_), ports[3])) {
+  if (jack_connect(client_,jack_port_name(outputPorts_[Right]), ports[3])) {
     std::cerr << "cannot connect output ports" << std::endl;
   }
 #endif
@@ -423,28 +495,55 @@ int jack::process(jack_nframes_t nframes, void *arg) {
   _debug(prog[progIdx] << "\r");
 #endif
 
-  jack_default_audio_sample_t *in, *out;
+  // With CONFIG+=rtcheck any malloc/free from here on aborts the program
+  rtGuard zona;
 
+  jack_default_audio_sample_t *in[MaxPorts], *out[MaxPorts];
+
+  // Files are played through the first two channels; the other ports keep
+  // their capture.
+  int c0 = 0;
   if (playingFile_) {
-    in = audioBuffer_+bufferSize_*(playWindow_%MaxWindows);
+    in[Left] = audioBuffer_+Channels*bufferSize_*(playWindow_%MaxWindows);
+    if (ports_ > Right) {
+      in[Right] = in[Left]+bufferSize_;
+    }
     ++playWindow_;
-  } else {
-    in  = static_cast<jack_default_audio_sample_t*>
-          (jack_port_get_buffer(inputPort_, nframes));
+    c0 = Channels;
   }
-  out = static_cast<jack_default_audio_sample_t*>
-        (jack_port_get_buffer(outputPort_,nframes));
+  for (int c=c0;c<ports_;++c) {
+    in[c] = static_cast<jack_default_audio_sample_t*>
+            (jack_port_get_buffer(inputPorts_[c], nframes));
+  }
+  for (int c=0;c<ports_;++c) {
+    out[c] = static_cast<jack_default_audio_sample_t*>
+             (jack_port_get_buffer(outputPorts_[c],nframes));
+  }
+
+  // The port buffers (or the file windows) are given to the processor as
+  // they are, without copies.  Jack does not guarantee that input and output
+  // buffers are different, so in-place processing is detected here.
+  bool inPlace = true;
+  for (int c=0;c<ports_;++c) {
+    inPlace = inPlace && (in[c] == out[c]);
+  }
+
+  processContext context;
+  context.frameTime = jack_last_frame_time(client_);
+  const int xruns = xruns_.load();
+  context.xrun = (xruns != xrunsSeen_);
+  xrunsSeen_ = xruns;
 
   // return 0 on success, or anything else on error
-  processor* dsp = reinterpret_cast<processor*>(arg);
-  return (dsp->process(in,out))?0:1;
+  processorV2* dsp = reinterpret_cast<processorV2*>(arg);
+  return (dsp->process(in,out,ports_,nframes,inPlace,context))?0:1;
 }
 
 /*
  * Shutdown callback
  */
 void jack::shutdown(void *arg) {
-  processor* ptr=reinterpret_cast<processor*>(arg);
+  processorV2* ptr=reinterpret_cast<processorV2*>(arg);
   ptr->shutdown();
 
   // no server => no client to close
@@ -458,7 +557,7 @@ void jack::shutdown(void *arg) {
  * Callback used to update used sample rate
  */
 int jack::sampleRateChanged(jack_nframes_t nframes, void *arg) {
-  processor* ptr=reinterpret_cast<processor*>(arg);
+  processorV2* ptr=reinterpret_cast<processorV2*>(arg);
   return ptr->setSampleRate(nframes);
 }
 
@@ -466,10 +565,47 @@ int jack::sampleRateChanged(jack_nframes_t nframes, void *arg) {
  * Callback used to update used buffer size
  */
 int jack::bufferSizeChanged(jack_nframes_t nframes, void *arg) {
-  processor* ptr=reinterpret_cast<processor*>(arg);
+  processorV2* ptr=reinterpret_cast<processorV2*>(arg);
   return ptr->setBufferSize(nframes);
 }
 
+/*
+ * Callback used to count the xruns reported by jack
+ */
+int jack::xrunOccurred(void *) {
+  ++xruns_;
+  return 0;
+}
+
+/**
+ * Latency callback
+ *
+ * The latency of the processor is added to the range of the port feeding
+ * the signal: in capture mode it flows from the input to the output port,
+ * and in playback mode from the output back to the input port.
+ */
+void jack::latencyChanged(jack_latency_callback_mode_t mode, void *arg) {
+  processorV2* ptr=reinterpret_cast<processorV2*>(arg);
+  const jack_nframes_t extra = static_cast<jack_nframes_t>(ptr->latency());
+
+  jack_latency_range_t range;
+  if (mode == JackCaptureLatency) {
+    for (int c=0;c<ports_;++c) {
+      jack_port_get_latency_range(inputPorts_[c],mode,&range);
+      range.min += extra;
+      range.max += extra;
+      jack_port_set_latency_range(outputPorts_[c],mode,&range);
+    }
+  } else {
+    for (int c=0;c<ports_;++c) {
+      jack_port_get_latency_range(outputPorts_[c],mode,&range);
+      range.min += extra;
+      range.max += extra;
+      jack_port_set_latency_range(inputPorts_[c],mode,&range);
+    }
+  }
+}
+
 /*
  * Stop playing from files (the capture will continue from the mic
  */
@@ -554,7 +690,7 @@ bool jack::play(const char* filename) {
   _debug(" File channels   : " << fileChannels_ << std::endl);
 
 
-  int newAudioBufferSize_=MaxWindows*bufferSize_;
+  int newAudioBufferSize_=MaxWindows*Channels*bufferSize_;
   if (audioBufferSize_ < newAudioBufferSize_) {
     garbage_.push_back(std::make_pair(MaxWindows+1,audioBuffer_));
 
@@ -601,22 +737,21 @@ int jack::getNextBlock() {
 
     const int last = (cnt*bufferSize_)/windowSize_;
 
-    // now let's interpolate the right samplerate
-    float* wnd=audioBuffer_+wndIndex*bufferSize_;
+    // now let's interpolate the right samplerate.  Mono files go to both
+    // channels; from files with more channels the first two are used.
+    float* left=audioBuffer_+wndIndex*Channels*bufferSize_;
+    float* right=left+bufferSize_;
+    const int r=(fileChannels_>1)?1:0;
     int i;
     for (i=0;i<last;++i) {
-      // we also need to compute the average of all channels.
-      int j=(i*fileSampleRate_/sampleRate_)*fileChannels_;
-      const int ej=j+fileChannels_;
-      float acc=mem[j];
-      for (++j;j<ej;++j) {
-        acc+=mem[j];
-      }
-      wnd[i]=acc/fileChannels_;
+      const int j=(i*fileSampleRate_/sampleRate_)*fileChannels_;
+      left[i]=mem[j];
+      right[i]=mem[j+r];
     }
     // fill the rest with 0s
     for (;i<bufferSize_;++i) {
-      wnd[i]=0.0f;
+      left[i]=0.0f;
+      right[i]=0.0f;
     }
     ++fileWindow_;
   }
@@ -32,6 +32,7 @@
 #include <jack/jack.h>
 #include <sndfile.h>
 
+#include <atomic>
 #include <list>
 #include <utility> // for std::pair
 
@@ -39,11 +40,36 @@
 #include <QMutex>
 
 #include "processor.h"
+#include "processorv2.h"
+#include "processoradapter.h"
 
 class jack {
 public:
+  /**
+   * Audio channels: left and right
+   */
+  enum {
+    Left=0,
+    Right=1,
+    Channels=2,
+    MaxPorts=128
+  };
+
   /**
    * Initialization of jack
+   *
+   * With more than two channels the ports are named input_<n> and
+   * output_<n>, and port n is connected to the n-th physical port when it
+   * exists.  Files are always played through the first two channels.
+   *
+   * @param proc processor that receives all the channels in each period
+   * @param channels number of input and output ports (at most MaxPorts)
+   */
+  static void init(processorV2* proc,int channels=Channels);
+
+  /**
+   * Initialization of jack with a processor of the first interface
+   * revision, which is run through a processorAdapter
    */
   static void init(processor* proc);
 
@@ -104,6 +130,16 @@ private:
    */
   static int bufferSizeChanged(jack_nframes_t nframes, void *arg);
 
+  /**
+   * Callback used to count the xruns reported by jack
+   */
+  static int xrunOccurred(void *arg);
+
+  /**
+   * Callback used to report the latency of the processor to jack
+   */
+  static void latencyChanged(jack_latency_callback_mode_t mode, void *arg);
+
   /**
    * Sample rate used by jack (reproduction and mic capture)
    */
@@ -115,14 +151,19 @@ private:
   static int bufferSize_;
 
   /**
-   * Input port
+   * Number of input and output ports in use
    */
-  static jack_port_t *inputPort_;
+  static int ports_;
 
   /**
-   * Output port
+   * Input ports (left and right for a stereo client)
    */
-  static jack_port_t *outputPort_;
+  static jack_port_t *inputPorts_[MaxPorts];
+
+  /**
+   * Output ports (left and right for a stereo client)
+   */
+  static jack_port_t *outputPorts_[MaxPorts];
 
   /**
    * Jack client
@@ -190,7 +231,20 @@ private:
   /**
    * Pointer to the current used processor
    */
-  static processor* dsp_;
+  static processorV2* dsp_;
+
+  /**
+   * Adapter used when jack is initialized with a processor of the first
+   * interface revision
+   */
+  static processorAdapter adapter_;
+
+  /**
+   * Number of xruns reported by jack, and the number already reported to
+   * the processor through processContext::xrun (only used in process)
+   */
+  static std::atomic<int> xruns_;
+  static int xrunsSeen_;
 
   /**
    * Handler to file being played
@@ -223,7 +277,8 @@ private:
   static int playWindow_;
 
   /**
-   * Buffer with fusioned and sample-rate-fixed buffer
+   * Buffer with sample-rate-fixed windows.  Each window holds bufferSize_
+   * frames of the left channel followed by bufferSize_ of the right one.
    */
    static float* audioBuffer_;
 
@@ -1,8 +1,41 @@
 #include "mainwindow.h"
+#include "multichannelhost.h"
+#include "jack.h"
+
 #include <QApplication>
+#include <QCoreApplication>
+
+#include <cstdio>
+#include <iostream>
 
 int main(int argc, char *argv[])
 {
+    // --channels=<n>[,workers[,priority]] runs a many-channel server without
+    // user interface; --bench-channels=<n>[,cores] measures it offline.
+    for (int i=1;i<argc;++i) {
+      int channels=0, workers=0, priority=0;
+      const int fields=std::sscanf(argv[i],"--channels=%d,%d,%d",&channels,&workers,&priority);
+      if (fields >= 1) {
+        if ((channels < 1) || (channels > multiChannelHost::MaxChannels)) {
+          std::cerr << "--channels: between 1 and " << multiChannelHost::MaxChannels << std::endl;
+          return 1;
+        }
+        QCoreApplication a(argc, argv);
+        multiChannelHost host(channels);
+        host.setWorkers(workers,priority);
+        jack::init(&host,channels);
+        const int result=a.exec();
+        jack::close();
+        return result;
+      }
+
+      int cores=1;
+      if (std::sscanf(argv[i],"--bench-channels=%d,%d",&channels,&cores) >= 1) {
+        multiChannelHost::benchmark(std::cout,channels,cores,48000,256,2000,
+                                    controlVolume::MotorCompuesto);
+        return 0;
+      }
+    }
 
     QApplication a(argc, argv);
     MainWindow w;
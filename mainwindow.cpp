@@ -28,6 +28,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "jack.h"
+#include <iostream>
 #include <string>
 #include <QPalette>
 
@@ -51,6 +52,7 @@ MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
     verbose_(false),
+    reblock_(0),
     dspChanged_(true)
 {
     ui->setupUi(this);
@@ -73,15 +75,64 @@ MainWindow::MainWindow(QWidget *parent) :
     timer_->start(50);
 
     dsp_ = new dspSystem;
-    jack::init(dsp_);
 
     // parse some command line arguments
     QStringList argv(QCoreApplication::arguments());
 
+    // the band layout and the internal block size must be chosen before the
+    // processor is initialized
+    int bloque=0;
+    for (QStringList::const_iterator b=argv.begin();b!=argv.end();++b) {
+      if ((*b)=="--bands=third") {
+        dsp_->usarBandas(filterBank::tercioDeOctava());
+      } else if ((*b).startsWith("--bands=")) {
+        filterBank banco;
+        std::string archivo(qPrintable((*b).mid(8)));
+        if (banco.cargar(archivo.c_str())) {
+          dsp_->usarBandas(banco);
+        }
+      } else if ((*b).startsWith("--block=")) {
+        bloque=(*b).mid(8).toInt();
+      } else if ((*b).startsWith("--bin-threshold=")) {
+        dsp_->usarUmbralBins((*b).mid(16).toDouble());
+      } else if ((*b).startsWith("--workers=")) {
+        // --workers=<n>[,<priority>]: n pinned worker threads, SCHED_FIFO if a priority is given
+        QStringList partes((*b).mid(10).split(','));
+        dsp_->usarHilos(partes.at(0).toInt(),(partes.size()>1) ? partes.at(1).toInt() : 0);
+      } else if ((*b).startsWith("--stages=")) {
+        // --stages=<periods>[,<priority>]: equalizer and reverb on their own cores,
+        // with the given periods of added latency
+        QStringList partes((*b).mid(9).split(','));
+        dsp_->usarEtapas(partes.at(0).toInt(),(partes.size()>1) ? partes.at(1).toInt() : 0);
+      }
+    }
+
+    // with --block=<n> the equalizer runs with blocks of n frames, whatever
+    // the period of jack is
+    if (bloque>0) {
+      reblock_ = new reblockAdapter(dsp_,bloque,jack::Channels);
+      jack::init(reblock_);
+      std::cerr << "Internal block: " << reblock_->internalBlockSize()
+                << " frames, added latency: " << reblock_->addedLatency()
+                << " frames" << std::endl;
+    } else {
+      jack::init(dsp_);
+    }
+
     QStringList::const_iterator it(argv.begin());
     while(it!=argv.end()) {
       if ((*it)=="-v" || (*it)=="--verbose") {
         verbose_=true;
+      } else if ((*it)=="--engine=bands") {
+        dsp_->updateEngine(controlVolume::MotorBandas);
+      } else if ((*it)=="--engine=composite") {
+        dsp_->updateEngine(controlVolume::MotorCompuesto);
+      } else if ((*it)=="--engine=iir") {
+        dsp_->updateEngine(controlVolume::MotorIIR);
+      } else if ((*it)=="--engine=partitioned") {
+        dsp_->updateEngine(controlVolume::MotorParticionado);
+      } else if ((*it)=="--engine=multirate") {
+        dsp_->updateEngine(controlVolume::MotorMultitasa);
       } else if ((*it).indexOf(".wav",0,Qt::CaseInsensitive)>0) {
         ui->fileEdit->setText(*it);
         std::string tmp(qPrintable(*it));
@@ -96,6 +147,7 @@ MainWindow::~MainWindow()
     jack::close();
     delete timer_;
     delete ui;
+    delete reblock_;
     delete dsp_;
 }
 
@@ -236,7 +288,7 @@ void MainWindow::on_fileButton_clicked() {
   if (!selectedFiles_.empty()) {
     ui->fileEdit->setText(*selectedFiles_.begin());
 
-    dsp_->cv_->inicio = true;
+    dsp_->restart();
     jack::stopFiles();
     QStringList::iterator it;
     for (it=selectedFiles_.begin();it!=selectedFiles_.end();++it) {
@@ -259,7 +311,7 @@ void MainWindow::on_actionOpen_wav_triggered()
     if (!selectedFiles_.empty()) {
       ui->fileEdit->setText(*selectedFiles_.begin());
 
-      dsp_->cv_->inicio = true;
+      dsp_->restart();
       jack::stopFiles();
       QStringList::iterator it;
       for (it=selectedFiles_.begin();it!=selectedFiles_.end();++it) {
@@ -412,6 +464,7 @@ void MainWindow::on_f16kSlider_valueChanged(int value)
  */
 void MainWindow::on_actionClassical_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(25);
     ui->f64Slider->setValue(25);
     ui->f125Slider->setValue(25);
@@ -422,6 +475,7 @@ void MainWindow::on_actionClassical_triggered()
     ui->f4kSlider->setValue(16);
     ui->f8kSlider->setValue(16);
     ui->f16kSlider->setValue(13);
+    dsp_->endUpdate();
 }
 
 /**
@@ -429,6 +483,7 @@ void MainWindow::on_actionClassical_triggered()
  */
 void MainWindow::on_actionClub_triggered()
 {
+    dsp_->beginUpdate();
 
     ui->f32Slider->setValue(25);
     ui->f64Slider->setValue(25);
@@ -440,7 +495,7 @@ void MainWindow::on_actionClub_triggered()
     ui->f4kSlider->setValue(25);
     ui->f8kSlider->setValue(25);
     ui->f16kSlider->setValue(25);
-
+    dsp_->endUpdate();
 }
 
 /**
@@ -448,6 +503,7 @@ void MainWindow::on_actionClub_triggered()
  */
 void MainWindow::on_actionDance_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(37);
     ui->f64Slider->setValue(34);
     ui->f125Slider->setValue(28);
@@ -458,7 +514,7 @@ void MainWindow::on_actionDance_triggered()
     ui->f4kSlider->setValue(16);
     ui->f8kSlider->setValue(25);
     ui->f16kSlider->setValue(25);
-
+    dsp_->endUpdate();
 }
 
 /**
@@ -466,6 +522,7 @@ void MainWindow::on_actionDance_triggered()
  */
 void MainWindow::on_actionFull_Bass_Treble_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(34);
     ui->f64Slider->setValue(32);
     ui->f125Slider->setValue(25);
@@ -476,6 +533,7 @@ void MainWindow::on_actionFull_Bass_Treble_triggered()
     ui->f4kSlider->setValue(39);
     ui->f8kSlider->setValue(40);
     ui->f16kSlider->setValue(40);
+    dsp_->endUpdate();
 }
 
 /**
@@ -483,6 +541,7 @@ void MainWindow::on_actionFull_Bass_Treble_triggered()
  */
 void MainWindow::on_actionFull_Treble_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(13);
     ui->f64Slider->setValue(13);
     ui->f125Slider->setValue(13);
@@ -493,6 +552,7 @@ void MainWindow::on_actionFull_Treble_triggered()
     ui->f4kSlider->setValue(43);
     ui->f8kSlider->setValue(43);
     ui->f16kSlider->setValue(45);
+    dsp_->endUpdate();
 }
 
 /**
@@ -500,6 +560,7 @@ void MainWindow::on_actionFull_Treble_triggered()
  */
 void MainWindow::on_actionPop_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(27);
     ui->f64Slider->setValue(31);
     ui->f125Slider->setValue(34);
@@ -510,6 +571,7 @@ void MainWindow::on_actionPop_triggered()
     ui->f4kSlider->setValue(22);
     ui->f8kSlider->setValue(27);
     ui->f16kSlider->setValue(27);
+    dsp_->endUpdate();
 }
 
 /**
@@ -517,6 +579,7 @@ void MainWindow::on_actionPop_triggered()
  */
 void MainWindow::on_actionReggae_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(25);
     ui->f64Slider->setValue(25);
     ui->f125Slider->setValue(25);
@@ -527,6 +590,7 @@ void MainWindow::on_actionReggae_triggered()
     ui->f4kSlider->setValue(25);
     ui->f8kSlider->setValue(25);
     ui->f16kSlider->setValue(25);
+    dsp_->endUpdate();
 }
 
 /**
@@ -534,6 +598,7 @@ void MainWindow::on_actionReggae_triggered()
  */
 void MainWindow::on_actionRock_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(35);
     ui->f64Slider->setValue(31);
     ui->f125Slider->setValue(18);
@@ -544,6 +609,7 @@ void MainWindow::on_actionRock_triggered()
     ui->f4kSlider->setValue(39);
     ui->f8kSlider->setValue(39);
     ui->f16kSlider->setValue(39);
+    dsp_->endUpdate();
 }
 
 /**
@@ -551,6 +617,7 @@ void MainWindow::on_actionRock_triggered()
  */
 void MainWindow::on_actionTechno_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(35);
     ui->f64Slider->setValue(32);
     ui->f125Slider->setValue(25);
@@ -561,7 +628,7 @@ void MainWindow::on_actionTechno_triggered()
     ui->f4kSlider->setValue(37);
     ui->f8kSlider->setValue(37);
     ui->f16kSlider->setValue(36);
-
+    dsp_->endUpdate();
 }
 
 /**
@@ -569,6 +636,7 @@ void MainWindow::on_actionTechno_triggered()
  */
 void MainWindow::on_actionFlat_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(25);
     ui->f64Slider->setValue(25);
     ui->f125Slider->setValue(25);
@@ -579,7 +647,7 @@ void MainWindow::on_actionFlat_triggered()
     ui->f4kSlider->setValue(25);
     ui->f8kSlider->setValue(25);
     ui->f16kSlider->setValue(25);
-
+    dsp_->endUpdate();
 }
 
 /**
@@ -587,6 +655,7 @@ void MainWindow::on_actionFlat_triggered()
  */
 void MainWindow::on_actionZero_triggered()
 {
+    dsp_->beginUpdate();
     ui->f32Slider->setValue(0);
     ui->f64Slider->setValue(0);
     ui->f125Slider->setValue(0);
@@ -597,7 +666,7 @@ void MainWindow::on_actionZero_triggered()
     ui->f4kSlider->setValue(0);
     ui->f8kSlider->setValue(0);
     ui->f16kSlider->setValue(0);
-
+    dsp_->endUpdate();
 }
 
 /**
@@ -35,6 +35,7 @@
 #include <QtCore>
 
 #include "dspsystem.h"
+#include "reblockadapter.h"
 
 namespace Ui {
 class MainWindow;
@@ -84,6 +85,11 @@ private:
       */
      dspSystem* dsp_;
 
+     /**
+      * Re-blocking adapter around dsp_, used only with --block=<n>.
+      */
+     reblockAdapter* reblock_;
+
      /**
       *DSP change
       */
@@ -0,0 +1,349 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   multichannelhost.cpp
+ *         Many-channel host: one equalizer and reverb state per channel,
+ *         shared filter tables and channel jobs spread over a work-stealing
+ *         worker pool each period.
+ *
+ * $Id: multichannelhost.cpp $
+ */
+
+#include "multichannelhost.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <time.h>
+
+namespace {
+
+  /*
+   * Tiempo de CPU del hilo que llama, en nanosegundos.
+   */
+  inline unsigned long long tiempoHilo() {
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID,&t);
+    return static_cast<unsigned long long>(t.tv_sec)*1000000000ULL + t.tv_nsec;
+  }
+}
+
+/*
+ * Constructor
+ */
+multiChannelHost::multiChannelHost(int channels,const filterBank& banco)
+  : fuente_(new controlVolume(banco)),
+    cantidad_(std::min(std::max(1,channels),int(MaxChannels))),
+    sampleRate_(0),bufferSize_(0),iniciado_(false),periodos_(0) {
+
+  const Parametros inicial = defaultParameters();
+  for (int c=0;c<MaxChannels;++c) {
+    canales_[c]=0;
+  }
+  for (int c=0;c<cantidad_;++c) {
+    canales_[c] = new Canal;
+    canales_[c]->cv = new controlVolume(fuente_);
+    canales_[c]->parametros.escribir() = inicial;
+    canales_[c]->parametros.publicar();
+    memset(&canales_[c]->spectral,0,sizeof(Spectral));
+    canales_[c]->reiniciosVistos = inicial.reinicios;
+    canales_[c]->tiempo.store(0);
+  }
+}
+
+/*
+ * Destructor
+ */
+multiChannelHost::~multiChannelHost() {
+  grupo_.detener();
+
+  // Los canales usan las tablas de la fuente, que se destruye al final.
+  for (int c=0;c<cantidad_;++c) {
+    delete canales_[c]->cv;
+    delete canales_[c];
+  }
+  delete fuente_;
+}
+
+int multiChannelHost::channels() const {
+  return cantidad_;
+}
+
+bool multiChannelHost::setWorkers(const int workers,const int priority) {
+  if (iniciado_) {
+    return false;
+  }
+  return grupo_.iniciar(workers,priority);
+}
+
+int multiChannelHost::workers() const {
+  return grupo_.hilos();
+}
+
+Parametros multiChannelHost::defaultParameters() {
+  Parametros p;
+  p.volumeGain = 25;
+  for (int b=0;b<filterBank::MaxBandas;++b) {
+    p.ganancias[b] = 25;
+  }
+  p.aReverb = 70;
+  p.dReverb = 1024;
+  p.reverbEnabled = true;
+  p.typeReverb = 0;
+  p.engine = controlVolume::MotorCompuesto;
+  p.metering = false;
+  p.reinicios = 0;
+  return p;
+}
+
+void multiChannelHost::setParameters(const int channel,const Parametros& p) {
+  if ((channel < 0) || (channel >= cantidad_)) {
+    return;
+  }
+  canales_[channel]->parametros.escribir() = p;
+  canales_[channel]->parametros.publicar();
+}
+
+const Spectral& multiChannelHost::spectral(const int channel) const {
+  return canales_[std::min(std::max(0,channel),cantidad_-1)]->spectral;
+}
+
+unsigned long long multiChannelHost::channelTime(const int channel) const {
+  if ((channel < 0) || (channel >= cantidad_)) {
+    return 0;
+  }
+  return canales_[channel]->tiempo.load(std::memory_order_relaxed);
+}
+
+unsigned long long multiChannelHost::periods() const {
+  return periodos_.load(std::memory_order_relaxed);
+}
+
+double multiChannelHost::channelLoad(const int channel) const {
+  const unsigned long long n = periods();
+  if ((n == 0) || (sampleRate_ <= 0)) {
+    return 0.0;
+  }
+  const double disponible = double(n)*bufferSize_*1e9/sampleRate_;
+  return double(channelTime(channel))/disponible;
+}
+
+void multiChannelHost::resetAccounting() {
+  for (int c=0;c<cantidad_;++c) {
+    canales_[c]->tiempo.store(0,std::memory_order_relaxed);
+  }
+  periodos_.store(0,std::memory_order_relaxed);
+}
+
+/**
+ * Initialization function for the current filter plan
+ *
+ * The first channel builds the tables in the source processor; the others
+ * only reserve their own state.
+ */
+bool multiChannelHost::init(const int frameRate,const int bufferSize) {
+  sampleRate_ = frameRate;
+  bufferSize_ = bufferSize;
+  for (int c=0;c<cantidad_;++c) {
+    canales_[c]->cv->prepararPlanes(sampleRate_,bufferSize_);
+  }
+  resetAccounting();
+  iniciado_ = true;
+  return true;
+}
+
+/**
+ * Processing function
+ *
+ * Channel c of the block is processed by channel c of the host; channels
+ * beyond channels() are silenced.  controlVolume reads the whole input
+ * block before writing its output, so in-place blocks are supported.
+ */
+bool multiChannelHost::process(float* const* in,
+                               float* const* out,
+                               const int channels,
+                               const int nframes,
+                               const bool /*inPlace*/,
+                               const processContext& /*context*/) {
+
+  const int usados = std::min(channels,cantidad_);
+
+  Periodo periodo;
+  periodo.host = this;
+  periodo.in = in;
+  periodo.out = out;
+  periodo.nframes = nframes;
+  grupo_.ejecutarRepartido(tareaCanal,&periodo,usados);
+
+  for (int c=usados;c<channels;++c) {
+    memset(out[c],0,sizeof(float)*nframes);
+  }
+
+  periodos_.fetch_add(1,std::memory_order_relaxed);
+  return true;
+}
+
+/*
+ * Tarea de un canal
+ */
+void multiChannelHost::tareaCanal(void* contexto,const int tarea,int /*hilo*/) {
+
+  const Periodo& p = *static_cast<const Periodo*>(contexto);
+  Canal& canal = *p.host->canales_[tarea];
+  const unsigned long long inicio = tiempoHilo();
+
+  // Entre dos periodos el fork-join de rtPool ordena los accesos al estado del
+  // canal, aunque lo procesen hilos distintos.
+  const Parametros& par = canal.parametros.tomar();
+  if (par.reinicios != canal.reiniciosVistos) {
+    canal.cv->inicio = true;
+    canal.reiniciosVistos = par.reinicios;
+  }
+  canal.cv->motor = par.engine;
+  canal.cv->medirBandas = par.metering;
+  canal.cv->filter(p.nframes,par.volumeGain,par.ganancias,p.in[tarea],p.out[tarea],
+                   par.aReverb,par.dReverb,par.reverbEnabled,par.typeReverb,&canal.spectral);
+
+  canal.tiempo.fetch_add(tiempoHilo() - inicio,std::memory_order_relaxed);
+}
+
+/**
+ * Shutdown the processor
+ */
+bool multiChannelHost::shutdown() {
+  return true;
+}
+
+/**
+ * Set buffer size (call-back)
+ *
+ * Each channel asks its design thread for the new state, which borrows the
+ * tables of the source; this call never blocks.
+ */
+int multiChannelHost::setBufferSize(const int bufferSize) {
+  if (iniciado_) {
+    for (int c=0;c<cantidad_;++c) {
+      canales_[c]->cv->solicitarPlanes(sampleRate_,bufferSize);
+    }
+  }
+  bufferSize_ = bufferSize;
+  return 1;
+}
+
+/**
+ * Set sample rate (call-back)
+ */
+int multiChannelHost::setSampleRate(const int sampleRate) {
+  if (iniciado_ && (bufferSize_ > 0)) {
+    for (int c=0;c<cantidad_;++c) {
+      canales_[c]->cv->solicitarPlanes(sampleRate,bufferSize_);
+    }
+  }
+  sampleRate_ = sampleRate;
+  return 1;
+}
+
+/**
+ * Largest algorithmic latency among the channels
+ */
+int multiChannelHost::latency() const {
+  int retardo = 0;
+  for (int c=0;c<cantidad_;++c) {
+    retardo = std::max(retardo,canales_[c]->cv->latencia());
+  }
+  return retardo;
+}
+
+/*
+ * Rendimiento con 1 a maxCores nucleos
+ */
+void multiChannelHost::benchmark(std::ostream& os,int channels,const int maxCores,
+                                 const int sampleRate,const int bufferSize,
+                                 const int periods,const int engine) {
+
+  channels = std::min(std::max(1,channels),int(MaxChannels));
+
+  // Ruido uniforme en [-0.5,0.5) por canal, el mismo en cada periodo.
+  std::vector<float> entrada(channels*bufferSize);
+  std::vector<float> salida(channels*bufferSize);
+  unsigned int semilla = 1;
+  for (size_t i=0;i<entrada.size();++i) {
+    semilla = semilla*1103515245u + 12345u;
+    entrada[i] = ((semilla >> 8) & 0xffff)/65536.0f - 0.5f;
+  }
+  float* in[MaxChannels];
+  float* out[MaxChannels];
+  for (int c=0;c<channels;++c) {
+    in[c] = &entrada[c*bufferSize];
+    out[c] = &salida[c*bufferSize];
+  }
+
+  Parametros p = defaultParameters();
+  p.engine = engine;
+
+  os << "multiChannelHost: " << channels << " canales, " << bufferSize << " muestras a "
+     << sampleRate << " Hz, motor " << engine << std::endl;
+
+  const double periodo = double(bufferSize)/sampleRate;
+  double base = 0.0;
+  for (int nucleos=1;nucleos<=maxCores;++nucleos) {
+    multiChannelHost host(channels);
+    host.setWorkers(nucleos-1,0);
+    if (host.workers() != nucleos-1) {
+      os << "  " << nucleos << " nucleos: solo hay " << host.workers()+1
+         << " disponibles" << std::endl;
+      break;
+    }
+    for (int c=0;c<channels;++c) {
+      host.setParameters(c,p);
+    }
+    host.init(sampleRate,bufferSize);
+
+    processContext contexto;
+    contexto.xrun = false;
+    for (int k=0;k<16;++k) {
+      contexto.frameTime = k*bufferSize;
+      host.process(in,out,channels,bufferSize,false,contexto);
+    }
+    host.resetAccounting();
+
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int k=0;k<periods;++k) {
+      contexto.frameTime = (16+k)*bufferSize;
+      host.process(in,out,channels,bufferSize,false,contexto);
+    }
+    const double segundos =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    const double rendimiento = double(channels)*periods/segundos;
+    if (nucleos == 1) {
+      base = rendimiento;
+    }
+    double carga = 0.0;
+    for (int c=0;c<channels;++c) {
+      carga += host.channelLoad(c);
+    }
+    os << "  " << nucleos << " nucleos: " << rendimiento << " canales-periodo/s, aceleracion "
+       << rendimiento/base << ", " << periods*periodo/segundos << "x tiempo real, carga media "
+       << 100.0*carga/channels << " % por canal" << std::endl;
+  }
+}
@@ -0,0 +1,224 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   multichannelhost.h
+ *         Many-channel host: one equalizer and reverb state per channel,
+ *         shared filter tables and channel jobs spread over a work-stealing
+ *         worker pool each period.
+ *
+ * $Id: multichannelhost.h $
+ */
+
+#ifndef MULTICHANNELHOST_H
+#define MULTICHANNELHOST_H
+
+#include <atomic>
+#include <iosfwd>
+
+#include "processorv2.h"
+#include "controlvolume.h"
+#include "filterbank.h"
+#include "parametros.h"
+#include "rtpool.h"
+#include "spectralvalues.h"
+#include "triplebuffer.h"
+
+/**
+ * Anfitrion de muchos canales independientes (modo servidor).
+ *
+ * Cada canal es un controlVolume mono con su propio estado: historias,
+ * espectro compuesto, FDL, secciones de segundo orden, banco multitasa y
+ * reverberador, y sus propios parametros y medidores. Las respuestas al
+ * impulso, las tablas H(k) y los planes, que solo se leen, se construyen una
+ * vez en un controlVolume fuente y todos los canales los comparten (ver
+ * controlVolume(controlVolume*)), de modo que la memoria que se lee en cada
+ * periodo no crece con la cantidad de canales.
+ *
+ * En cada periodo cada canal es una tarea de un rtPool: el hilo de jack y
+ * los trabajadores empiezan cada uno con un tramo contiguo de canales y
+ * roban del final de los tramos de los demas cuando terminan el suyo, sin
+ * candados. Un canal siempre lo procesa un solo hilo a la vez.
+ *
+ * El tiempo de CPU de cada canal (CLOCK_THREAD_CPUTIME_ID alrededor de su
+ * tarea) se acumula en un contador atomico; channelTime() y channelLoad() lo
+ * leen desde cualquier hilo. benchmark() mide el rendimiento con 1 a N
+ * nucleos sin jack.
+ *
+ * En process() no se reserva memoria ni se toman candados.
+ */
+class multiChannelHost : public processorV2 {
+public:
+
+  /**
+   * Constantes del anfitrion.
+   */
+  enum {
+    MaxChannels=128 /**< Canales que puede tener el anfitrion. */
+  };
+
+  /**
+   * Constructor
+   * @param channels cantidad de canales (1 a MaxChannels).
+   * @param banco bandas del ecualizador de todos los canales.
+   */
+  explicit multiChannelHost(int channels,const filterBank& banco = filterBank());
+
+  /**
+   * Destructor
+   */
+  virtual ~multiChannelHost();
+
+  /**
+   * Cantidad de canales.
+   */
+  int channels() const;
+
+  /**
+   * @brief setWorkers Elige los trabajadores que se reparten los canales. Debe llamarse antes de init().
+   * @param workers cantidad de trabajadores (a lo sumo rtPool::MaxHilos); 0 procesa todo en el hilo de jack.
+   * @param priority prioridad SCHED_FIFO de los trabajadores; 0 usa la politica normal.
+   * @return false si ya se llamo init() o algun trabajador no se pudo crear o configurar.
+   */
+  bool setWorkers(int workers,int priority);
+
+  /**
+   * Trabajadores que existen, sin contar al hilo de jack.
+   */
+  int workers() const;
+
+  /**
+   * @brief setParameters Publica los parametros de un canal; el hilo de tiempo real los
+   * toma al inicio del siguiente periodo. Solo un hilo debe publicar los de cada canal.
+   * @param channel canal, de 0 a channels()-1.
+   * @param p parametros completos del canal.
+   */
+  void setParameters(int channel,const Parametros& p);
+
+  /**
+   * @brief defaultParameters Parametros por omision con los que inicia cada canal.
+   */
+  static Parametros defaultParameters();
+
+  /**
+   * Medidores del espectro de un canal (los escribe el hilo que procesa el canal).
+   */
+  const Spectral& spectral(int channel) const;
+
+  /**
+   * Tiempo de CPU acumulado de un canal, en nanosegundos.
+   */
+  unsigned long long channelTime(int channel) const;
+
+  /**
+   * Periodos procesados desde init() o resetAccounting().
+   */
+  unsigned long long periods() const;
+
+  /**
+   * Fraccion del tiempo real de los periodos procesados que uso un canal:
+   * channelTime() entre periods() veces la duracion de un periodo.
+   */
+  double channelLoad(int channel) const;
+
+  /**
+   * @brief resetAccounting Pone en cero los tiempos de los canales y la cuenta de periodos.
+   */
+  void resetAccounting();
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+  virtual int latency() const;
+
+  /**
+   * @brief benchmark Mide sin jack cuantos canales-periodo por segundo se procesan con
+   * 1 a maxCores nucleos (el hilo que llama mas maxCores-1 trabajadores) y escribe una
+   * linea por cantidad de nucleos con el rendimiento, la aceleracion respecto a un
+   * nucleo y la carga media por canal.
+   * @param os flujo de salida.
+   * @param channels cantidad de canales.
+   * @param maxCores mayor cantidad de nucleos a probar.
+   * @param sampleRate frecuencia de muestreo en Hz.
+   * @param bufferSize muestras por periodo.
+   * @param periods periodos que se miden con cada cantidad de nucleos.
+   * @param engine motor de filtrado de todos los canales.
+   */
+  static void benchmark(std::ostream& os,int channels,int maxCores,int sampleRate,
+                        int bufferSize,int periods,int engine);
+
+private:
+
+  /**
+   * Estado de un canal. Cada uno se reserva por separado para que los
+   * contadores de canales que procesan hilos distintos no compartan linea.
+   */
+  struct Canal {
+    controlVolume* cv;
+    tripleBuffer<Parametros> parametros;
+    Spectral spectral;
+    int reiniciosVistos;
+    std::atomic<unsigned long long> tiempo; /**< Nanosegundos de CPU acumulados. */
+  };
+
+  /**
+   * Periodo en curso, que leen las tareas de los canales.
+   */
+  struct Periodo {
+    multiChannelHost* host;
+    float* const* in;
+    float* const* out;
+    int nframes;
+  };
+
+  /**
+   * @brief tareaCanal Tarea de rtPool: procesa un canal y acumula su tiempo de CPU.
+   */
+  static void tareaCanal(void* contexto,int tarea,int hilo);
+
+  /**
+   * Procesador del que los canales toman los disenos y las tablas; no procesa.
+   */
+  controlVolume* fuente_;
+
+  Canal* canales_[MaxChannels];
+  int cantidad_;
+
+  /**
+   * Trabajadores entre los que se reparten los canales.
+   */
+  rtPool grupo_;
+
+  int sampleRate_;
+  int bufferSize_;
+  bool iniciado_;
+
+  std::atomic<unsigned long long> periodos_;
+
+  multiChannelHost(const multiChannelHost&);
+  multiChannelHost& operator=(const multiChannelHost&);
+};
+
+#endif // MULTICHANNELHOST_H
@@ -0,0 +1,357 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   multiratebank.cpp
+ *         Multirate processing of the low bands: polyphase decimation,
+ *         FIR filtering at the reduced rate and polyphase interpolation.
+ *
+ * $Id: multiratebank.cpp $
+ */
+
+#include "multiratebank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+  /*
+   * Rechazo del pasabajos de diezmado e interpolacion, en dB.
+   */
+  const double rechazo = 80.0;
+
+  /*
+   * Funcion de Bessel modificada de primera especie y orden cero, por su serie.
+   */
+  double bessel0(double x) {
+    double suma = 1.0;
+    double termino = 1.0;
+    for (int k=1;k<50;++k) {
+      termino *= (0.5*x/k)*(0.5*x/k);
+      suma += termino;
+      if (termino < 1e-12*suma) {
+        break;
+      }
+    }
+    return suma;
+  }
+
+  /*
+   * Pasabajos de fase lineal con corte en 1/(2D) ciclos por muestra y ventana de
+   * Kaiser, normalizado a ganancia unitaria en DC.
+   */
+  void pasabajos(int D,int largo,double* h) {
+    const double beta = 0.1102*(rechazo - 8.7);
+    const double centro = 0.5*(largo - 1);
+    const double corte = 1.0/D; // 2*fc
+    const double pi = 3.14159265358979323846;
+    double suma = 0.0;
+    for (int k=0;k<largo;++k) {
+      const double t = k - centro;
+      const double sinc = (t == 0.0) ? 1.0 : std::sin(pi*corte*t)/(pi*corte*t);
+      const double r = t/centro;
+      h[k] = corte*sinc*bessel0(beta*std::sqrt(std::max(0.0,1.0 - r*r)))/bessel0(beta);
+      suma += h[k];
+    }
+    for (int k=0;k<largo;++k) {
+      h[k] /= suma;
+    }
+  }
+
+  /*
+   * Agrega una muestra a una historia duplicada de largo muestras: la ventana
+   * de las ultimas largo muestras, de la mas antigua a la mas reciente, es
+   * siempre historia + pos.
+   */
+  inline void agregar(float* historia,int largo,int& pos,float x) {
+    historia[pos] = x;
+    historia[pos + largo] = x;
+    pos = (pos + 1 == largo) ? 0 : pos + 1;
+  }
+}
+
+/*
+ * Constructor
+ */
+multirateBank::multirateBank(int bandas)
+  : bandas_(std::min(std::max(bandas,0),int(filterBank::MaxBandas))),retardo_(0),
+    linea_(0),mascara_(0),posicion_(0),nucleos_(simdKernels::seleccionados()) {
+  for (int i=0;i<Grupos;++i) {
+    memset(&grupos_[i],0,sizeof(Grupo));
+  }
+  for (int b=0;b<filterBank::MaxBandas;++b) {
+    factores_[b]=0;
+  }
+}
+
+/*
+ * Destructor
+ */
+multirateBank::~multirateBank() {
+  liberar();
+}
+
+void multirateBank::liberar() {
+  for (int i=0;i<Grupos;++i) {
+    Grupo& g = grupos_[i];
+    delete[] g.bandas;
+    delete[] g.filtro;
+    delete[] g.fases;
+    delete[] g.respuestas;
+    delete[] g.compuesta;
+    delete[] g.pesos;
+    delete[] g.entrada;
+    delete[] g.diezmada;
+    delete[] g.filtrada;
+    memset(&g,0,sizeof(Grupo));
+  }
+  delete[] linea_;
+  linea_=0;
+  mascara_=0;
+  retardo_=0;
+}
+
+void multirateBank::preparar(int sampleRate,const filterBank& banco,const sosBank& iir) {
+
+  liberar();
+
+  const double fs = sampleRate;
+
+  // Mayor factor con f2 <= fs/(4D).
+  int cantidades[Grupos] = {0};
+  for (int b=0;b<bandas_;++b) {
+    factores_[b]=0;
+    int D = FactorMaximo;
+    while ((D >= FactorMinimo) && (banco.banda(b).superior > fs/(4.0*D))) {
+      D /= 2;
+    }
+    if (D >= FactorMinimo) {
+      factores_[b]=D;
+      int i=0;
+      while ((FactorMinimo << i) != D) {
+        ++i;
+      }
+      ++cantidades[i];
+    }
+  }
+
+  // h(n) de una banda a la tasa completa y el pasabajos del mayor factor.
+  const int largoCompleta = (LargoBaja-1)*FactorMaximo + LargoFase*FactorMaximo/2 + 1;
+  double* completa = new double[largoCompleta];
+  double* h = new double[LargoFase*FactorMaximo + 1];
+
+  int factorMayor = 0;
+
+  for (int i=0;i<Grupos;++i) {
+    if (cantidades[i] == 0) {
+      continue;
+    }
+    Grupo& g = grupos_[i];
+    const int D = FactorMinimo << i;
+    const int K = LargoFase;
+    factorMayor = D;
+
+    g.factor = D;
+    g.bandas = new int[cantidades[i]];
+    for (int b=0;b<bandas_;++b) {
+      if (factores_[b] == D) {
+        g.bandas[g.cantidad++] = b;
+      }
+    }
+
+    // Pasabajos de diezmado y sus fases de interpolacion: la fase p usa los
+    // coeficientes p, p+D, p+2D, ..., invertidos para recorrer la historia de
+    // la muestra mas antigua a la mas reciente.
+    g.largoFiltro = K*D + 1;
+    pasabajos(D,g.largoFiltro,h);
+    g.filtro = new float[g.largoFiltro];
+    for (int k=0;k<g.largoFiltro;++k) {
+      g.filtro[k] = static_cast<float>(h[k]);
+    }
+    g.fases = new float[D*(K+1)];
+    for (int p=0;p<D;++p) {
+      for (int j=0;j<=K;++j) {
+        const int k = p + (K-j)*D;
+        g.fases[p*(K+1) + j] = (k < g.largoFiltro) ? static_cast<float>(D*h[k]) : 0.0f;
+      }
+    }
+
+    // Respuesta de cada banda a fs/D: h(n) de la tasa completa limitada en banda
+    // con el mismo pasabajos, adelantada su retardo de K*D/2 muestras y tomada
+    // cada D muestras (por D, para conservar la ganancia). En la banda coincide
+    // con el diseno de la tasa completa que usan los demas motores; se pierde
+    // solo el inicio del pasabajos, antes del adelanto, donde h(n) aun es casi cero.
+    const int c = K*D/2;
+    const int largo = (LargoBaja-1)*D + c + 1;
+    g.respuestas = new float[g.cantidad*LargoBaja];
+    for (int k=0;k<g.cantidad;++k) {
+      iir.respuestaImpulso(g.bandas[k],largo,completa);
+      for (int m=0;m<LargoBaja;++m) {
+        const int n = m*D + c;
+        double suma = 0.0;
+        for (int j=0;(j<g.largoFiltro) && (j<=n);++j) {
+          suma += h[j]*completa[n-j];
+        }
+        g.respuestas[k*LargoBaja + (LargoBaja-1-m)] = static_cast<float>(D*suma);
+      }
+    }
+    g.compuesta = new float[LargoBaja];
+    memset(g.compuesta,0,sizeof(float)*LargoBaja);
+    g.pesos = new double[g.cantidad];
+    for (int k=0;k<g.cantidad;++k) {
+      g.pesos[k] = 0.0;
+    }
+
+    g.entrada = new float[2*g.largoFiltro];
+    g.diezmada = new float[2*LargoBaja];
+    g.filtrada = new float[2*(K+1)];
+  }
+
+  delete[] h;
+  delete[] completa;
+
+  // Todas las salidas se alinean al retardo del grupo de mayor factor.
+  retardo_ = LargoFase*factorMayor;
+  for (int i=0;i<Grupos;++i) {
+    if (grupos_[i].factor != 0) {
+      grupos_[i].adelanto = retardo_ - LargoFase*grupos_[i].factor;
+    }
+  }
+
+  int capacidad = 1;
+  while (capacidad < retardo_ + Tramo) {
+    capacidad *= 2;
+  }
+  linea_ = new float[capacidad];
+  mascara_ = static_cast<unsigned long>(capacidad - 1);
+
+  reiniciar();
+}
+
+void multirateBank::reiniciar() {
+  for (int i=0;i<Grupos;++i) {
+    Grupo& g = grupos_[i];
+    if (g.factor == 0) {
+      continue;
+    }
+    memset(g.entrada,0,sizeof(float)*2*g.largoFiltro);
+    memset(g.diezmada,0,sizeof(float)*2*LargoBaja);
+    memset(g.filtrada,0,sizeof(float)*2*(LargoFase+1));
+    g.posEntrada=0;
+    g.posDiezmada=0;
+    g.posFiltrada=0;
+    g.contador=0;
+  }
+  if (linea_ != 0) {
+    memset(linea_,0,sizeof(float)*(mascara_ + 1));
+  }
+  posicion_=0;
+}
+
+bool multirateBank::baja(int banda) const {
+  return (banda >= 0) && (banda < bandas_) && (factores_[banda] != 0);
+}
+
+int multirateBank::factor(int banda) const {
+  return baja(banda) ? factores_[banda] : 1;
+}
+
+int multirateBank::latencia() const {
+  return retardo_;
+}
+
+/*
+ * Procesa un tramo por un grupo y acumula su salida en la linea de alineacion.
+ */
+void multirateBank::filtrarGrupo(Grupo& g,int largo,const float* in) {
+
+  const int D = g.factor;
+  const int K = LargoFase;
+
+  for (int i=0;i<largo;++i) {
+    agregar(g.entrada,g.largoFiltro,g.posEntrada,in[i]);
+
+    // Solo se calcula la salida del pasabajos que se conserva al diezmar, y
+    // con ella la de las bandas a la tasa reducida.
+    if (g.contador == 0) {
+      const float u = nucleos_.productoPunto(g.entrada + g.posEntrada,g.filtro,g.largoFiltro);
+      agregar(g.diezmada,LargoBaja,g.posDiezmada,u);
+      const float v = nucleos_.productoPunto(g.diezmada + g.posDiezmada,g.compuesta,LargoBaja);
+      agregar(g.filtrada,K+1,g.posFiltrada,v);
+    }
+
+    const float y = nucleos_.productoPunto(g.filtrada + g.posFiltrada,g.fases + g.contador*(K+1),K+1);
+    linea_[(posicion_ + i + g.adelanto) & mascara_] += y;
+
+    g.contador = (g.contador + 1 == D) ? 0 : g.contador + 1;
+  }
+}
+
+void multirateBank::filtrar(int blockSize,const float* in,const float* altas,const double* pesos,
+                            float* out,float* muestras) {
+
+  // La respuesta compuesta de cada grupo solo se reconstruye si cambio algun peso.
+  for (int i=0;i<Grupos;++i) {
+    Grupo& g = grupos_[i];
+    bool cambio = false;
+    for (int k=0;k<g.cantidad;++k) {
+      cambio = cambio || (pesos[g.bandas[k]] != g.pesos[k]);
+    }
+    if (cambio) {
+      memset(g.compuesta,0,sizeof(float)*LargoBaja);
+      for (int k=0;k<g.cantidad;++k) {
+        g.pesos[k] = pesos[g.bandas[k]];
+        nucleos_.acumularEscaladoF(g.respuestas + k*LargoBaja,static_cast<float>(g.pesos[k]),
+                                   g.compuesta,LargoBaja);
+      }
+    }
+  }
+
+  for (int inicio=0;inicio<blockSize;inicio+=Tramo) {
+    const int largo = std::min(int(Tramo),blockSize - inicio);
+
+    for (int i=0;i<Grupos;++i) {
+      if (grupos_[i].factor != 0) {
+        filtrarGrupo(grupos_[i],largo,in + inicio);
+      }
+    }
+
+    // Las demas bandas entran a la linea con el retardo completo. Se lee altas
+    // antes de escribir out, por lo que pueden ser el mismo arreglo.
+    for (int i=0;i<largo;++i) {
+      const unsigned long n = posicion_ + i;
+      linea_[(n + retardo_) & mascara_] += altas[inicio + i];
+      out[inicio + i] = linea_[n & mascara_];
+      linea_[n & mascara_] = 0.0f;
+    }
+    posicion_ += largo;
+  }
+
+  // Medidores: salida de cada banda baja en la ultima muestra diezmada.
+  if (muestras != 0) {
+    for (int i=0;i<Grupos;++i) {
+      const Grupo& g = grupos_[i];
+      for (int k=0;k<g.cantidad;++k) {
+        muestras[g.bandas[k]] = static_cast<float>(g.pesos[k]) *
+          nucleos_.productoPunto(g.diezmada + g.posDiezmada,g.respuestas + k*LargoBaja,LargoBaja);
+      }
+    }
+  }
+}
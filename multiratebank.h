@@ -0,0 +1,192 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   multiratebank.h
+ *         Multirate processing of the low bands: polyphase decimation,
+ *         FIR filtering at the reduced rate and polyphase interpolation.
+ *
+ * $Id: multiratebank.h $
+ */
+
+#ifndef MULTIRATEBANK_H
+#define MULTIRATEBANK_H
+
+#include "filterbank.h"
+#include "sosbank.h"
+#include "simdkernels.h"
+
+/**
+ * Banco multitasa de las bandas bajas.
+ *
+ * Una banda cuyo borde superior f2 cumple f2 <= fs/(4D) para un factor
+ * D = 8, 16, 32 o 64 se procesa a la tasa fs/D: se elige el mayor D posible
+ * y las bandas con el mismo factor forman un grupo. Cada grupo
+ *
+ *  - diezma la entrada con un pasabajos de fase lineal (ventana de Kaiser,
+ *    corte en fs/(2D) y LargoFase*D+1 coeficientes), del que solo se
+ *    calcula una salida de cada D (forma polifasica);
+ *  - filtra a la tasa reducida con la suma ponderada de las respuestas al
+ *    impulso de sus bandas, de LargoBaja muestras, que equivalen a
+ *    LargoBaja*D muestras a la tasa completa. Se obtienen de las mismas
+ *    secciones de segundo orden que usan los demas motores, limitadas en
+ *    banda y tomadas cada D muestras, por lo que no cambia el filtro sino
+ *    solo cuanto de su respuesta se conserva;
+ *  - interpola con el mismo pasabajos repartido en D fases de LargoFase+1
+ *    coeficientes, sin multiplicar por los ceros insertados.
+ *
+ * Con f2 <= fs/(4D) la banda de transicion del pasabajos va de fs/(4D) a
+ * 3fs/(4D), de modo que ni el solapamiento del diezmado ni las imagenes de
+ * la interpolacion caen dentro de la banda.
+ *
+ * Los dos pasabajos retrasan al grupo LargoFase*D muestras. Las salidas de
+ * los grupos y la senal de las demas bandas (calculada afuera, a la tasa
+ * completa) se alinean al retardo del grupo mas lento, que es latencia().
+ *
+ * Cada canal usa su propio banco. No se reserva memoria en filtrar().
+ */
+class multirateBank {
+public:
+
+    /**
+     * Constantes del banco.
+     */
+    enum {
+      FactorMinimo=8,  /**< Menor factor de diezmado; las bandas que no lo admiten quedan a la tasa completa. */
+      FactorMaximo=64, /**< Mayor factor de diezmado. */
+      Grupos=4,        /**< Factores posibles: 8, 16, 32 y 64. */
+      LargoFase=10,    /**< Coeficientes del pasabajos por cada fase (unos 80 dB de rechazo). */
+      LargoBaja=1024,  /**< Largo de h(n) de cada banda a la tasa reducida. */
+      Tramo=256        /**< Muestras que se procesan a la vez; los bloques se procesan por tramos. */
+    };
+
+    /**
+     * Constructor
+     * @param bandas cantidad de bandas del ecualizador.
+     */
+    multirateBank(int bandas);
+
+    /**
+     * Destructor
+     */
+    ~multirateBank();
+
+    /**
+     * @brief preparar Elige las bandas que se diezman y calcula sus filtros para una frecuencia de muestreo.
+     * Debe llamarse fuera del hilo de tiempo real.
+     * @param sampleRate frecuencia de muestreo en Hz.
+     * @param banco bordes de las bandas.
+     * @param iir bandas disenadas para sampleRate, de las que se toman las respuestas al impulso.
+     */
+    void preparar(int sampleRate,const filterBank& banco,const sosBank& iir);
+
+    /**
+     * @brief reiniciar Borra la historia de los filtros y de la linea de alineacion.
+     */
+    void reiniciar();
+
+    /**
+     * @brief baja Indica si una banda se procesa en este banco.
+     */
+    bool baja(int banda) const;
+
+    /**
+     * @brief factor Factor de diezmado de una banda, o 1 si queda a la tasa completa.
+     */
+    int factor(int banda) const;
+
+    /**
+     * @brief latencia Retardo en muestras que agrega el banco a la salida.
+     */
+    int latencia() const;
+
+    /**
+     * @brief filtrar Filtra un bloque por las bandas bajas y le suma la senal de las demas bandas.
+     * @param blockSize cantidad de muestras del bloque (cualquier tamano).
+     * @param in entrada del bloque.
+     * @param altas suma de las demas bandas para el mismo bloque, sin retardo.
+     * @param pesos ganancia de cada banda del ecualizador (solo se usan las bajas).
+     * @param out altas retrasada latencia() muestras mas la salida de las bandas bajas. Puede ser altas.
+     * @param muestras si no es nulo, recibe la salida ponderada de cada banda baja al final del bloque.
+     */
+    void filtrar(int blockSize,const float* in,const float* altas,const double* pesos,
+                 float* out,float* muestras);
+
+private:
+
+    /**
+     * Bandas que comparten un factor de diezmado.
+     */
+    struct Grupo {
+      int factor;           /**< Factor D; 0 si el grupo no tiene bandas. */
+      int cantidad;         /**< Bandas del grupo. */
+      int* bandas;          /**< Indice de cada banda del grupo en el ecualizador. */
+      int largoFiltro;      /**< Coeficientes del pasabajos, LargoFase*D+1. */
+      float* filtro;        /**< Pasabajos de diezmado (simetrico). */
+      float* fases;         /**< [fase][LargoFase+1] coeficientes de interpolacion, invertidos y escalados por D. */
+      float* respuestas;    /**< [banda][LargoBaja] h(n) de cada banda a fs/D, invertida. */
+      float* compuesta;     /**< Suma ponderada de las respuestas, invertida. */
+      double* pesos;        /**< Pesos con los que esta construida compuesta. */
+      float* entrada;       /**< Ultimas largoFiltro muestras de la entrada, duplicadas. */
+      float* diezmada;      /**< Ultimas LargoBaja muestras diezmadas, duplicadas. */
+      float* filtrada;      /**< Ultimas LargoFase+1 muestras filtradas a fs/D, duplicadas. */
+      int posEntrada;
+      int posDiezmada;
+      int posFiltrada;
+      int contador;         /**< Muestras desde la ultima muestra diezmada, de 0 a D-1. */
+      int adelanto;         /**< Posiciones de la linea de alineacion que se adelanta la salida del grupo. */
+    };
+
+    /**
+     * @brief liberar Libera los filtros y estados de todos los grupos.
+     */
+    void liberar();
+
+    /**
+     * @brief filtrarGrupo Procesa un tramo de entrada por un grupo y acumula su salida en la linea de alineacion.
+     */
+    void filtrarGrupo(Grupo& g,int largo,const float* in);
+
+    int bandas_;
+    Grupo grupos_[Grupos];
+
+    /**
+     * Factor de diezmado de cada banda (0 si queda a la tasa completa).
+     */
+    int factores_[filterBank::MaxBandas];
+
+    /**
+     * Retardo comun de todas las salidas.
+     */
+    int retardo_;
+
+    /**
+     * Linea de alineacion: anillo de potencia de dos donde cada grupo y las
+     * demas bandas acumulan su salida en la posicion en que debe salir.
+     */
+    float* linea_;
+    unsigned long mascara_;
+    unsigned long posicion_;
+
+    const simdKernels& nucleos_;
+
+    multirateBank(const multirateBank&);
+    multirateBank& operator=(const multirateBank&);
+};
+
+#endif // MULTIRATEBANK_H
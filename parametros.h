@@ -0,0 +1,50 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   parametros.h
+ *         Snapshot of the user interface parameters that the real time
+ *         thread reads once per period.
+ *
+ * $Id: parametros.h $
+ */
+
+#ifndef PARAMETROS_H
+#define PARAMETROS_H
+
+#include "filterbank.h"
+
+/**
+ * Parametros de la interfaz grafica que usa el hilo de tiempo real.
+ *
+ * dspSystem publica una copia completa por medio de un tripleBuffer y el
+ * hilo de tiempo real toma la ultima una vez por periodo.
+ */
+struct Parametros {
+   int volumeGain;      /**< Posicion del slider de volumen. */
+   int ganancias[filterBank::MaxBandas]; /**< Posicion del slider de cada banda del banco. */
+   int aReverb;         /**< Escalamiento de la reverberacion. */
+   int dReverb;         /**< Retraso de la reverberacion en muestras. */
+   bool reverbEnabled;  /**< Indica si la reverberacion esta activa. */
+   int typeReverb;      /**< Tipo de reverberacion. */
+   int engine;          /**< Motor de filtrado (controlVolume::MotorBandas ...). */
+   bool metering;       /**< Indica si se calculan las salidas por banda para los medidores. */
+   int reinicios;       /**< Se incrementa cada vez que la interfaz pide reiniciar las historias. */
+};
+
+#endif // PARAMETROS_H
@@ -0,0 +1,555 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   partconvolver.cpp
+ *         Uniformly partitioned overlap-save convolution of the equalizer
+ *         bands, using a frequency-domain delay line.
+ *
+ * $Id: partconvolver.cpp $
+ */
+
+#include "partconvolver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define REAL 0
+#define IMAG 1
+#define PI 3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067982148086513282306647093844609550582231725359408128481
+
+/*
+ * Constructor
+ */
+template<typename Precision>
+partConvolver<Precision>::partConvolver(int bandas)
+  : bandas_(bandas),particion_(0),particiones_(0),terminos_(0),
+    tablas_(0),tablasPropias_(true),particionesBanda_(0),inicios_(0),compuesto_(0),pesosCompuesto_(0),actualizaciones_(0),activas_(0),
+    compuestoCompleto_(0),completoAlDia_(false),
+    fdl_(0),cabeza_(0),fdlZ_(0),x_(0),Y_(0),y_(0),historia_(0),
+    z_(0),Z_(0),historiaDerecha_(0),
+    giro_(0),contadorMedicion_(0),intervaloMedicion_(1),
+    dft_(0),idft_(0),zdft_(0),zidft_(0),nucleos_(simdKernels::seleccionados()) {
+}
+
+/*
+ * Destructor
+ */
+template<typename Precision>
+partConvolver<Precision>::~partConvolver() {
+  liberar();
+}
+
+template<typename Precision>
+void partConvolver<Precision>::liberar() {
+  if (tablasPropias_) {
+    Precision::liberar(tablas_);
+  }
+  Precision::liberar(compuesto_);
+  Precision::liberar(fdl_);
+  Precision::liberar(compuestoCompleto_);
+  Precision::liberar(fdlZ_);
+  Precision::liberar(z_);
+  Precision::liberar(Z_);
+  Precision::liberar(x_);
+  Precision::liberar(Y_);
+  Precision::liberar(y_);
+  Precision::liberar(giro_);
+  delete[] pesosCompuesto_;
+  delete[] particionesBanda_;
+  delete[] inicios_;
+  delete[] historia_;
+  delete[] historiaDerecha_;
+
+  tablas_=0;
+  tablasPropias_=true;
+  compuesto_=0;
+  fdl_=0;
+  compuestoCompleto_=0;
+  fdlZ_=0;
+  z_=0;
+  Z_=0;
+  historiaDerecha_=0;
+  x_=0;
+  Y_=0;
+  y_=0;
+  giro_=0;
+  pesosCompuesto_=0;
+  particionesBanda_=0;
+  inicios_=0;
+  historia_=0;
+  particion_=0;
+  particiones_=0;
+  activas_=0;
+  terminos_=0;
+}
+
+template<typename Precision>
+int partConvolver<Precision>::particion() const {
+  return particion_;
+}
+
+template<typename Precision>
+int partConvolver<Precision>::particiones() const {
+  return particiones_;
+}
+
+template<typename Precision>
+int partConvolver<Precision>::particiones(int banda) const {
+  return ((particionesBanda_ != 0) && (banda >= 0) && (banda < bandas_)) ? particionesBanda_[banda] : 0;
+}
+
+/**
+ * @brief preparar Construye las tablas particionadas de todas las bandas.
+ * @param particion tamano P de cada particion (y del subbloque de proceso).
+ * @param largos largo L_i de la respuesta al impulso de cada banda; 0 excluye a la banda.
+ * @param respuestas respuesta al impulso de cada banda, de largo L_i.
+ * @param dft plan real a complejo de 2P puntos.
+ * @param idft plan complejo a real de 2P puntos.
+ * @param zdft plan complejo directo de 2P puntos.
+ * @param zidft plan complejo inverso de 2P puntos.
+ */
+template<typename Precision>
+void partConvolver<Precision>::preparar(int particion,const int* largos,const double* const* respuestas,
+                             plan dft,plan idft,plan zdft,plan zidft) {
+
+  liberar();
+
+  const int N = 2*particion;
+  particion_ = particion;
+  terminos_ = particion + 1;
+
+  // La FDL tiene las particiones de la banda mas larga (al menos una, para que
+  // sin bandas la salida sea silencio).
+  particionesBanda_ = new int[bandas_];
+  inicios_ = new int[bandas_];
+  particiones_ = 1;
+  int total = 0;
+  for (int b=0;b<bandas_;++b) {
+    particionesBanda_[b] = (largos[b] + particion - 1)/particion;
+    inicios_[b] = total;
+    total += particionesBanda_[b];
+    particiones_ = std::max(particiones_,particionesBanda_[b]);
+  }
+  dft_ = dft;
+  idft_ = idft;
+  zdft_ = zdft;
+  zidft_ = zidft;
+
+  tablas_ = (complejo*) Precision::reservar(sizeof(complejo) * std::max(1,total) * terminos_);
+  reservarEstado(true);
+
+  // H_{i,j}(k): DFT de 2P puntos de las muestras [jP,(j+1)P) de h_i(n), rellenadas con ceros.
+  for (int b=0;b<bandas_;++b) {
+    for (int j=0;j<particionesBanda_[b];++j) {
+      for (int n=0;n<particion_;++n) {
+        const int idx = j*particion_ + n;
+        x_[n] = (idx < largos[b]) ? static_cast<real>(respuestas[b][idx]) : real(0);
+      }
+      for (int n=particion_;n<N;++n) {
+        x_[n] = 0;
+      }
+      Precision::directa(dft_,x_,Y_);
+      memcpy(tablas_ + (inicios_[b] + j)*terminos_,Y_,sizeof(complejo)*terminos_);
+    }
+  }
+}
+
+/**
+ * @brief compartir Usa las tablas de otro convolucionador ya preparado.
+ * @param fuente convolucionador preparado con las respuestas que se desean.
+ * @param estereo si se reservan los buffers de filtrarEstereo().
+ */
+template<typename Precision>
+void partConvolver<Precision>::compartir(const partConvolver& fuente,bool estereo) {
+
+  liberar();
+  if ((fuente.particion_ == 0) || (fuente.bandas_ != bandas_)) {
+    return;
+  }
+
+  particion_ = fuente.particion_;
+  terminos_ = fuente.terminos_;
+  particiones_ = fuente.particiones_;
+  particionesBanda_ = new int[bandas_];
+  inicios_ = new int[bandas_];
+  memcpy(particionesBanda_,fuente.particionesBanda_,sizeof(int)*bandas_);
+  memcpy(inicios_,fuente.inicios_,sizeof(int)*bandas_);
+  dft_ = fuente.dft_;
+  idft_ = fuente.idft_;
+  zdft_ = fuente.zdft_;
+  zidft_ = fuente.zidft_;
+
+  tablas_ = fuente.tablas_;
+  tablasPropias_ = false;
+  reservarEstado(estereo);
+}
+
+/**
+ * @brief reservarEstado Reserva el estado propio de un convolucionador.
+ * @param estereo si se reservan tambien los buffers de filtrarEstereo().
+ */
+template<typename Precision>
+void partConvolver<Precision>::reservarEstado(bool estereo) {
+
+  const int N = 2*particion_;
+  const int porBanda = particiones_*terminos_;
+  compuesto_ = (complejo*) Precision::reservar(sizeof(complejo) * porBanda);
+  fdl_ = (complejo*) Precision::reservar(sizeof(complejo) * porBanda);
+  x_ = (real*) Precision::reservar(sizeof(real) * N);
+  Y_ = (complejo*) Precision::reservar(sizeof(complejo) * terminos_);
+  y_ = (real*) Precision::reservar(sizeof(real) * N);
+  giro_ = (complejo*) Precision::reservar(sizeof(complejo) * terminos_);
+  pesosCompuesto_ = new double[bandas_];
+  historia_ = new float[particion_];
+  if (estereo) {
+    compuestoCompleto_ = (complejo*) Precision::reservar(sizeof(complejo) * particiones_ * N);
+    fdlZ_ = (complejo*) Precision::reservar(sizeof(complejo) * particiones_ * N);
+    z_ = (complejo*) Precision::reservar(sizeof(complejo) * N);
+    Z_ = (complejo*) Precision::reservar(sizeof(complejo) * N);
+    historiaDerecha_ = new float[particion_];
+  }
+
+  for (int b=0;b<bandas_;++b) {
+    pesosCompuesto_[b] = 0.0;
+  }
+  memset(compuesto_,0,sizeof(complejo) * porBanda);
+  actualizaciones_ = 0;
+  completoAlDia_ = false;
+
+  const int n0 = particion_ + particion_/2;
+  for (int k=0;k<terminos_;++k) {
+    const double angulo = 2.0*PI*double((static_cast<long long>(k)*n0) % N)/N;
+    giro_[k][REAL] = cos(angulo);
+    giro_[k][IMAG] = sin(angulo);
+  }
+
+  // Los medidores se evaluan aproximadamente cada 2048 muestras.
+  intervaloMedicion_ = (particion_ < 2048) ? 2048/particion_ : 1;
+  contadorMedicion_ = 0;
+
+  reiniciar();
+}
+
+template<typename Precision>
+void partConvolver<Precision>::reiniciar() {
+  if (particion_ == 0) {
+    return;
+  }
+  memset(fdl_,0,sizeof(complejo) * particiones_ * terminos_);
+  for (int n=0;n<particion_;++n) {
+    historia_[n] = 0.0f;
+  }
+  if (fdlZ_ != 0) {
+    memset(fdlZ_,0,sizeof(complejo) * particiones_ * 2*particion_);
+    for (int n=0;n<particion_;++n) {
+      historiaDerecha_[n] = 0.0f;
+    }
+  }
+  cabeza_ = 0;
+}
+
+/**
+ * @brief actualizarCompuesto Suma incrementalmente dg*H_i al espectro compuesto de las bandas cuyo peso cambio.
+ */
+template<typename Precision>
+void partConvolver<Precision>::actualizarCompuesto(const double* pesos) {
+
+  const int porBanda = particiones_*terminos_;
+
+  // Cada cierta cantidad de actualizaciones se reconstruye desde cero para que
+  // no se acumule el error de redondeo.
+  if (actualizaciones_ >= 1024) {
+    memset(compuesto_,0,sizeof(complejo) * porBanda);
+    for (int b=0;b<bandas_;++b) {
+      pesosCompuesto_[b] = 0.0;
+    }
+    actualizaciones_ = 0;
+    completoAlDia_ = false;
+  }
+
+  // Las particiones de una banda son contiguas y empiezan en la primera del compuesto.
+  for (int b=0;b<bandas_;++b) {
+    if ((pesos[b] != pesosCompuesto_[b]) && (particionesBanda_[b] > 0)) {
+      const real delta = pesos[b] - pesosCompuesto_[b];
+      const complejo* h = tablas_ + inicios_[b]*terminos_;
+      Precision::acumularEscalado(nucleos_,h[0],delta,compuesto_[0],2*particionesBanda_[b]*terminos_);
+      pesosCompuesto_[b] = pesos[b];
+      ++actualizaciones_;
+      completoAlDia_ = false;
+    }
+  }
+
+  // Solo se recorren las particiones de las bandas con peso; las demas
+  // particiones del compuesto son cero (salvo el redondeo de las restas).
+  activas_ = 0;
+  for (int b=0;b<bandas_;++b) {
+    if (pesosCompuesto_[b] != 0.0) {
+      activas_ = std::max(activas_,particionesBanda_[b]);
+    }
+  }
+}
+
+/**
+ * @brief extenderCompuesto Copia el espectro compuesto a los 2P terminos, con H(2P-k) = H*(k).
+ */
+template<typename Precision>
+void partConvolver<Precision>::extenderCompuesto() {
+
+  const int N = 2*particion_;
+
+  for (int j=0;j<activas_;++j) {
+    const complejo* h = compuesto_ + j*terminos_;
+    complejo* c = compuestoCompleto_ + j*N;
+    memcpy(c,h,sizeof(complejo)*terminos_);
+    for (int k=terminos_;k<N;++k) {
+      c[k][REAL] = h[N-k][REAL];
+      c[k][IMAG] = -h[N-k][IMAG];
+    }
+  }
+  completoAlDia_ = true;
+}
+
+/**
+ * @brief filtrar Filtra un bloque, que debe ser un multiplo del tamano de particion.
+ * @param blockSize cantidad de muestras del bloque.
+ * @param in entrada del bloque.
+ * @param pesos ganancia de cada banda.
+ * @param out suma de las salidas ponderadas de todas las bandas.
+ * @param muestras si no es nulo, recibe periodicamente la salida ponderada de cada banda.
+ */
+template<typename Precision>
+void partConvolver<Precision>::filtrar(int blockSize,const float* in,const double* pesos,
+                            float* out,float* muestras) {
+
+  if ((particion_ == 0) || (blockSize % particion_ != 0)) {
+    for (int n=0;n<blockSize;++n) {
+      out[n] = 0.0f;
+    }
+    return;
+  }
+
+  actualizarCompuesto(pesos);
+
+  const int P = particion_;
+  const int N = 2*P;
+  const double Div = static_cast<double>(N);
+
+  for (int inicio=0;inicio<blockSize;inicio+=P) {
+    const float* sub = in + inicio;
+
+    // x(n) = [subbloque anterior, subbloque actual]
+    for (int n=0;n<P;++n) {
+      x_[n] = historia_[n];
+      x_[P+n] = sub[n];
+      historia_[n] = sub[n];
+    }
+
+    // La DFT del subbloque entra en la posicion mas reciente de la FDL.
+    cabeza_ = (cabeza_ + 1) % particiones_;
+    Precision::directa(dft_,x_,Y_);
+    memcpy(fdl_ + cabeza_*terminos_,Y_,sizeof(complejo)*terminos_);
+
+    // Y(k) = sum_j X_{t-j}(k) Hc_j(k). La FDL es circular: X_{t-j} esta en cabeza_-j.
+    for (int k=0;k<terminos_;++k) {
+      Y_[k][REAL] = 0.0;
+      Y_[k][IMAG] = 0.0;
+    }
+    for (int j=0;j<activas_;++j) {
+      int ranura = cabeza_ - j;
+      if (ranura < 0) {
+        ranura += particiones_;
+      }
+      const complejo* X = fdl_ + ranura*terminos_;
+      Precision::multiplicarAcumular(nucleos_,X,compuesto_ + j*terminos_,Y_,terminos_);
+    }
+
+    Precision::inversa(idft_,Y_,y_);
+
+    for (int n=0;n<P;++n) {
+      out[inicio+n] = static_cast<float>(y_[P+n]/Div);
+    }
+
+    if ((muestras != 0) && (++contadorMedicion_ >= intervaloMedicion_)) {
+      contadorMedicion_ = 0;
+      medir(muestras);
+    }
+  }
+}
+
+/**
+ * @brief medir Evalua la salida de cada banda en la mitad del subbloque actual a partir de la FDL.
+ *
+ * Cuesta K*(P+1) productos complejos por banda, por eso solo se llama cada
+ * intervaloMedicion_ subbloques. Utiliza Y_ como acumulador.
+ */
+template<typename Precision>
+void partConvolver<Precision>::medir(float* muestras) {
+
+  const double Div = static_cast<double>(2*particion_);
+
+  for (int b=0;b<bandas_;++b) {
+    if (particionesBanda_[b] == 0) {
+      continue;
+    }
+    if (pesosCompuesto_[b] == 0.0) {
+      muestras[b] = 0.0f;
+      continue;
+    }
+    for (int k=0;k<terminos_;++k) {
+      Y_[k][REAL] = 0.0;
+      Y_[k][IMAG] = 0.0;
+    }
+    for (int j=0;j<particionesBanda_[b];++j) {
+      int ranura = cabeza_ - j;
+      if (ranura < 0) {
+        ranura += particiones_;
+      }
+      const complejo* X = fdl_ + ranura*terminos_;
+      Precision::multiplicarAcumular(nucleos_,X,tablas_ + (inicios_[b] + j)*terminos_,Y_,terminos_);
+    }
+
+    // y(n0) = 1/N sum_k Y(k)e^{j2*pi*k*n0/N}, usando la simetria de la DFT real.
+    double acc = 0.0;
+    for (int k=0;k<terminos_;++k) {
+      const double v = Y_[k][REAL]*giro_[k][REAL] - Y_[k][IMAG]*giro_[k][IMAG];
+      acc += ((k == 0) || (k == particion_)) ? v : 2.0*v;
+    }
+    muestras[b] = static_cast<float>(pesosCompuesto_[b]*acc/Div);
+  }
+}
+
+/**
+ * @brief filtrarEstereo Filtra un bloque de dos canales con una DFT compleja por subbloque.
+ * @param blockSize cantidad de muestras del bloque, multiplo del tamano de particion.
+ * @param inL entrada del canal izquierdo.
+ * @param inR entrada del canal derecho.
+ * @param pesos ganancia de cada banda.
+ * @param outL salida del canal izquierdo.
+ * @param outR salida del canal derecho.
+ * @param muestras si no es nulo, recibe periodicamente la salida ponderada de cada banda del canal izquierdo.
+ */
+template<typename Precision>
+void partConvolver<Precision>::filtrarEstereo(int blockSize,const float* inL,const float* inR,const double* pesos,
+                                   float* outL,float* outR,float* muestras) {
+
+  if ((particion_ == 0) || (fdlZ_ == 0) || (blockSize % particion_ != 0)) {
+    for (int n=0;n<blockSize;++n) {
+      outL[n] = 0.0f;
+      outR[n] = 0.0f;
+    }
+    return;
+  }
+
+  actualizarCompuesto(pesos);
+  if (!completoAlDia_) {
+    extenderCompuesto();
+  }
+
+  const int P = particion_;
+  const int N = 2*P;
+  const double Div = static_cast<double>(N);
+
+  for (int inicio=0;inicio<blockSize;inicio+=P) {
+    const float* subL = inL + inicio;
+    const float* subR = inR + inicio;
+
+    // z(n) = xL(n) + j xR(n), con x = [subbloque anterior, subbloque actual]
+    for (int n=0;n<P;++n) {
+      z_[n][REAL] = historia_[n];
+      z_[n][IMAG] = historiaDerecha_[n];
+      z_[P+n][REAL] = subL[n];
+      z_[P+n][IMAG] = subR[n];
+      historia_[n] = subL[n];
+      historiaDerecha_[n] = subR[n];
+    }
+
+    cabeza_ = (cabeza_ + 1) % particiones_;
+    Precision::compleja(zdft_,z_,Z_);
+    memcpy(fdlZ_ + cabeza_*N,Z_,sizeof(complejo)*N);
+
+    // Y(k) = sum_j Z_{t-j}(k) Hc_j(k) sobre los 2P terminos.
+    memset(Z_,0,sizeof(complejo)*N);
+    for (int j=0;j<activas_;++j) {
+      int ranura = cabeza_ - j;
+      if (ranura < 0) {
+        ranura += particiones_;
+      }
+      Precision::multiplicarAcumular(nucleos_,fdlZ_ + ranura*N,compuestoCompleto_ + j*N,Z_,N);
+    }
+
+    Precision::compleja(zidft_,Z_,z_);
+
+    // La parte real es el canal izquierdo y la imaginaria el derecho.
+    for (int n=0;n<P;++n) {
+      outL[inicio+n] = static_cast<float>(z_[P+n][REAL]/Div);
+      outR[inicio+n] = static_cast<float>(z_[P+n][IMAG]/Div);
+    }
+
+    if ((muestras != 0) && (++contadorMedicion_ >= intervaloMedicion_)) {
+      contadorMedicion_ = 0;
+      medirEstereo(muestras);
+    }
+  }
+}
+
+/**
+ * @brief medirEstereo Igual que medir() para el canal izquierdo, separandolo de la FDL compleja.
+ *
+ * El espectro del canal izquierdo es XL(k) = (Z(k) + Z*(2P-k))/2. Se evalua
+ * termino a termino sin buffers adicionales; solo se llama cada
+ * intervaloMedicion_ subbloques.
+ */
+template<typename Precision>
+void partConvolver<Precision>::medirEstereo(float* muestras) {
+
+  const int N = 2*particion_;
+  const double Div = static_cast<double>(N);
+
+  for (int b=0;b<bandas_;++b) {
+    if (particionesBanda_[b] == 0) {
+      continue;
+    }
+    if (pesosCompuesto_[b] == 0.0) {
+      muestras[b] = 0.0f;
+      continue;
+    }
+    double acc = 0.0;
+    for (int j=0;j<particionesBanda_[b];++j) {
+      int ranura = cabeza_ - j;
+      if (ranura < 0) {
+        ranura += particiones_;
+      }
+      const complejo* Z = fdlZ_ + ranura*N;
+      const complejo* h = tablas_ + (inicios_[b] + j)*terminos_;
+      for (int k=0;k<terminos_;++k) {
+        const int espejo = (k == 0) ? 0 : N-k;
+        const double xr = 0.5*(Z[k][REAL] + Z[espejo][REAL]);
+        const double xi = 0.5*(Z[k][IMAG] - Z[espejo][IMAG]);
+        const double yr = xr*h[k][REAL] - xi*h[k][IMAG];
+        const double yi = xr*h[k][IMAG] + xi*h[k][REAL];
+        const double v = yr*giro_[k][REAL] - yi*giro_[k][IMAG];
+        acc += ((k == 0) || (k == particion_)) ? v : 2.0*v;
+      }
+    }
+    muestras[b] = static_cast<float>(pesosCompuesto_[b]*acc/Div);
+  }
+}
+
+template class partConvolver<precision<float> >;
+template class partConvolver<precision<double> >;
@@ -0,0 +1,278 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   partconvolver.h
+ *         Uniformly partitioned overlap-save convolution of the equalizer
+ *         bands, using a frequency-domain delay line.
+ *
+ * $Id: partconvolver.h $
+ */
+
+#ifndef PARTCONVOLVER_H
+#define PARTCONVOLVER_H
+
+#include "precision.h"
+
+/**
+ * Convolucion particionada uniforme (solapamiento y almacenamiento).
+ *
+ * La respuesta al impulso h_i(n) de largo L_i de cada banda se divide en
+ * K_i = L_i/P particiones de P muestras, y se guarda la DFT de 2P puntos de
+ * cada una, H_{i,j}(k). Por cada subbloque de P muestras de entrada se calcula
+ * una sola DFT X(k) que se inserta en una linea de retardo en frecuencia
+ * (FDL), y
+ * \f[
+ * Y(k)=\sum_{j=0}^{K-1} X_{t-j}(k)\,H_{c,j}(k)
+ * \f]
+ * con H_c = sum_i g_i H_i el espectro compuesto de todas las bandas. Con una
+ * sola IDFT se obtienen las P muestras de salida. El largo de la DFT depende
+ * solo de P y no de L, y la latencia algoritmica es cero: cada subbloque de
+ * salida corresponde al subbloque de entrada del mismo instante.
+ *
+ * Cada banda tiene su propio largo: la particion j del compuesto solo suma
+ * las bandas con K_i > j, y solo se recorren las particiones de la banda mas
+ * larga que tenga peso distinto de cero. Una banda corta no ocupa memoria ni
+ * tiempo en las particiones lejanas.
+ *
+ * En estereo los dos canales se empacan en una sola senal compleja
+ * z(n) = xL(n) + j xR(n). Como H_c es la DFT de una respuesta real,
+ * IDFT{Z(k)H_c(k)} = yL(n) + j yR(n): una DFT compleja de 2P puntos por
+ * subbloque filtra ambos canales. La FDL guarda entonces los 2P terminos de
+ * Z(k) y el espectro compuesto se extiende con H(2P-k) = H*(k).
+ *
+ * Las tablas H_{i,j}(k) solo se leen despues de preparar(), de modo que
+ * varios convolucionadores con las mismas respuestas (uno por canal) pueden
+ * usar las tablas de uno de ellos con compartir() y tener solo su propio
+ * estado: el compuesto, la FDL y la historia.
+ */
+template<typename Precision>
+class partConvolver {
+public:
+
+    /**
+     * Precision interna de las transformadas: Precision es precision<float>
+     * o precision<double> (ver precision.h).
+     */
+    typedef typename Precision::real real;
+    typedef typename Precision::complejo complejo;
+    typedef typename Precision::plan plan;
+
+    /**
+     * Constructor
+     * @param bandas cantidad de bandas.
+     */
+    partConvolver(int bandas);
+
+    /**
+     * Destructor
+     */
+    ~partConvolver();
+
+    /**
+     * @brief preparar Construye las tablas particionadas de todas las bandas.
+     * Debe llamarse fuera del hilo de tiempo real.
+     * @param particion tamano P de cada particion (y del subbloque de proceso).
+     * @param largos largo L_i de la respuesta al impulso de cada banda; 0 excluye a la banda.
+     * @param respuestas respuesta al impulso de cada banda, de largo L_i.
+     * @param dft plan real a complejo de 2P puntos.
+     * @param idft plan complejo a real de 2P puntos.
+     * @param zdft plan complejo directo de 2P puntos, para filtrarEstereo().
+     * @param zidft plan complejo inverso de 2P puntos, para filtrarEstereo().
+     */
+    void preparar(int particion,const int* largos,const double* const* respuestas,
+                  plan dft,plan idft,plan zdft,plan zidft);
+
+    /**
+     * @brief compartir Usa las tablas de otro convolucionador ya preparado, con su misma
+     * particion y sus mismos planes, y reserva solo el estado propio.
+     * Debe llamarse fuera del hilo de tiempo real; fuente debe existir y no volver a
+     * prepararse mientras este convolucionador use sus tablas.
+     * @param fuente convolucionador preparado con las respuestas que se desean.
+     * @param estereo si es falso no se reservan los buffers de filtrarEstereo(), que
+     *        entonces entrega silencio.
+     */
+    void compartir(const partConvolver& fuente,bool estereo);
+
+    /**
+     * @brief reiniciar Borra la historia de la entrada y la linea de retardo.
+     */
+    void reiniciar();
+
+    /**
+     * @brief filtrar Filtra un bloque, que debe ser un multiplo del tamano de particion.
+     * @param blockSize cantidad de muestras del bloque.
+     * @param in entrada del bloque.
+     * @param pesos ganancia de cada banda.
+     * @param out suma de las salidas ponderadas de todas las bandas.
+     * @param muestras si no es nulo, recibe periodicamente la salida ponderada de cada banda
+     *        a la mitad de un subbloque (para los medidores). Las bandas excluidas no se escriben.
+     */
+    void filtrar(int blockSize,const float* in,const double* pesos,
+                 float* out,float* muestras);
+
+    /**
+     * @brief filtrarEstereo Filtra un bloque de dos canales con una DFT compleja por subbloque.
+     * No se debe alternar con filtrar() sin reiniciar(): ambos comparten la posicion de la FDL.
+     * @param blockSize cantidad de muestras del bloque, multiplo del tamano de particion.
+     * @param inL entrada del canal izquierdo.
+     * @param inR entrada del canal derecho.
+     * @param pesos ganancia de cada banda.
+     * @param outL salida del canal izquierdo.
+     * @param outR salida del canal derecho.
+     * @param muestras si no es nulo, recibe periodicamente la salida ponderada de cada banda
+     *        del canal izquierdo (para los medidores).
+     */
+    void filtrarEstereo(int blockSize,const float* inL,const float* inR,const double* pesos,
+                        float* outL,float* outR,float* muestras);
+
+    /**
+     * Tamano de particion actual (0 si no se ha preparado).
+     */
+    int particion() const;
+
+    /**
+     * Cantidad de particiones de la banda mas larga.
+     */
+    int particiones() const;
+
+    /**
+     * Cantidad de particiones de una banda.
+     */
+    int particiones(int banda) const;
+
+private:
+
+    /**
+     * @brief actualizarCompuesto Suma incrementalmente dg*H_i al espectro compuesto de las bandas cuyo peso cambio.
+     */
+    void actualizarCompuesto(const double* pesos);
+
+    /**
+     * @brief medir Evalua la salida de cada banda en la mitad del subbloque actual a partir de la FDL.
+     */
+    void medir(float* muestras);
+
+    /**
+     * @brief medirEstereo Igual que medir() para el canal izquierdo, separandolo de la FDL compleja.
+     */
+    void medirEstereo(float* muestras);
+
+    /**
+     * @brief extenderCompuesto Copia el espectro compuesto a los 2P terminos, con H(2P-k) = H*(k).
+     */
+    void extenderCompuesto();
+
+    /**
+     * @brief reservarEstado Reserva el compuesto, la FDL, la historia y los buffers de trabajo
+     * para particion_ y particiones_, y calcula los factores de los medidores.
+     * @param estereo si se reservan tambien los buffers de filtrarEstereo().
+     */
+    void reservarEstado(bool estereo);
+
+    /**
+     * @brief liberar Libera las tablas (si son propias) y los buffers.
+     */
+    void liberar();
+
+    int bandas_;
+    int particion_;
+    int particiones_;
+    int terminos_;
+
+    /**
+     * Tablas H_{i,j}(k): [banda][particion][termino], con particionesBanda_[i]
+     * particiones para la banda i a partir de la particion inicios_[i].
+     */
+    complejo* tablas_;
+    bool tablasPropias_;
+    int* particionesBanda_;
+    int* inicios_;
+
+    /**
+     * Espectro compuesto por particion, [particion][termino].
+     */
+    complejo* compuesto_;
+    double* pesosCompuesto_;
+    int actualizaciones_;
+
+    /**
+     * Particiones del compuesto que se recorren: las de la banda mas larga con peso.
+     */
+    int activas_;
+
+    /**
+     * Espectro compuesto con los 2P terminos por particion, para filtrarEstereo().
+     * Se reconstruye cuando compuesto_ cambia.
+     */
+    complejo* compuestoCompleto_;
+    bool completoAlDia_;
+
+    /**
+     * Linea de retardo en frecuencia con las ultimas K DFT de la entrada.
+     */
+    complejo* fdl_;
+    int cabeza_;
+
+    /**
+     * Linea de retardo de filtrarEstereo() con las ultimas K DFT complejas Z(k), de 2P terminos.
+     */
+    complejo* fdlZ_;
+
+    /**
+     * Buffers de trabajo (alineados con fftw_malloc).
+     */
+    real* x_;
+    complejo* Y_;
+    real* y_;
+    float* historia_;
+    complejo* z_;
+    complejo* Z_;
+    float* historiaDerecha_;
+
+    /**
+     * Factores e^{j2*pi*k*n0/2P} con n0 = P + P/2, para los medidores.
+     */
+    complejo* giro_;
+    int contadorMedicion_;
+    int intervaloMedicion_;
+
+    /**
+     * Planes del cache de controlVolume (no pertenecen a esta clase).
+     */
+    plan dft_;
+    plan idft_;
+    plan zdft_;
+    plan zidft_;
+
+    /**
+     * Nucleos vectoriales para las multiplicaciones sobre la FDL.
+     */
+    const simdKernels& nucleos_;
+
+    partConvolver(const partConvolver&);
+    partConvolver& operator=(const partConvolver&);
+};
+
+/**
+ * Las dos precisiones se instancian en partconvolver.cpp.
+ */
+extern template class partConvolver<precision<float> >;
+extern template class partConvolver<precision<double> >;
+
+#endif // PARTCONVOLVER_H
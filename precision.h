@@ -0,0 +1,133 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   precision.h
+ *         Internal precision of the frequency-domain engines: FFTW API,
+ *         sample and spectrum types for float and double.
+ *
+ * $Id: precision.h $
+ */
+
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include <cstddef>
+#include <fftw3.h>
+#include "simdkernels.h"
+
+/**
+ * Tipos y funciones de FFTW de una precision.
+ *
+ * precision<double> usa la biblioteca fftw3 y precision<float> la fftw3f.
+ * Los motores por DFT (basicControlVolume y partConvolver) reciben una de
+ * ellas como parametro de plantilla y usan solo estos nombres, de modo que
+ * ambas precisiones pueden coexistir en un mismo programa.
+ */
+template<typename T>
+struct precision;
+
+template<>
+struct precision<double> {
+  typedef double real;
+  typedef fftw_complex complejo;
+  typedef fftw_plan plan;
+
+  static const char* nombre() { return "double"; }
+
+  static void* reservar(size_t bytes) { return fftw_malloc(bytes); }
+  static void liberar(void* p) { fftw_free(p); }
+
+  static plan planDirecto(int n,real* x,complejo* X,unsigned flags) {
+    return fftw_plan_dft_r2c_1d(n,x,X,flags);
+  }
+  static plan planInverso(int n,complejo* X,real* x,unsigned flags) {
+    return fftw_plan_dft_c2r_1d(n,X,x,flags);
+  }
+  static plan planComplejo(int n,complejo* x,complejo* X,int signo,unsigned flags) {
+    return fftw_plan_dft_1d(n,x,X,signo,flags);
+  }
+  static void destruir(plan p) { fftw_destroy_plan(p); }
+  static void limpiar() { fftw_cleanup(); }
+
+  static void directa(plan p,real* x,complejo* X) { fftw_execute_dft_r2c(p,x,X); }
+  static void inversa(plan p,complejo* X,real* x) { fftw_execute_dft_c2r(p,X,x); }
+  static void compleja(plan p,complejo* x,complejo* X) { fftw_execute_dft(p,x,X); }
+
+  static void multiplicar(const simdKernels& k,const complejo* x,const complejo* h,complejo* y,int n) {
+    k.multiplicar(x,h,y,n);
+  }
+  static void multiplicarAcumular(const simdKernels& k,const complejo* x,const complejo* h,complejo* y,int n) {
+    k.multiplicarAcumular(x,h,y,n);
+  }
+  static void acumularEscalado(const simdKernels& k,const real* x,real g,real* y,int n) {
+    k.acumularEscalado(x,g,y,n);
+  }
+};
+
+template<>
+struct precision<float> {
+  typedef float real;
+  typedef fftwf_complex complejo;
+  typedef fftwf_plan plan;
+
+  static const char* nombre() { return "float"; }
+
+  static void* reservar(size_t bytes) { return fftwf_malloc(bytes); }
+  static void liberar(void* p) { fftwf_free(p); }
+
+  static plan planDirecto(int n,real* x,complejo* X,unsigned flags) {
+    return fftwf_plan_dft_r2c_1d(n,x,X,flags);
+  }
+  static plan planInverso(int n,complejo* X,real* x,unsigned flags) {
+    return fftwf_plan_dft_c2r_1d(n,X,x,flags);
+  }
+  static plan planComplejo(int n,complejo* x,complejo* X,int signo,unsigned flags) {
+    return fftwf_plan_dft_1d(n,x,X,signo,flags);
+  }
+  static void destruir(plan p) { fftwf_destroy_plan(p); }
+  static void limpiar() { fftwf_cleanup(); }
+
+  static void directa(plan p,real* x,complejo* X) { fftwf_execute_dft_r2c(p,x,X); }
+  static void inversa(plan p,complejo* X,real* x) { fftwf_execute_dft_c2r(p,X,x); }
+  static void compleja(plan p,complejo* x,complejo* X) { fftwf_execute_dft(p,x,X); }
+
+  static void multiplicar(const simdKernels& k,const complejo* x,const complejo* h,complejo* y,int n) {
+    k.multiplicarF(x,h,y,n);
+  }
+  static void multiplicarAcumular(const simdKernels& k,const complejo* x,const complejo* h,complejo* y,int n) {
+    k.multiplicarAcumularF(x,h,y,n);
+  }
+  static void acumularEscalado(const simdKernels& k,const real* x,real g,real* y,int n) {
+    k.acumularEscaladoF(x,g,y,n);
+  }
+};
+
+/**
+ * Precision de los motores por DFT de la aplicacion (controlVolume). Por
+ * omision es float, que usa la mitad de memoria y el doble de carriles SIMD;
+ * con qmake CONFIG+=fftwdouble se compila en double como referencia. Ambas
+ * se comparan en las pruebas (make check, ver pruebas/precision.cpp).
+ */
+#ifdef _DSP_FFTW_DOUBLE
+typedef precision<double> precisionMotor;
+#else
+typedef precision<float> precisionMotor;
+#endif
+
+#endif // PRECISION_H
@@ -57,6 +57,23 @@ public:
   virtual bool process(float* in,
                        float* out)=0;
 
+  /**
+   * Number of channels handled by the processor: 1 (mono) or 2 (stereo).
+   *
+   * Mono processors receive the left input in process(in,out) and their
+   * output is sent to both output channels.
+   */
+  virtual int channels() const { return 1; }
+
+  /**
+   * Stereo processing function, called instead of process(in,out) when
+   * channels() is 2
+   */
+  virtual bool process(float* /*inL*/,
+                       float* /*inR*/,
+                       float* /*outL*/,
+                       float* /*outR*/) { return false; }
+
   /**
    * Shutdown the processor
    */
@@ -72,6 +89,12 @@ public:
    */
   virtual int setSampleRate(const int sampleRate)=0;
 
+  /**
+   * Algorithmic latency in frames added by the processor, which is reported
+   * to jack on top of the latency of the connected ports
+   */
+  virtual int latency() const { return 0; }
+
 };
 
 
@@ -0,0 +1,142 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   processoradapter.cpp
+ *         Adapter that runs a processor of the first interface revision
+ *         behind the processorV2 interface.
+ *
+ * $Id: processoradapter.cpp $
+ */
+
+#include "processoradapter.h"
+
+#include <cstring>
+
+/*
+ * Constructor
+ */
+processorAdapter::processorAdapter(processor* proc)
+  : proc_(proc),bufferSize_(0) {
+  for (int c=0;c<MaxChannels;++c) {
+    copias_[c]=0;
+  }
+}
+
+/*
+ * Destructor
+ */
+processorAdapter::~processorAdapter() {
+  for (int c=0;c<MaxChannels;++c) {
+    delete[] copias_[c];
+  }
+}
+
+void processorAdapter::use(processor* proc) {
+  proc_=proc;
+}
+
+processor* processorAdapter::adapted() const {
+  return proc_;
+}
+
+void processorAdapter::reservar(const int bufferSize) {
+  if (bufferSize != bufferSize_) {
+    for (int c=0;c<MaxChannels;++c) {
+      delete[] copias_[c];
+      copias_[c]=new float[bufferSize];
+    }
+  }
+  bufferSize_=bufferSize;
+}
+
+bool processorAdapter::init(const int frameRate,const int bufferSize) {
+  reservar(bufferSize);
+  return proc_->init(frameRate,bufferSize);
+}
+
+/*
+ * Processing function
+ */
+bool processorAdapter::process(float* const* in,
+                               float* const* out,
+                               const int channels,
+                               const int nframes,
+                               const bool inPlace,
+                               const processContext& /*context*/) {
+
+  // El procesador adaptado asume el tamano de bloque de setBufferSize().
+  if ((nframes != bufferSize_) || (channels < 1)) {
+    for (int c=0;c<channels;++c) {
+      memset(out[c],0,sizeof(float)*nframes);
+    }
+    return false;
+  }
+
+  const int usados = (proc_->channels() > 1) ? MaxChannels : 1;
+
+  float* entradas[MaxChannels];
+  for (int c=0;c<usados;++c) {
+    entradas[c] = in[(c < channels) ? c : 0];
+    if (inPlace) {
+      memcpy(copias_[c],entradas[c],sizeof(float)*nframes);
+      entradas[c] = copias_[c];
+    }
+  }
+
+  bool ok;
+  int escritos;
+  if (usados == 1) {
+    ok = proc_->process(entradas[0],out[0]);
+    for (int c=1;c<channels;++c) {
+      memcpy(out[c],out[0],sizeof(float)*nframes);
+    }
+    escritos = channels;
+  } else if (channels >= 2) {
+    ok = proc_->process(entradas[0],entradas[1],out[0],out[1]);
+    escritos = 2;
+  } else {
+    // Un procesador estereo con un solo canal recibe el mismo en ambos
+    // lados; la salida derecha va a la copia, que ya no se necesita.
+    ok = proc_->process(entradas[0],entradas[0],out[0],copias_[1]);
+    escritos = 1;
+  }
+
+  for (int c=escritos;c<channels;++c) {
+    memset(out[c],0,sizeof(float)*nframes);
+  }
+
+  return ok;
+}
+
+bool processorAdapter::shutdown() {
+  return proc_->shutdown();
+}
+
+int processorAdapter::setBufferSize(const int bufferSize) {
+  reservar(bufferSize);
+  return proc_->setBufferSize(bufferSize);
+}
+
+int processorAdapter::setSampleRate(const int sampleRate) {
+  return proc_->setSampleRate(sampleRate);
+}
+
+int processorAdapter::latency() const {
+  return proc_->latency();
+}
@@ -0,0 +1,110 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   processoradapter.h
+ *         Adapter that runs a processor of the first interface revision
+ *         behind the processorV2 interface.
+ *
+ * $Id: processoradapter.h $
+ */
+
+#ifndef PROCESSORADAPTER_H
+#define PROCESSORADAPTER_H
+
+#include "processor.h"
+#include "processorv2.h"
+
+/**
+ * Adaptador de processor a processorV2.
+ *
+ * El procesador adaptado no conoce el tamano del bloque: confia en el ultimo
+ * setBufferSize(). Si un bloque llega con otro tamano la salida es silencio.
+ * Como la interfaz anterior nunca recibio in == out, en los bloques en sitio
+ * la entrada se copia antes a buffers propios, reservados fuera del hilo de
+ * tiempo real. Un procesador mono recibe el primer canal y su salida se
+ * copia a los demas; uno estereo recibe los dos primeros y los demas
+ * canales de salida quedan en silencio.
+ */
+class processorAdapter : public processorV2 {
+public:
+
+  /**
+   * Constructor
+   * @param proc procesador adaptado (no pertenece al adaptador).
+   */
+  processorAdapter(processor* proc = 0);
+
+  /**
+   * Destructor
+   */
+  virtual ~processorAdapter();
+
+  /**
+   * Cambia el procesador adaptado. Debe llamarse antes de init().
+   */
+  void use(processor* proc);
+
+  /**
+   * Procesador adaptado.
+   */
+  processor* adapted() const;
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+  virtual int latency() const;
+
+private:
+
+  /**
+   * Canales que acepta la interfaz anterior.
+   */
+  enum {
+    MaxChannels=2
+  };
+
+  /**
+   * @brief reservar Ajusta las copias de la entrada al tamano de bloque.
+   */
+  void reservar(const int bufferSize);
+
+  processor* proc_;
+
+  /**
+   * Tamano de bloque que conoce el procesador adaptado.
+   */
+  int bufferSize_;
+
+  /**
+   * Copias de la entrada para los bloques en sitio, de bufferSize_ muestras.
+   */
+  float* copias_[MaxChannels];
+
+  processorAdapter(const processorAdapter&);
+  processorAdapter& operator=(const processorAdapter&);
+};
+
+#endif // PROCESSORADAPTER_H
@@ -0,0 +1,640 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   processorgraph.cpp
+ *         Graph of processorV2 nodes with explicit edges, compiled off the
+ *         real time thread into a plan that reuses buffers by liveness.
+ *
+ * $Id: processorgraph.cpp $
+ */
+
+#include "processorgraph.h"
+
+#include <algorithm>
+#include <cstring>
+
+/*
+ * Constructor
+ */
+processorGraph::processorGraph()
+  : sampleRate_(0),bufferSize_(0),iniciado_(false),actual_(0),reservado_(0),
+    pedido_(0),terminar_(false),nucleos_(simdKernels::seleccionados()) {
+  for (int v=0;v<MaxNodes;++v) {
+    nodos_[v].proc=0;
+    nodos_[v].iniciado=false;
+  }
+  sem_init(&pendiente_,0,0);
+  trabajador_ = std::thread(&processorGraph::trabajar,this);
+}
+
+/*
+ * Destructor
+ */
+processorGraph::~processorGraph() {
+  terminar_.store(true);
+  sem_post(&pendiente_);
+  trabajador_.join();
+  sem_destroy(&pendiente_);
+
+  Plan* plan = actual_.exchange(0);
+  if (plan != 0) {
+    destruir(plan);
+  }
+  while (!retirados_.empty()) {
+    destruir(retirados_.front());
+    retirados_.pop_front();
+  }
+  for (size_t i=0;i<quitados_.size();++i) {
+    delete quitados_[i];
+  }
+  for (int v=0;v<MaxNodes;++v) {
+    delete nodos_[v].proc;
+  }
+}
+
+int processorGraph::addNode(processorV2* node) {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  for (int v=0;v<MaxNodes;++v) {
+    if (nodos_[v].proc == 0) {
+      nodos_[v].proc=node;
+      nodos_[v].iniciado=false;
+      return v;
+    }
+  }
+  return -1;
+}
+
+bool processorGraph::removeNode(int node) {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  if ((node < 0) || (node >= MaxNodes) || (nodos_[node].proc == 0)) {
+    return false;
+  }
+  for (size_t i=aristas_.size();i>0;--i) {
+    if ((aristas_[i-1].first == node) || (aristas_[i-1].second == node)) {
+      aristas_.erase(aristas_.begin()+(i-1));
+    }
+  }
+  quitados_.push_back(nodos_[node].proc);
+  nodos_[node].proc=0;
+  return true;
+}
+
+bool processorGraph::connect(int from,int to) {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  const bool origen = (from == Input) ||
+    ((from >= 0) && (from < MaxNodes) && (nodos_[from].proc != 0));
+  const bool destino = (to == Output) ||
+    ((to >= 0) && (to < MaxNodes) && (nodos_[to].proc != 0));
+  const std::pair<int,int> arista(from,to);
+  if (!origen || !destino || (from == to) ||
+      (std::find(aristas_.begin(),aristas_.end(),arista) != aristas_.end())) {
+    return false;
+  }
+  aristas_.push_back(arista);
+  return true;
+}
+
+bool processorGraph::disconnect(int from,int to) {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  std::vector<std::pair<int,int> >::iterator it =
+    std::find(aristas_.begin(),aristas_.end(),std::make_pair(from,to));
+  if (it == aristas_.end()) {
+    return false;
+  }
+  aristas_.erase(it);
+  return true;
+}
+
+bool processorGraph::commit() {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  return publicar();
+}
+
+int processorGraph::buffers() const {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  const Plan* plan = actual_.load();
+  return (plan != 0) ? int(plan->canales.size())/MaxChannels : 0;
+}
+
+/*
+ * Orden topologico (algoritmo de Kahn)
+ */
+bool processorGraph::ordenar(std::vector<int>& orden) const {
+
+  bool activo[MaxNodes];
+  bool puesto[MaxNodes];
+  int llegadas[MaxNodes];
+  for (int v=0;v<MaxNodes;++v) {
+    activo[v]=false;
+    puesto[v]=false;
+    llegadas[v]=0;
+  }
+  int total=0;
+  for (size_t i=0;i<aristas_.size();++i) {
+    const int a=aristas_[i].first;
+    const int b=aristas_[i].second;
+    if ((a >= 0) && !activo[a]) {
+      activo[a]=true;
+      ++total;
+    }
+    if ((b >= 0) && !activo[b]) {
+      activo[b]=true;
+      ++total;
+    }
+    if ((a >= 0) && (b >= 0)) {
+      ++llegadas[b];
+    }
+  }
+
+  orden.clear();
+  for (;;) {
+    int v=0;
+    while ((v < MaxNodes) && (!activo[v] || puesto[v] || (llegadas[v] != 0))) {
+      ++v;
+    }
+    if (v == MaxNodes) {
+      break;
+    }
+    puesto[v]=true;
+    orden.push_back(v);
+    for (size_t i=0;i<aristas_.size();++i) {
+      if ((aristas_[i].first == v) && (aristas_[i].second >= 0)) {
+        --llegadas[aristas_[i].second];
+      }
+    }
+  }
+  return int(orden.size()) == total;
+}
+
+/*
+ * Compilacion del grafo
+ *
+ * Los extremos se indexan como los nodos, con la entrada en MaxNodes y la
+ * salida en MaxNodes+1. Un nodo readOnly() con una sola llegada no tiene
+ * buffer propio: comparte el de su llegada, su raiz. La vida de cada raiz
+ * es la posicion en el orden de su ultimo lector, contando los de todos los
+ * nodos que la comparten; la de la salida es la cantidad de nodos.
+ */
+processorGraph::Plan* processorGraph::compilar() const {
+
+  std::vector<int> orden;
+  if (!ordenar(orden)) {
+    return 0;
+  }
+  const int n = int(orden.size());
+  const int entrada = MaxNodes;
+  const int salida = MaxNodes + 1;
+
+  int posicion[MaxNodes+2];
+  posicion[entrada] = -1;
+  posicion[salida] = n;
+  for (int i=0;i<n;++i) {
+    posicion[orden[i]]=i;
+  }
+
+  // Llegadas de cada nodo y de la salida, con la entrada primero: la suma de
+  // la salida copia la primera llegada sobre el buffer de jack, que puede
+  // ser el mismo de la entrada.
+  std::vector<int> llegadas[MaxNodes+2];
+  for (size_t i=0;i<aristas_.size();++i) {
+    const int a = (aristas_[i].first == Input) ? entrada : aristas_[i].first;
+    const int b = (aristas_[i].second == Output) ? salida : aristas_[i].second;
+    if (a == entrada) {
+      llegadas[b].insert(llegadas[b].begin(),a);
+    } else {
+      llegadas[b].push_back(a);
+    }
+  }
+
+  int raiz[MaxNodes+1];
+  int vida[MaxNodes+1];
+  int buffer[MaxNodes+1];
+  for (int v=0;v<=MaxNodes;++v) {
+    raiz[v]=v;
+    vida[v]=-1;
+    buffer[v]=-1;
+  }
+  for (int i=0;i<n;++i) {
+    const int v=orden[i];
+    if (nodos_[v].proc->readOnly() && (llegadas[v].size() == 1)) {
+      raiz[v]=raiz[llegadas[v][0]];
+    }
+  }
+  for (size_t i=0;i<aristas_.size();++i) {
+    const int a = (aristas_[i].first == Input) ? entrada : aristas_[i].first;
+    const int b = (aristas_[i].second == Output) ? salida : aristas_[i].second;
+    vida[raiz[a]] = std::max(vida[raiz[a]],posicion[b]);
+  }
+  buffer[entrada]=BufferEntrada;
+
+  // La raiz que alimenta sola a la salida escribe en el buffer de jack si la
+  // entrada del grafo ya no se lee; si ella trabaja en sitio, tambien la
+  // cadena de nodos de una sola llegada que la precede, de modo que una
+  // cadena completa no usa buffers intermedios.
+  bool escribeSalida[MaxNodes];
+  for (int v=0;v<MaxNodes;++v) {
+    escribeSalida[v]=false;
+  }
+  int u = (llegadas[salida].size() == 1) ? raiz[llegadas[salida][0]] : entrada;
+  if ((u != entrada) && nodos_[u].proc->readOnly()) {
+    u = entrada;
+  }
+  while ((u != entrada) && (vida[entrada] <= posicion[u])) {
+    escribeSalida[u]=true;
+    const int p = (llegadas[u].size() == 1) ? llegadas[u][0] : entrada;
+    if ((p == entrada) || (raiz[p] != p) || nodos_[p].proc->readOnly() ||
+        (vida[p] != posicion[u]) || nodos_[u].proc->prefersSeparateBuffers()) {
+      break;
+    }
+    u = p;
+  }
+
+  Plan* plan = new Plan;
+  plan->capacidad = bufferSize_;
+  plan->memoria = 0;
+
+  std::vector<int> libres;
+  int intermedios = 0;
+
+  for (int i=0;i<n;++i) {
+    const int v=orden[i];
+    processorV2* proc=nodos_[v].proc;
+    const std::vector<int>& desde=llegadas[v];
+    Paso paso;
+
+    // Entrada: la de la unica llegada, o la suma de todas en un buffer
+    // temporal (el de la primera llegada si este nodo es su ultimo lector).
+    int bufEntrada;
+    bool temporal = false;
+    if (desde.size() == 1) {
+      bufEntrada = buffer[desde[0]];
+    } else {
+      temporal = true;
+      const int r = desde.empty() ? -1 : raiz[desde[0]];
+      bool reusar = (r >= 0) && (buffer[r] >= PrimerIntermedio) && (vida[r] == i);
+      for (size_t k=1;reusar && (k<desde.size());++k) {
+        reusar = (raiz[desde[k]] != r);
+      }
+      if (reusar) {
+        bufEntrada = buffer[r];
+      } else if (!libres.empty()) {
+        bufEntrada = libres.back();
+        libres.pop_back();
+      } else {
+        bufEntrada = PrimerIntermedio + intermedios++;
+      }
+      paso.nodo = 0;
+      paso.salida = bufEntrada;
+      if (desde.empty()) {
+        paso.tipo = PasoCeros;
+        paso.entrada = bufEntrada;
+        plan->pasos.push_back(paso);
+      } else {
+        for (size_t k=0;k<desde.size();++k) {
+          paso.tipo = ((k == 0) && !reusar) ? PasoCopiar : PasoSumar;
+          paso.entrada = buffer[desde[k]];
+          if ((k > 0) || !reusar) {
+            plan->pasos.push_back(paso);
+          }
+        }
+      }
+    }
+
+    // Salida: la misma entrada si el nodo solo lee o es su ultimo lector,
+    // el buffer de jack si alimenta a la salida y la entrada del grafo ya no
+    // se lee, o un buffer libre.
+    int bufSalida;
+    if (proc->readOnly()) {
+      bufSalida = bufEntrada;
+    } else if (escribeSalida[v]) {
+      bufSalida = BufferSalida;
+    } else if ((bufEntrada >= PrimerIntermedio) && !proc->prefersSeparateBuffers() &&
+               (temporal || (vida[raiz[desde[0]]] == i))) {
+      bufSalida = bufEntrada;
+    } else if (!libres.empty()) {
+      bufSalida = libres.back();
+      libres.pop_back();
+    } else {
+      bufSalida = PrimerIntermedio + intermedios++;
+    }
+    buffer[v] = bufSalida;
+
+    paso.tipo = PasoNodo;
+    paso.nodo = proc;
+    paso.entrada = bufEntrada;
+    paso.salida = bufSalida;
+    plan->pasos.push_back(paso);
+
+    // Vuelven a estar libres los buffers cuyo ultimo lector es este nodo.
+    std::vector<int> muertos;
+    for (size_t k=0;k<desde.size();++k) {
+      if (vida[raiz[desde[k]]] == i) {
+        muertos.push_back(buffer[desde[k]]);
+      }
+    }
+    if (temporal) {
+      muertos.push_back(bufEntrada);
+    }
+    const bool salidaMuerta = (vida[raiz[v]] <= i);
+    if (salidaMuerta) {
+      muertos.push_back(bufSalida);
+    }
+    for (size_t k=0;k<muertos.size();++k) {
+      const int b=muertos[k];
+      if ((b >= PrimerIntermedio) && ((b != bufSalida) || salidaMuerta) &&
+          (std::find(libres.begin(),libres.end(),b) == libres.end())) {
+        libres.push_back(b);
+      }
+    }
+  }
+
+  // Salida del grafo: silencio, la unica llegada (si no escribio ya en el
+  // buffer de jack) o la suma de todas.
+  Paso paso;
+  paso.nodo = 0;
+  paso.salida = BufferSalida;
+  const std::vector<int>& finales = llegadas[salida];
+  if (finales.empty()) {
+    paso.tipo = PasoCeros;
+    paso.entrada = BufferSalida;
+    plan->pasos.push_back(paso);
+  }
+  for (size_t k=0;k<finales.size();++k) {
+    paso.tipo = (k == 0) ? PasoCopiar : PasoSumar;
+    paso.entrada = buffer[finales[k]];
+    if (paso.entrada != BufferSalida) {
+      plan->pasos.push_back(paso);
+    }
+  }
+
+  // Memoria de los buffers intermedios, reservada aqui y no en process().
+  const size_t muestras = size_t(std::max(0,bufferSize_));
+  if ((intermedios > 0) && (muestras > 0)) {
+    plan->memoria = new float[size_t(intermedios)*MaxChannels*muestras]();
+  }
+  plan->canales.resize(size_t(intermedios)*MaxChannels);
+  for (size_t k=0;k<plan->canales.size();++k) {
+    plan->canales[k] = (plan->memoria != 0) ? plan->memoria + k*muestras : 0;
+  }
+  return plan;
+}
+
+/*
+ * Publicacion de un plan nuevo
+ */
+bool processorGraph::publicar() {
+
+  if (!iniciado_) {
+    std::vector<int> orden;
+    return ordenar(orden);
+  }
+
+  for (int v=0;v<MaxNodes;++v) {
+    if ((nodos_[v].proc != 0) && !nodos_[v].iniciado) {
+      nodos_[v].proc->init(sampleRate_,bufferSize_);
+      nodos_[v].iniciado=true;
+    }
+  }
+
+  Plan* plan = compilar();
+  if (plan == 0) {
+    return false;
+  }
+
+  // process() toma el plan nuevo en el siguiente bloque. Los nodos quitados
+  // pueden estar en el plan anterior, por lo que se destruyen con el.
+  Plan* anterior = actual_.exchange(plan);
+  if (anterior != 0) {
+    anterior->borrar.insert(anterior->borrar.end(),quitados_.begin(),quitados_.end());
+    retirados_.push_back(anterior);
+  } else {
+    for (size_t i=0;i<quitados_.size();++i) {
+      delete quitados_[i];
+    }
+  }
+  quitados_.clear();
+
+  liberarRetirados();
+  return true;
+}
+
+/*
+ * Los planes se liberan en el orden en que se retiraron: un plan mas
+ * antiguo que el que usa process() puede contener los nodos que se
+ * destruyen con uno mas reciente, por lo que este espera a aquel.
+ */
+void processorGraph::liberarRetirados() {
+  const Plan* enUso = reservado_.load();
+  while (!retirados_.empty() && (retirados_.front() != enUso)) {
+    destruir(retirados_.front());
+    retirados_.pop_front();
+  }
+}
+
+void processorGraph::destruir(Plan* plan) {
+  for (size_t i=0;i<plan->borrar.size();++i) {
+    delete plan->borrar[i];
+  }
+  delete[] plan->memoria;
+  delete plan;
+}
+
+float* const* processorGraph::buffer(const Plan* plan,int b,float* const* in,float* const* out) {
+  if (b == BufferEntrada) {
+    return in;
+  }
+  if (b == BufferSalida) {
+    return out;
+  }
+  return &plan->canales[size_t(b - PrimerIntermedio)*MaxChannels];
+}
+
+bool processorGraph::init(const int frameRate,const int bufferSize) {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  sampleRate_=frameRate;
+  bufferSize_=bufferSize;
+  for (int v=0;v<MaxNodes;++v) {
+    nodos_[v].iniciado=false;
+  }
+  iniciado_=true;
+  return publicar();
+}
+
+/*
+ * Processing function
+ */
+bool processorGraph::process(float* const* in,
+                             float* const* out,
+                             const int channels,
+                             const int nframes,
+                             const bool /*inPlace*/,
+                             const processContext& context) {
+
+  // Se declara el plan en reservado_ antes de usarlo y se verifica que siga
+  // publicado, para que commit() no lo libere.
+  Plan* plan = actual_.load();
+  for (;;) {
+    reservado_.store(plan);
+    Plan* publicado = actual_.load();
+    if (publicado == plan) {
+      break;
+    }
+    plan = publicado;
+  }
+
+  const int canales = std::min(channels,int(MaxChannels));
+  for (int c=canales;c<channels;++c) {
+    memset(out[c],0,sizeof(float)*nframes);
+  }
+  if ((plan == 0) || (nframes > plan->capacidad)) {
+    for (int c=0;c<canales;++c) {
+      memset(out[c],0,sizeof(float)*nframes);
+    }
+    return false;
+  }
+  if (canales < 1) {
+    return true;
+  }
+
+  // La entrada y la salida de jack pueden ser el mismo buffer; el plan
+  // nunca escribe en la salida mientras la entrada aun se lee.
+  bool ok = true;
+  for (size_t i=0;i<plan->pasos.size();++i) {
+    const Paso& paso = plan->pasos[i];
+    float* const* x = buffer(plan,paso.entrada,in,out);
+    float* const* y = buffer(plan,paso.salida,in,out);
+    switch (paso.tipo) {
+    case PasoNodo:
+      ok = paso.nodo->process(x,y,canales,nframes,x[0] == y[0],context) && ok;
+      break;
+    case PasoCopiar:
+      for (int c=0;c<canales;++c) {
+        if (x[c] != y[c]) {
+          memcpy(y[c],x[c],sizeof(float)*nframes);
+        }
+      }
+      break;
+    case PasoSumar:
+      for (int c=0;c<canales;++c) {
+        nucleos_.acumularEscaladoF(x[c],1.0f,y[c],nframes);
+      }
+      break;
+    default:
+      for (int c=0;c<canales;++c) {
+        memset(y[c],0,sizeof(float)*nframes);
+      }
+      break;
+    }
+  }
+  return ok;
+}
+
+bool processorGraph::shutdown() {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  bool ok = true;
+  for (int v=0;v<MaxNodes;++v) {
+    if (nodos_[v].proc != 0) {
+      ok = nodos_[v].proc->shutdown() && ok;
+    }
+  }
+  return ok;
+}
+
+/*
+ * Set buffer size (call-back)
+ *
+ * The design thread compiles and publishes the plan for the new size; blocks
+ * larger than the published plan are silenced until then. This call never
+ * blocks.
+ */
+int processorGraph::setBufferSize(const int bufferSize) {
+  pedido_.store(bufferSize);
+  sem_post(&pendiente_);
+  return 1;
+}
+
+/*
+ * Design thread: the nodes are told the new size and the plan is compiled
+ * for it outside of the jack callbacks.
+ */
+void processorGraph::trabajar() {
+
+  for (;;) {
+    while (sem_wait(&pendiente_) != 0) {
+      // EINTR: se vuelve a esperar
+    }
+    if (terminar_.load()) {
+      return;
+    }
+
+    const int pedido = pedido_.exchange(0);
+    if (pedido <= 0) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> cerrojo(cerrojo_);
+    bufferSize_=pedido;
+    for (int v=0;v<MaxNodes;++v) {
+      if ((nodos_[v].proc != 0) && nodos_[v].iniciado) {
+        nodos_[v].proc->setBufferSize(pedido);
+      }
+    }
+    publicar();
+  }
+}
+
+int processorGraph::setSampleRate(const int sampleRate) {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  sampleRate_=sampleRate;
+  for (int v=0;v<MaxNodes;++v) {
+    if ((nodos_[v].proc != 0) && nodos_[v].iniciado) {
+      nodos_[v].proc->setSampleRate(sampleRate);
+    }
+  }
+  return 1;
+}
+
+/*
+ * Latency of the slowest path from the input to the output
+ */
+int processorGraph::latency() const {
+  std::lock_guard<std::mutex> cerrojo(cerrojo_);
+  std::vector<int> orden;
+  if (!ordenar(orden)) {
+    return 0;
+  }
+  int acumulada[MaxNodes];
+  for (size_t i=0;i<orden.size();++i) {
+    const int v=orden[i];
+    int llegada=0;
+    for (size_t k=0;k<aristas_.size();++k) {
+      if ((aristas_[k].second == v) && (aristas_[k].first >= 0)) {
+        llegada = std::max(llegada,acumulada[aristas_[k].first]);
+      }
+    }
+    acumulada[v] = llegada + nodos_[v].proc->latency();
+  }
+  int total=0;
+  for (size_t k=0;k<aristas_.size();++k) {
+    if ((aristas_[k].second == Output) && (aristas_[k].first >= 0)) {
+      total = std::max(total,acumulada[aristas_[k].first]);
+    }
+  }
+  return total;
+}
@@ -0,0 +1,282 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   processorgraph.h
+ *         Graph of processorV2 nodes with explicit edges, compiled off the
+ *         real time thread into a plan that reuses buffers by liveness.
+ *
+ * $Id: processorgraph.h $
+ */
+
+#ifndef PROCESSORGRAPH_H
+#define PROCESSORGRAPH_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <semaphore.h>
+
+#include "processorv2.h"
+#include "simdkernels.h"
+
+/**
+ * Grafo de procesamiento.
+ *
+ * Los nodos son processorV2 (ecualizador, reverberador, analizador,
+ * ganancia...; ver graphnodes.h) unidos por aristas explicitas. Input es la
+ * entrada del grafo y Output su salida; un nodo o la salida con varias
+ * aristas de llegada reciben su suma, y un nodo con varias de salida
+ * alimenta a todos sus destinos con el mismo buffer. Los nodos sin aristas
+ * no se ejecutan.
+ *
+ * commit() compila el grafo en el hilo que lo llama, nunca en el de tiempo
+ * real, en un plan: los nodos en orden topologico y el buffer de entrada y
+ * de salida de cada uno. Los buffers se asignan con su vida util: un nodo
+ * escribe sobre su entrada (en sitio) cuando es el ultimo que la lee, salvo
+ * que prefiera buffers separados (prefersSeparateBuffers()); un nodo que
+ * solo lee (readOnly()) se llama en sitio y sus destinos leen su entrada; y
+ * el nodo que alimenta la salida, junto con la cadena que le precede en
+ * sitio, escribe directamente en el buffer de jack cuando ya nadie lee la
+ * entrada del grafo. Un buffer intermedio vuelve a
+ * usarse en cuanto su ultimo lector termina, de modo que agregar un nodo a
+ * una cadena solo agrega su propio trabajo, sin copias ni buffers nuevos.
+ *
+ * El plan nuevo se publica de forma atomica; process() toma el publicado al
+ * empezar cada bloque (como los estados de controlVolume) y el plan anterior
+ * se libera, junto con los nodos que se quitaron, en un commit() posterior,
+ * cuando process() ya no lo usa. En process() no se reserva memoria ni se
+ * toman candados.
+ *
+ * setBufferSize() llega en un callback de jack, por lo que solo registra el
+ * tamano pedido: el plan para ese tamano lo compila y publica el hilo de
+ * diseno del grafo, como controlVolume::solicitarPlanes(). Mientras tanto
+ * process() sigue con el plan anterior, o produce silencio si el bloque es
+ * mas largo que sus buffers.
+ *
+ * Las ramas paralelas no se alinean: latency() es la del camino mas lento
+ * hasta la salida.
+ */
+class processorGraph : public processorV2 {
+public:
+
+  /**
+   * Constantes del grafo.
+   */
+  enum {
+    Input=-1,       /**< Extremo de una arista en la entrada del grafo. */
+    Output=-2,      /**< Extremo de una arista en la salida del grafo. */
+    MaxNodes=32,    /**< Nodos que puede tener el grafo. */
+    MaxChannels=8   /**< Canales que procesa; los demas quedan en silencio. */
+  };
+
+  /**
+   * Constructor: grafo vacio, cuya salida es silencio.
+   */
+  processorGraph();
+
+  /**
+   * Destructor: destruye todos los nodos.
+   */
+  virtual ~processorGraph();
+
+  /**
+   * @brief addNode Agrega un nodo, que pasa a pertenecer al grafo. Tiene efecto en el siguiente commit().
+   * @return indice del nodo, o -1 si el grafo esta lleno.
+   */
+  int addNode(processorV2* node);
+
+  /**
+   * @brief removeNode Quita un nodo y sus aristas. Se destruye cuando ningun plan en uso lo contiene.
+   */
+  bool removeNode(int node);
+
+  /**
+   * @brief connect Agrega la arista from -> to (from: nodo o Input; to: nodo u Output).
+   * @return false si algun extremo no existe o la arista ya existe.
+   */
+  bool connect(int from,int to);
+
+  /**
+   * @brief disconnect Quita la arista from -> to.
+   */
+  bool disconnect(int from,int to);
+
+  /**
+   * @brief commit Compila el grafo y publica el plan. Inicializa los nodos agregados si el grafo ya
+   * fue inicializado. Debe llamarse fuera del hilo de tiempo real.
+   * @return false si el grafo tiene un ciclo; entonces sigue el plan anterior.
+   */
+  bool commit();
+
+  /**
+   * @brief buffers Buffers intermedios que usa el plan publicado, sin contar los de jack.
+   */
+  int buffers() const;
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+  virtual int latency() const;
+
+private:
+
+  /**
+   * Buffers del plan: la entrada y la salida de jack y luego los intermedios.
+   */
+  enum {
+    BufferEntrada=0,
+    BufferSalida=1,
+    PrimerIntermedio=2
+  };
+
+  /**
+   * Operaciones de un plan.
+   */
+  enum {
+    PasoNodo,    /**< Procesa entrada y escribe salida. */
+    PasoCopiar,  /**< Copia entrada en salida. */
+    PasoSumar,   /**< Suma entrada a salida. */
+    PasoCeros    /**< Escribe silencio en salida. */
+  };
+
+  struct Paso {
+    int tipo;
+    processorV2* nodo;
+    int entrada;
+    int salida;
+  };
+
+  /**
+   * Grafo compilado. Solo lo modifica quien lo compila, antes de publicarlo.
+   */
+  struct Plan {
+    std::vector<Paso> pasos;
+    int capacidad;                       /**< Muestras por canal de cada buffer intermedio. */
+    float* memoria;
+    std::vector<float*> canales;         /**< [buffer intermedio][canal] punteros a memoria. */
+    std::vector<processorV2*> borrar;    /**< Nodos quitados que se destruyen con el plan. */
+  };
+
+  /**
+   * Nodo del grafo; proc es 0 si el indice esta libre.
+   */
+  struct Nodo {
+    processorV2* proc;
+    bool iniciado;
+  };
+
+  /**
+   * @brief ordenar Orden topologico de los nodos con aristas (entre los listos, el de menor indice).
+   * @return false si hay un ciclo.
+   */
+  bool ordenar(std::vector<int>& orden) const;
+
+  /**
+   * @brief compilar Construye el plan del grafo actual para bufferSize_ muestras.
+   * @return 0 si hay un ciclo.
+   */
+  Plan* compilar() const;
+
+  /**
+   * @brief publicar Inicializa los nodos nuevos, compila y publica el plan, y libera los anteriores
+   * que ya no se usan. Requiere cerrojo_.
+   */
+  bool publicar();
+
+  /**
+   * @brief liberarRetirados Destruye, en orden, los planes retirados anteriores al que usa process().
+   */
+  void liberarRetirados();
+
+  /**
+   * @brief trabajar Ciclo del hilo de diseno: espera tamanos pedidos y publica sus planes.
+   */
+  void trabajar();
+
+  /**
+   * @brief destruir Libera un plan y los nodos que se quitaron con el.
+   */
+  static void destruir(Plan* plan);
+
+  /**
+   * @brief buffer Punteros de cada canal de un buffer del plan.
+   */
+  static float* const* buffer(const Plan* plan,int b,float* const* in,float* const* out);
+
+  /**
+   * Grafo que se edita. Lo protege cerrojo_; process() nunca lo lee.
+   */
+  Nodo nodos_[MaxNodes];
+  std::vector<std::pair<int,int> > aristas_;
+  std::vector<processorV2*> quitados_;
+  int sampleRate_;
+  int bufferSize_;
+  bool iniciado_;
+  mutable std::mutex cerrojo_;
+
+  /**
+   * Plan publicado y plan que usa process(); el segundo lo declara process()
+   * antes de usarlo y verifica que siga publicado, de modo que un plan
+   * retirado distinto de reservado_ ya no puede usarse.
+   */
+  std::atomic<Plan*> actual_;
+  std::atomic<Plan*> reservado_;
+
+  /**
+   * Planes retirados aun no liberados, del mas antiguo al mas reciente.
+   */
+  std::deque<Plan*> retirados_;
+
+  /**
+   * Ultimo tamano de bloque pedido por setBufferSize() al hilo de diseno, o 0.
+   */
+  std::atomic<int> pedido_;
+
+  /**
+   * Indica al hilo de diseno que debe terminar.
+   */
+  std::atomic<bool> terminar_;
+
+  /**
+   * Despierta al hilo de diseno; sem_post no bloquea.
+   */
+  sem_t pendiente_;
+
+  /**
+   * Hilo de diseno.
+   */
+  std::thread trabajador_;
+
+  const simdKernels& nucleos_;
+
+  processorGraph(const processorGraph&);
+  processorGraph& operator=(const processorGraph&);
+};
+
+#endif // PROCESSORGRAPH_H
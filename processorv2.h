@@ -0,0 +1,130 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   processorv2.h
+ *         Second revision of the block processing interface: multichannel,
+ *         with frame count, in-place flag and per-call context.
+ *
+ * $Id: processorv2.h $
+ */
+
+#ifndef PROCESSORV2_H
+#define PROCESSORV2_H
+
+/**
+ * Informacion del periodo que acompana a cada llamada de processorV2::process().
+ */
+struct processContext {
+  /**
+   * Tiempo en muestras (reloj de jack) de la primera muestra del bloque.
+   */
+  unsigned long frameTime;
+
+  /**
+   * Indica que hubo un xrun desde la llamada anterior, es decir, que la
+   * entrada no es continua con la del bloque anterior.
+   */
+  bool xrun;
+};
+
+/**
+ * Interfaz de procesamiento por bloques, revision 2.
+ *
+ * A diferencia de processor, cada llamada recibe la cantidad de muestras del
+ * bloque, que puede cambiar entre llamadas, y un arreglo de punteros con un
+ * buffer no entrelazado por canal. Si inPlace es verdadero, in[c] y out[c]
+ * son el mismo buffer para todo canal c y el procesador debe leer cada
+ * entrada antes de escribir su salida.
+ *
+ * Los procesadores de la interfaz anterior se usan con processorAdapter.
+ */
+class processorV2 {
+public:
+  /**
+   * Constructor
+   */
+  processorV2() {}
+
+  /**
+   * Destructor
+   */
+  virtual ~processorV2() {}
+
+  /**
+   * Initialization function for the current filter plan
+   */
+  virtual bool init(const int frameRate,
+                    const int bufferSize)=0;
+
+  /**
+   * Processing function
+   *
+   * @param in buffer de entrada de cada canal.
+   * @param out buffer de salida de cada canal.
+   * @param channels cantidad de canales de in y out.
+   * @param nframes muestras de cada buffer.
+   * @param inPlace indica que in[c] == out[c].
+   * @param context tiempo del bloque y aviso de xrun.
+   * @return false si el bloque no se pudo procesar.
+   */
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context)=0;
+
+  /**
+   * Shutdown the processor
+   */
+  virtual bool shutdown()=0;
+
+  /**
+   * Set buffer size
+   */
+  virtual int setBufferSize(const int bufferSize)=0;
+
+  /**
+   * Set frame rate
+   */
+  virtual int setSampleRate(const int sampleRate)=0;
+
+  /**
+   * Algorithmic latency in frames added by the processor, which is reported
+   * to jack on top of the latency of the connected ports
+   */
+  virtual int latency() const { return 0; }
+
+  /**
+   * Indicates that in-place blocks cost the processor an internal copy of
+   * its input, so a host that can choose (processorGraph) gives it separate
+   * input and output buffers.  In-place blocks must still be supported
+   */
+  virtual bool prefersSeparateBuffers() const { return false; }
+
+  /**
+   * Indicates that the processor only reads its input (meters, analyzers)
+   * and its output is always equal to it, so a host that can choose
+   * (processorGraph) calls it in place and forwards the input buffer
+   */
+  virtual bool readOnly() const { return false; }
+
+};
+
+#endif // PROCESSORV2_H
@@ -0,0 +1,128 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   precision.cpp
+ *         Test: the single precision DFT engines against the double
+ *         precision ones, with a minimum signal to noise ratio per engine.
+ *
+ * $Id: precision.cpp $
+ */
+
+#include "controlvolume.h"
+#include "spectralvalues.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  /*
+   * Condiciones de la prueba: 400 periodos de 256 muestras a 48 kHz, y la
+   * relacion senal a ruido minima de la salida float respecto a la double.
+   */
+  const int sampleRate = 48000;
+  const int bufferSize = 256;
+  const int periodos = 400;
+  const double minimo = 110.0;
+
+  /*
+   * Filtra periodos periodos de ruido uniforme con un motor y una precision,
+   * con ganancias distintas en cada banda, y guarda la salida de todos los
+   * canales.
+   */
+  template<typename Precision>
+  void filtrarRuido(int motor,int canales,vector<float>& salida){
+
+    basicControlVolume<Precision> cv;
+    cv.motor = motor;
+    cv.prepararPlanes(sampleRate,bufferSize);
+
+    int ganancias[basicControlVolume<Precision>::MaxBandas];
+    for(int b = 0; b < cv.bandas().bandas(); b++){
+      ganancias[b] = 5 + (17*b) % 46;
+    }
+
+    vector<float> entrada(2*bufferSize);
+    salida.assign(size_t(canales)*bufferSize*periodos,0.0f);
+    Spectral spectral;
+    unsigned int semilla = 1;
+    for(int k = 0; k < periodos; k++){
+      for(size_t i = 0; i < entrada.size(); i++){
+        semilla = semilla*1103515245u + 12345u;
+        entrada[i] = ((semilla >> 8) & 0xffff)/65536.0f - 0.5f;
+      }
+      float* out = &salida[size_t(k)*canales*bufferSize];
+      if(canales == 1){
+        cv.filter(bufferSize,25,ganancias,&entrada[0],out,0,1,false,0,&spectral);
+      } else {
+        cv.filter(bufferSize,25,ganancias,&entrada[0],&entrada[bufferSize],out,out + bufferSize,
+                  0,1,false,0,&spectral);
+      }
+    }
+  }
+}
+
+/*
+ * Filtra el mismo ruido con cada motor por DFT en float y en double, en mono
+ * y en estereo, y falla si la salida float de algun motor queda bajo el
+ * minimo respecto a la double, que se toma como referencia.
+ */
+int main(){
+
+  static const int motores[] = {controlVolume::MotorBandas,controlVolume::MotorCompuesto,
+                                controlVolume::MotorParticionado,controlVolume::MotorMultitasa};
+  static const char* nombres[] = {"bandas","compuesto","particionado","multitasa"};
+
+  cout << "precision: " << periodos << " periodos de " << bufferSize << " muestras a "
+       << sampleRate << " Hz, minimo " << minimo << " dB" << endl;
+
+  int fallas = 0;
+  vector<float> simple;
+  vector<float> doble;
+  for(size_t m = 0; m < sizeof(motores)/sizeof(motores[0]); m++){
+    for(int canales = 1; canales <= 2; canales++){
+      filtrarRuido<precision<float> >(motores[m],canales,simple);
+      filtrarRuido<precision<double> >(motores[m],canales,doble);
+
+      double senal = 0.0;
+      double ruido = 0.0;
+      double maximo = 0.0;
+      for(size_t i = 0; i < doble.size(); i++){
+        const double error = double(simple[i]) - doble[i];
+        senal += double(doble[i])*doble[i];
+        ruido += error*error;
+        maximo = std::max(maximo,std::fabs(error));
+      }
+      const double snr = (ruido > 0.0) ? 10.0*log10(senal/ruido) : HUGE_VAL;
+      const bool pasa = (senal > 0.0) && (snr >= minimo);
+      if(!pasa){
+        ++fallas;
+      }
+
+      cout << "  motor " << nombres[m] << ((canales == 1) ? " mono: " : " estereo: ") << snr
+           << " dB, error maximo " << maximo << (pasa ? "" : " FALLA") << endl;
+    }
+  }
+
+  return (fallas == 0) ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Tests of the DSP engines, without user interface.
+# make check builds and runs them; a failed test fails the build.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = precision
+TEMPLATE = app
+
+LIBS += -lfftw3 -lfftw3f -lpthread
+
+INCLUDEPATH += /usr/include $$PWD/..
+
+
+SOURCES += precision.cpp \
+    ../controlvolume.cpp \
+    ../sosbank.cpp \
+    ../partconvolver.cpp \
+    ../multiratebank.cpp \
+    ../banddesigner.cpp \
+    ../filterbank.cpp \
+    ../simdkernels.cpp \
+    ../rtguard.cpp \
+    ../rtpool.cpp \
+    ../reverbunit.cpp
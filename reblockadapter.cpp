@@ -0,0 +1,289 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   reblockadapter.cpp
+ *         Re-blocking adapter: runs a processor with an internal block size
+ *         that is independent of the period of the host.
+ *
+ * $Id: reblockadapter.cpp $
+ */
+
+#include "reblockadapter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+  /*
+   * Maximo comun divisor.
+   */
+  int mcd(int a,int b) {
+    while (b != 0) {
+      const int r = a % b;
+      a = b;
+      b = r;
+    }
+    return a;
+  }
+
+  /*
+   * Copia n muestras al anillo a partir de la posicion pos.
+   */
+  void escribirAnillo(float* anillo,unsigned long mascara,unsigned long pos,
+                      const float* x,int n) {
+    const int inicio = static_cast<int>(pos & mascara);
+    const int primero = std::min(n,static_cast<int>(mascara + 1) - inicio);
+    memcpy(anillo + inicio,x,sizeof(float)*primero);
+    memcpy(anillo,x + primero,sizeof(float)*(n - primero));
+  }
+
+  /*
+   * Copia n muestras del anillo a partir de la posicion pos.
+   */
+  void leerAnillo(const float* anillo,unsigned long mascara,unsigned long pos,
+                  float* y,int n) {
+    const int inicio = static_cast<int>(pos & mascara);
+    const int primero = std::min(n,static_cast<int>(mascara + 1) - inicio);
+    memcpy(y,anillo + inicio,sizeof(float)*primero);
+    memcpy(y + primero,anillo,sizeof(float)*(n - primero));
+  }
+}
+
+/*
+ * Constructor
+ */
+reblockAdapter::reblockAdapter(processorV2* proc,int blockSize,int channels)
+  : proc_(proc),pedido_(std::max(0,blockSize)),periodo_(0),bloque_(0),retardo_(0),
+    canales_(std::min(std::max(1,channels),int(MaxChannels))),iniciado_(false),
+    capacidad_(0),mascara_(0),leidoEntrada_(0),escritoEntrada_(0),
+    leidoSalida_(0),escritoSalida_(0),xrunPendiente_(false) {
+  for (int c=0;c<MaxChannels;++c) {
+    entrada_[c]=0;
+    salida_[c]=0;
+    trabajo_[c]=0;
+  }
+}
+
+/*
+ * Destructor
+ */
+reblockAdapter::~reblockAdapter() {
+  liberar();
+}
+
+void reblockAdapter::liberar() {
+  for (int c=0;c<MaxChannels;++c) {
+    delete[] entrada_[c];
+    delete[] salida_[c];
+    delete[] trabajo_[c];
+    entrada_[c]=0;
+    salida_[c]=0;
+    trabajo_[c]=0;
+  }
+  capacidad_=0;
+  mascara_=0;
+}
+
+bool reblockAdapter::setInternalBlockSize(const int blockSize) {
+  if (iniciado_ || (blockSize < 0)) {
+    return false;
+  }
+  pedido_=blockSize;
+  return true;
+}
+
+int reblockAdapter::internalBlockSize() const {
+  return bloque_;
+}
+
+int reblockAdapter::addedLatency() const {
+  return retardo_;
+}
+
+/*
+ * Calcula M y L para el periodo actual, ajusta los anillos y los vacia
+ */
+void reblockAdapter::configurar() {
+
+  bloque_ = (pedido_ > 0) ? pedido_ : periodo_;
+  retardo_ = bloque_ - mcd(periodo_,bloque_);
+
+  // En el anillo de entrada quedan a lo sumo M-1 muestras antes de agregar un
+  // periodo, y en el de salida a lo sumo L + M antes de agregar un bloque.
+  int capacidad = 1;
+  while (capacidad < retardo_ + periodo_ + 2*bloque_) {
+    capacidad *= 2;
+  }
+
+  if (capacidad != capacidad_) {
+    liberar();
+    for (int c=0;c<canales_;++c) {
+      entrada_[c] = new float[capacidad];
+      salida_[c] = new float[capacidad];
+      trabajo_[c] = new float[bloque_];
+    }
+    capacidad_ = capacidad;
+    mascara_ = static_cast<unsigned long>(capacidad - 1);
+  } else {
+    for (int c=0;c<canales_;++c) {
+      delete[] trabajo_[c];
+      trabajo_[c] = new float[bloque_];
+    }
+  }
+
+  // La salida inicia con L ceros.
+  for (int c=0;c<canales_;++c) {
+    memset(salida_[c],0,sizeof(float)*capacidad_);
+  }
+  leidoEntrada_ = 0;
+  escritoEntrada_ = 0;
+  leidoSalida_ = 0;
+  escritoSalida_ = static_cast<unsigned long>(retardo_);
+  xrunPendiente_ = false;
+}
+
+bool reblockAdapter::init(const int frameRate,const int bufferSize) {
+  periodo_ = bufferSize;
+  configurar();
+  iniciado_ = true;
+  return proc_->init(frameRate,bloque_);
+}
+
+/*
+ * Processing function
+ */
+bool reblockAdapter::process(float* const* in,
+                             float* const* out,
+                             const int channels,
+                             const int nframes,
+                             const bool inPlace,
+                             const processContext& context) {
+
+  const int usados = std::min(channels,canales_);
+  const int M = bloque_;
+
+  for (int c=usados;c<channels;++c) {
+    memset(out[c],0,sizeof(float)*nframes);
+  }
+
+  if ((M <= 0) || (usados <= 0)) {
+    for (int c=0;c<usados;++c) {
+      memset(out[c],0,sizeof(float)*nframes);
+    }
+    return false;
+  }
+
+  const bool xrun = context.xrun || xrunPendiente_;
+  processContext interno;
+  bool ok = true;
+
+  // Con los anillos vacios y un periodo multiplo de M, los bloques internos
+  // son partes de los buffers del anfitrion.
+  if ((escritoEntrada_ == leidoEntrada_) && (escritoSalida_ == leidoSalida_) &&
+      (nframes % M == 0)) {
+    float* subIn[MaxChannels];
+    float* subOut[MaxChannels];
+    for (int k=0;k<nframes;k+=M) {
+      for (int c=0;c<usados;++c) {
+        subIn[c] = in[c] + k;
+        subOut[c] = out[c] + k;
+      }
+      interno.frameTime = context.frameTime + k;
+      interno.xrun = xrun && (k == 0);
+      ok = proc_->process(subIn,subOut,usados,M,inPlace,interno) && ok;
+    }
+    xrunPendiente_ = false;
+    return ok;
+  }
+
+  // El periodo no puede exceder lo que cabe en los anillos.
+  const unsigned long enEntrada = escritoEntrada_ - leidoEntrada_;
+  if (enEntrada + nframes + M > static_cast<unsigned long>(capacidad_)) {
+    for (int c=0;c<usados;++c) {
+      memset(out[c],0,sizeof(float)*nframes);
+    }
+    return false;
+  }
+
+  // Toda la entrada se copia antes de escribir la salida, por lo que los
+  // periodos en sitio no necesitan nada especial.
+  for (int c=0;c<usados;++c) {
+    escribirAnillo(entrada_[c],mascara_,escritoEntrada_,in[c],nframes);
+  }
+  escritoEntrada_ += nframes;
+
+  // La primera muestra pendiente llego enEntrada muestras antes de este periodo.
+  const unsigned long primeraMuestra = context.frameTime - enEntrada;
+  const unsigned long primeraPosicion = leidoEntrada_;
+
+  bool avisado = false;
+  while (escritoEntrada_ - leidoEntrada_ >= static_cast<unsigned long>(M)) {
+    for (int c=0;c<usados;++c) {
+      leerAnillo(entrada_[c],mascara_,leidoEntrada_,trabajo_[c],M);
+    }
+    interno.frameTime = primeraMuestra + (leidoEntrada_ - primeraPosicion);
+    interno.xrun = xrun && !avisado;
+    avisado = true;
+    leidoEntrada_ += M;
+
+    ok = proc_->process(trabajo_,trabajo_,usados,M,true,interno) && ok;
+
+    for (int c=0;c<usados;++c) {
+      escribirAnillo(salida_[c],mascara_,escritoSalida_,trabajo_[c],M);
+    }
+    escritoSalida_ += M;
+  }
+  xrunPendiente_ = xrun && !avisado;
+
+  // Si el periodo es mas largo que el configurado puede faltar salida: se completa con ceros.
+  const int disponibles = static_cast<int>(std::min(static_cast<unsigned long>(nframes),
+                                                    escritoSalida_ - leidoSalida_));
+  for (int c=0;c<usados;++c) {
+    leerAnillo(salida_[c],mascara_,leidoSalida_,out[c],disponibles);
+    memset(out[c] + disponibles,0,sizeof(float)*(nframes - disponibles));
+  }
+  leidoSalida_ += disponibles;
+
+  return ok && (disponibles == nframes);
+}
+
+bool reblockAdapter::shutdown() {
+  return proc_->shutdown();
+}
+
+/*
+ * Set buffer size (call-back)
+ *
+ * Jack does not call process() while the period changes, so the rings can
+ * be rebuilt here.
+ */
+int reblockAdapter::setBufferSize(const int bufferSize) {
+  periodo_ = bufferSize;
+  configurar();
+  return proc_->setBufferSize(bloque_);
+}
+
+int reblockAdapter::setSampleRate(const int sampleRate) {
+  return proc_->setSampleRate(sampleRate);
+}
+
+int reblockAdapter::latency() const {
+  return proc_->latency() + retardo_;
+}
@@ -0,0 +1,155 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   reblockadapter.h
+ *         Re-blocking adapter: runs a processor with an internal block size
+ *         that is independent of the period of the host.
+ *
+ * $Id: reblockadapter.h $
+ */
+
+#ifndef REBLOCKADAPTER_H
+#define REBLOCKADAPTER_H
+
+#include "processorv2.h"
+
+/**
+ * Adaptador de tamano de bloque.
+ *
+ * Envuelve a un processorV2 que trabaja con bloques de M muestras mientras el
+ * anfitrion (jack) entrega periodos de N muestras. La entrada se acumula en
+ * un anillo por canal y cada vez que hay M muestras se procesa un bloque,
+ * cuya salida va a otro anillo del que se toman las N muestras del periodo.
+ * M puede ser mayor que N (bloques internos grandes en un servidor con
+ * periodos cortos) o menor (los parametros se actualizan mas seguido).
+ *
+ * Para que siempre haya N muestras de salida el anillo de salida inicia con
+ * L = M - mcd(N,M) ceros, que es la menor latencia posible; latency() la suma
+ * a la del procesador interno. Si N es multiplo de M la latencia es cero y
+ * los bloques internos se toman directamente de los buffers del anfitrion,
+ * sin copias.
+ *
+ * Los anillos se reservan en init() y setBufferSize(), nunca en process().
+ */
+class reblockAdapter : public processorV2 {
+public:
+
+  /**
+   * Constantes del adaptador.
+   */
+  enum {
+    MaxChannels=8 /**< Canales que puede tener un bloque. */
+  };
+
+  /**
+   * Constructor
+   * @param proc procesador envuelto (no pertenece al adaptador).
+   * @param blockSize tamano de bloque interno M; 0 usa el periodo del anfitrion.
+   * @param channels canales para los que se reservan anillos (a lo sumo MaxChannels).
+   */
+  reblockAdapter(processorV2* proc,int blockSize = 0,int channels = 2);
+
+  /**
+   * Destructor
+   */
+  virtual ~reblockAdapter();
+
+  /**
+   * @brief setInternalBlockSize Elige el tamano de bloque interno. Debe llamarse antes de init().
+   * @param blockSize tamano M; 0 usa el periodo del anfitrion.
+   * @return false si ya se llamo init() o el tamano es negativo.
+   */
+  bool setInternalBlockSize(const int blockSize);
+
+  /**
+   * Tamano de bloque interno efectivo M.
+   */
+  int internalBlockSize() const;
+
+  /**
+   * Latencia en muestras que agrega el adaptador, sin la del procesador interno.
+   */
+  int addedLatency() const;
+
+  virtual bool init(const int frameRate,const int bufferSize);
+  virtual bool process(float* const* in,
+                       float* const* out,
+                       const int channels,
+                       const int nframes,
+                       const bool inPlace,
+                       const processContext& context);
+  virtual bool shutdown();
+  virtual int setBufferSize(const int bufferSize);
+  virtual int setSampleRate(const int sampleRate);
+  virtual int latency() const;
+
+private:
+
+  /**
+   * @brief configurar Calcula M y L para el periodo actual, ajusta los anillos y los vacia.
+   */
+  void configurar();
+
+  /**
+   * @brief liberar Libera los anillos.
+   */
+  void liberar();
+
+  processorV2* proc_;
+
+  /**
+   * Tamano de bloque pedido (0: el del anfitrion), periodo del anfitrion,
+   * bloque interno efectivo M y latencia agregada L.
+   */
+  int pedido_;
+  int periodo_;
+  int bloque_;
+  int retardo_;
+
+  /**
+   * Canales con anillos e indica si ya se llamo init().
+   */
+  int canales_;
+  bool iniciado_;
+
+  /**
+   * Anillos de entrada y de salida, y bloque de trabajo, por canal. La
+   * capacidad es una potencia de dos; las posiciones son contadores que
+   * solo crecen y se reducen con mascara_.
+   */
+  float* entrada_[MaxChannels];
+  float* salida_[MaxChannels];
+  float* trabajo_[MaxChannels];
+  int capacidad_;
+  unsigned long mascara_;
+  unsigned long leidoEntrada_;
+  unsigned long escritoEntrada_;
+  unsigned long leidoSalida_;
+  unsigned long escritoSalida_;
+
+  /**
+   * Xrun que llego en un periodo sin bloques internos; se avisa en el siguiente bloque.
+   */
+  bool xrunPendiente_;
+
+  reblockAdapter(const reblockAdapter&);
+  reblockAdapter& operator=(const reblockAdapter&);
+};
+
+#endif // REBLOCKADAPTER_H
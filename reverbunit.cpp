@@ -0,0 +1,200 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   reverbunit.cpp
+ *         Feedback/feedforward delay reverberator on power-of-two ring
+ *         buffers, shared by controlVolume and the processing graph.
+ *
+ * $Id: reverbunit.cpp $
+ */
+
+#include "reverbunit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+  /*
+   * Magnitud bajo la cual las lineas de retardo se consideran nulas (-200 dB).
+   */
+  const float umbralReposo = 1e-10f;
+
+  /*
+   * Indice de la ultima de las n muestras con magnitud de al menos umbralReposo, o -1.
+   */
+  int ultimaActiva(const float* x,int n){
+    for(int i = n - 1; i >= 0; i--){
+      if(std::fabs(x[i]) >= umbralReposo){
+        return i;
+      }
+    }
+    return -1;
+  }
+}
+
+/*
+ * Constructor
+ */
+reverbUnit::reverbUnit(int canales)
+    :canales_(std::max(1,std::min(canales,int(MaxCanales)))),posicion_(0),quieta_(false),
+     retardoQuieto_(0),nucleos_(simdKernels::seleccionados()){
+
+    for(int c = 0; c < MaxCanales; c++){
+        entradas_[c] = (c < canales_) ? new float[Anillo] : 0;
+        salidas_[c] = (c < canales_) ? new float[Anillo] : 0;
+    }
+    reiniciar();
+}
+
+/*
+ * Destructor
+ */
+reverbUnit::~reverbUnit(){
+
+    for(int c = 0; c < MaxCanales; c++){
+        delete[] entradas_[c];
+        delete[] salidas_[c];
+    }
+}
+
+/**
+ * @brief reiniciar Anula las historias de todos los canales.
+ */
+void reverbUnit::reiniciar(){
+
+    for(int c = 0; c < canales_; c++){
+        memset(entradas_[c],0,sizeof(float)*Anillo);
+        memset(salidas_[c],0,sizeof(float)*Anillo);
+        reposadas_[c] = 0;
+    }
+    posicion_ = 0;
+    quieta_ = false;
+    retardoQuieto_ = 0;
+}
+
+/**
+ * @brief procesar Reverbera un bloque: y(n) = c*y(n - D) + a*x(n) + b*x(n - D) por canal.
+ * @param canales 1 o 2.
+ * @param in entrada de cada canal.
+ * @param out salida de cada canal; puede ser in.
+ * @param reposo indica que la entrada del bloque es nula.
+ */
+void reverbUnit::procesar(int canales, int blockSize, float* const* in, float* const* out, int aReverb, int dReverb, bool enabledReverb, int typeReverb, bool reposo){
+
+    // Los tres tipos tienen la forma y(n) = c*y(n - D) + a*x(n) + b*x(n - D).
+    const int D = std::max(1,std::min(dReverb,int(MaxRetardo)));
+    float ra = 1.0f, rb = 0.0f, rc = 0.0f;
+    if(enabledReverb){
+
+        float alpha = 0.01 * aReverb;
+        float beta = alpha * 0.75;
+        float mul = alpha * beta;
+
+        switch (typeReverb) {
+        case 1: // y(n) = x(n) + a y(n - D)
+            ra = 1.0f; rb = 0.0f; rc = alpha;
+            break;
+        case 2: // y(n) = x(n) + a * x(n - D) - a * B * x(n - D) + a * B * y(n - D)
+            ra = 1.0f; rb = alpha - mul; rc = mul;
+            break;
+        default: // caso 0: y(n) = - a * y(n - D) + a * x(n) + x(n - D)
+            ra = alpha; rb = 1.0f; rc = -alpha;
+            break;
+        }
+    }
+
+    canales = std::min(canales,canales_);
+    const unsigned int mascara = Anillo - 1;
+
+    // Con otro retardo las muestras que se leen son otras, por lo que se vuelve a revisar el reposo.
+    if(quieta_ && (D != retardoQuieto_)){
+        quieta_ = false;
+    }
+
+    // En reposo, con las lineas ya nulas, la salida es cero y a las lineas solo se agregan ceros.
+    if(reposo && quieta_){
+        for(int c = 0; c < canales; c++){
+            memset(out[c],0,sizeof(float)*blockSize);
+            for(int n = 0; n < blockSize;){
+                const unsigned int escribir = (posicion_ + n) & mascara;
+                const int largo = std::min(blockSize - n,int(Anillo - escribir));
+                memset(entradas_[c] + escribir,0,sizeof(float)*largo);
+                memset(salidas_[c] + escribir,0,sizeof(float)*largo);
+                n += largo;
+            }
+            reposadas_[c] = std::min(reposadas_[c] + blockSize,int(Anillo));
+        }
+        posicion_ += blockSize;
+        return;
+    }
+
+    // Cada tramo es contiguo en las dos lineas y, con el reverberador activo, de a lo sumo D
+    // muestras (ninguna salida depende de otra del mismo tramo) y de a lo sumo Anillo - D, de
+    // modo que lo que se escribe en la linea de entrada no alcanza a x(n - D). La entrada del
+    // tramo se copia a su linea antes de escribir la salida, que puede ser la misma entrada.
+    for(int c = 0; c < canales; c++){
+
+        const float* entrada = in[c];
+        float* salida = out[c];
+        float* lineaEntrada = entradas_[c];
+        float* lineaSalida = salidas_[c];
+
+        for(int n = 0; n < blockSize;){
+            const unsigned int escribir = (posicion_ + n) & mascara;
+            const unsigned int leer = (posicion_ + n - D) & mascara;
+            int largo = std::min(blockSize - n,int(Anillo - escribir));
+            if(enabledReverb){
+                largo = std::min(std::min(largo,D),std::min(int(Anillo - leer),int(Anillo) - D));
+            }
+
+            memcpy(lineaEntrada + escribir,entrada + n,sizeof(float)*largo);
+            if(enabledReverb){
+                nucleos_.combinar(entrada + n,lineaEntrada + leer,lineaSalida + leer,ra,rb,rc,salida + n,largo);
+            } else if(salida != entrada){
+                memcpy(salida + n,entrada + n,sizeof(float)*largo);
+            }
+            memcpy(lineaSalida + escribir,salida + n,sizeof(float)*largo);
+            n += largo;
+        }
+    }
+    posicion_ += blockSize;
+
+    // En reposo la cola decae con entrada nula. Se cuentan las muestras mas recientes de la
+    // salida que estan bajo umbralReposo (las de la entrada son nulas); cuando en todos los
+    // canales cubren el retardo, la cola ya no puede volver a superar el umbral.
+    if(!reposo){
+        quieta_ = false;
+        for(int c = 0; c < canales; c++){
+            reposadas_[c] = 0;
+        }
+        return;
+    }
+    bool quieta = true;
+    for(int c = 0; c < canales; c++){
+        const int ultima = ultimaActiva(out[c],blockSize);
+        reposadas_[c] = (ultima < 0) ? std::min(reposadas_[c] + blockSize,int(Anillo)) : blockSize - 1 - ultima;
+        quieta = quieta && (reposadas_[c] >= D);
+    }
+    if(quieta){
+        quieta_ = true;
+        retardoQuieto_ = D;
+    }
+}
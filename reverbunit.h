@@ -0,0 +1,136 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   reverbunit.h
+ *         Feedback/feedforward delay reverberator on power-of-two ring
+ *         buffers, shared by controlVolume and the processing graph.
+ *
+ * $Id: reverbunit.h $
+ */
+
+#ifndef REVERBUNIT_H
+#define REVERBUNIT_H
+
+#include "simdkernels.h"
+
+/**
+ * Reverberador de retardo.
+ *
+ * Los tres tipos de la interfaz tienen la forma
+ * \f[
+ * y(n) = c\,y(n-D) + a\,x(n) + b\,x(n-D)
+ * \f]
+ * con D a lo sumo MaxRetardo muestras (mas de cinco segundos a 48 kHz).
+ * Cada canal guarda su entrada y su salida en dos lineas de retardo
+ * circulares de Anillo muestras, potencia de dos, que se indexan con una
+ * mascara: cada bloque se agrega donde termino el anterior, sin desplazar
+ * la historia.
+ *
+ * El bloque se procesa por tramos de a lo sumo D muestras, en los que
+ * ninguna salida depende de otra del mismo tramo: con D mayor o igual al
+ * bloque es un solo tramo (dos si cruza el fin del anillo). Cada tramo se
+ * copia a la linea de entrada, se combina con simdKernels::combinar() y su
+ * salida se copia a la linea de salida. Como x(n - D) se lee siempre de la
+ * linea de entrada, out puede ser in.
+ *
+ * En reposo (bloques cuya entrada se sabe nula) la cola decae con entrada
+ * cero; cuando las ultimas D muestras de todas las lineas caen bajo
+ * -200 dB, los bloques siguientes en reposo son silencio y solo agregan
+ * ceros a las lineas, sin combinar nada.
+ *
+ * Un solo hilo debe llamar a procesar(). No se reserva memoria en procesar().
+ */
+class reverbUnit {
+public:
+
+    /**
+     * Constantes del reverberador.
+     */
+    enum {
+      MaxCanales=2,           /**< Canales con historia propia. */
+      Anillo=262144,          /**< Muestras de cada linea de retardo (potencia de dos). */
+      TramoMinimo=8192,       /**< Tramo mas corto con D = MaxRetardo, para que el tramo no alcance lo que lee. */
+      MaxRetardo=Anillo-TramoMinimo /**< Retardo maximo D en muestras. */
+    };
+
+    /**
+     * Constructor: las historias inician en cero.
+     * @param canales canales con historia propia (1 o 2); procesar() no acepta mas.
+     */
+    explicit reverbUnit(int canales = MaxCanales);
+
+    /**
+     * Destructor
+     */
+    ~reverbUnit();
+
+    /**
+     * @brief procesar Reverbera un bloque de cada canal.
+     * @param canales 1 o 2, a lo sumo los del constructor.
+     * @param blockSize muestras del bloque (cualquier tamano).
+     * @param in entrada de cada canal.
+     * @param out salida de cada canal; puede ser in.
+     * @param aReverb escalamiento, en centesimas.
+     * @param dReverb retardo D en muestras (de 1 a MaxRetardo).
+     * @param enabledReverb si es falso la salida es la entrada, pero las historias se actualizan.
+     * @param typeReverb tipo de la interfaz (0, 1 o 2).
+     * @param reposo indica que la entrada del bloque es nula (la salida del ecualizador es nula).
+     */
+    void procesar(int canales,int blockSize,float* const* in,float* const* out,int aReverb,
+                  int dReverb,bool enabledReverb,int typeReverb,bool reposo);
+
+    /**
+     * @brief reiniciar Anula las historias de todos los canales. Debe llamarse desde el hilo de procesar().
+     */
+    void reiniciar();
+
+private:
+
+    /**
+     * Lineas de retardo de la entrada y la salida de cada canal.
+     */
+    float* entradas_[MaxCanales];
+    float* salidas_[MaxCanales];
+    int canales_;
+
+    /**
+     * Posicion de las lineas donde se escribe la siguiente muestra (igual en todos los canales).
+     */
+    unsigned int posicion_;
+
+    /**
+     * Muestras mas recientes de las lineas de cada canal que estan bajo -200 dB, contadas
+     * solo en reposo (hasta Anillo).
+     */
+    int reposadas_[MaxCanales];
+
+    /**
+     * Indica que las ultimas D muestras de todas las lineas son nulas, de modo que un bloque
+     * en reposo es silencio; retardoQuieto_ es ese D.
+     */
+    bool quieta_;
+    int retardoQuieto_;
+
+    const simdKernels& nucleos_;
+
+    reverbUnit(const reverbUnit&);
+    reverbUnit& operator=(const reverbUnit&);
+};
+
+#endif // REVERBUNIT_H
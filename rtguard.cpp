@@ -0,0 +1,139 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   rtguard.cpp
+ *         Debug check that aborts when memory is allocated or released
+ *         inside the real-time callback.
+ *
+ * $Id: rtguard.cpp $
+ */
+
+#include "rtguard.h"
+
+#ifdef _DSP_RT_ALLOC_CHECK
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <unistd.h>
+
+/*
+ * Reservas de glibc. Las funciones de abajo reemplazan a las de la biblioteca
+ * en todo el proceso y les delegan el trabajo, de modo que malloc y free
+ * siguen usando el mismo asignador.
+ */
+extern "C" {
+  void* __libc_malloc(size_t n);
+  void* __libc_calloc(size_t n,size_t m);
+  void* __libc_realloc(void* p,size_t n);
+  void* __libc_memalign(size_t alineacion,size_t n);
+  void __libc_free(void* p);
+}
+
+namespace {
+
+  /*
+   * Profundidad de zonas de tiempo real del hilo. Es una variable __thread del
+   * ejecutable, por lo que leerla no reserva memoria.
+   */
+  __thread int zonas = 0;
+
+  /*
+   * Aborta si el hilo esta en una zona de tiempo real. Solo usa write(), que
+   * no reserva memoria.
+   */
+  inline void verificar(const char* funcion) {
+    if (zonas > 0) {
+      zonas = 0;
+      static const char msg[] = "rtGuard: reserva de memoria en el hilo de tiempo real: ";
+      ssize_t r = write(2,msg,sizeof(msg)-1);
+      const char* f = funcion;
+      while (*f != 0) {
+        ++f;
+      }
+      r = write(2,funcion,f-funcion);
+      r = write(2,"\n",1);
+      (void)r;
+      abort();
+    }
+  }
+}
+
+rtGuard::rtGuard() {
+  ++zonas;
+}
+
+rtGuard::~rtGuard() {
+  --zonas;
+}
+
+bool rtGuard::activo() {
+  return zonas > 0;
+}
+
+extern "C" {
+
+  void* malloc(size_t n) {
+    verificar("malloc");
+    return __libc_malloc(n);
+  }
+
+  void* calloc(size_t n,size_t m) {
+    verificar("calloc");
+    return __libc_calloc(n,m);
+  }
+
+  void* realloc(void* p,size_t n) {
+    verificar("realloc");
+    return __libc_realloc(p,n);
+  }
+
+  void free(void* p) {
+    if (p != 0) {
+      verificar("free");
+    }
+    __libc_free(p);
+  }
+
+  void* memalign(size_t alineacion,size_t n) {
+    verificar("memalign");
+    return __libc_memalign(alineacion,n);
+  }
+
+  void* aligned_alloc(size_t alineacion,size_t n) {
+    verificar("aligned_alloc");
+    return __libc_memalign(alineacion,n);
+  }
+
+  int posix_memalign(void** p,size_t alineacion,size_t n) {
+    verificar("posix_memalign");
+    if ((alineacion % sizeof(void*) != 0) || ((alineacion & (alineacion-1)) != 0)) {
+      return EINVAL;
+    }
+    void* q = __libc_memalign(alineacion,n);
+    if (q == 0) {
+      return ENOMEM;
+    }
+    *p = q;
+    return 0;
+  }
+
+}
+
+#endif // _DSP_RT_ALLOC_CHECK
@@ -0,0 +1,66 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   rtguard.h
+ *         Debug check that aborts when memory is allocated or released
+ *         inside the real-time callback.
+ *
+ * $Id: rtguard.h $
+ */
+
+#ifndef RTGUARD_H
+#define RTGUARD_H
+
+/**
+ * Marca una zona de tiempo real.
+ *
+ * Mientras exista un objeto rtGuard en un hilo, cualquier llamada a malloc,
+ * calloc, realloc, free o a las reservas alineadas (incluyendo new, delete y
+ * fftw_malloc) desde ese hilo aborta el programa con un mensaje. Solo tiene
+ * efecto si se compila con _DSP_RT_ALLOC_CHECK (qmake CONFIG+=rtcheck); en
+ * otro caso no hace nada y no cuesta nada.
+ */
+class rtGuard {
+public:
+#ifdef _DSP_RT_ALLOC_CHECK
+    /**
+     * Constructor: entra a la zona de tiempo real.
+     */
+    rtGuard();
+
+    /**
+     * Destructor: sale de la zona de tiempo real.
+     */
+    ~rtGuard();
+
+    /**
+     * Indica si el hilo actual esta dentro de una zona de tiempo real.
+     */
+    static bool activo();
+#else
+    rtGuard() {}
+    static bool activo() { return false; }
+#endif
+
+private:
+    rtGuard(const rtGuard&);
+    rtGuard& operator=(const rtGuard&);
+};
+
+#endif // RTGUARD_H
@@ -0,0 +1,245 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   rtpool.cpp
+ *         Fork-join worker pool for the real time thread: pinned workers
+ *         with work-stealing task queues that spin and then sleep on a
+ *         futex between periods.
+ *
+ * $Id: rtpool.cpp $
+ */
+
+#include "rtpool.h"
+#include "rtguard.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+  const unsigned long long mascaraIndice = 0xffffULL;
+}
+
+/*
+ * Constructor
+ */
+rtPool::rtPool()
+  : hilos_(0),funcion_(0),contexto_(0),pendientes_(0),rondas_(0),
+    terminar_(false) {
+  for (int i=0;i<MaxHilos;++i) {
+    trabajadores_[i]=0;
+  }
+  for (int i=0;i<=MaxHilos;++i) {
+    colas_[i].palabra.store(0);
+  }
+}
+
+/*
+ * Destructor
+ */
+rtPool::~rtPool() {
+  detener();
+}
+
+bool rtPool::iniciar(const int hilos,const int prioridad) {
+  detener();
+
+  const int nucleos = std::max(1u,std::thread::hardware_concurrency());
+  bool ok = true;
+
+  // El hilo que llama espera girando a los trabajadores que tomaron una tarea;
+  // si uno de ellos compartiera su nucleo con menor prioridad nunca terminaria.
+  const int cantidad = std::min(std::max(0,hilos),std::min(int(MaxHilos),nucleos - 1));
+  if (cantidad < hilos) {
+    std::cerr << "rtPool: " << nucleos << " nucleos, se usan " << cantidad
+              << " trabajadores" << std::endl;
+  }
+
+  terminar_.store(false);
+  for (int i=0;i<cantidad;++i) {
+    trabajadores_[i] = new std::thread(&rtPool::trabajar,this,i+1);
+    ++hilos_;
+
+    cpu_set_t nucleo;
+    CPU_ZERO(&nucleo);
+    CPU_SET(i+1,&nucleo);
+    if (pthread_setaffinity_np(trabajadores_[i]->native_handle(),sizeof(nucleo),&nucleo) != 0) {
+      std::cerr << "rtPool: no se pudo fijar el trabajador " << i+1
+                << " al nucleo " << i+1 << std::endl;
+      ok = false;
+    }
+
+    if (prioridad > 0) {
+      sched_param parametro;
+      parametro.sched_priority = prioridad;
+      if (pthread_setschedparam(trabajadores_[i]->native_handle(),SCHED_FIFO,&parametro) != 0) {
+        std::cerr << "rtPool: no se pudo usar SCHED_FIFO " << prioridad
+                  << " en el trabajador " << i+1 << std::endl;
+        ok = false;
+      }
+    }
+  }
+
+  return ok;
+}
+
+void rtPool::detener() {
+  if (hilos_ == 0) {
+    return;
+  }
+  terminar_.store(true);
+  ronda_.tocar();
+  for (int i=0;i<hilos_;++i) {
+    trabajadores_[i]->join();
+    delete trabajadores_[i];
+    trabajadores_[i]=0;
+  }
+  hilos_=0;
+}
+
+int rtPool::hilos() const {
+  return hilos_;
+}
+
+/*
+ * Fork-join de una ronda de tareas
+ */
+void rtPool::ejecutar(funcion f,void* contexto,const int cantidad) {
+  lanzar(f,contexto,cantidad,false);
+}
+
+void rtPool::ejecutarRepartido(funcion f,void* contexto,const int cantidad) {
+  lanzar(f,contexto,cantidad,true);
+}
+
+void rtPool::lanzar(funcion f,void* contexto,const int cantidad,const bool repartir) {
+
+  if ((hilos_ == 0) || (cantidad <= 1)) {
+    for (int i=0;i<cantidad;++i) {
+      f(contexto,i,0);
+    }
+    return;
+  }
+
+  // Las tareas de la ronda anterior ya terminaron, por lo que ningun
+  // trabajador lee funcion_ ni contexto_ mientras cambian.
+  const int repartidas = std::min(cantidad,int(MaxTareas));
+  funcion_ = f;
+  contexto_ = contexto;
+  pendientes_.store(repartidas,std::memory_order_relaxed);
+
+  // Cada cola lleva la ronda aunque quede vacia: asi la conoce su dueno.
+  rondas_ = (rondas_ + 1) & 0xffffffffULL;
+  const int participantes = hilos_ + 1;
+  for (int p=0;p<participantes;++p) {
+    const unsigned long long inicio = repartir ?
+      static_cast<unsigned long long>(p)*repartidas/participantes : (p == 0 ? 0 : repartidas);
+    const unsigned long long fin = repartir ?
+      static_cast<unsigned long long>(p + 1)*repartidas/participantes : repartidas;
+    colas_[p].palabra.store((rondas_ << 32) | (fin << 16) | inicio,std::memory_order_release);
+  }
+
+  ronda_.tocar();
+
+  tomarTareas(rondas_,0);
+  while (pendientes_.load(std::memory_order_acquire) != 0) {
+    spinFutex::pausa();
+  }
+
+  for (int i=repartidas;i<cantidad;++i) {
+    f(contexto,i,0);
+  }
+}
+
+/*
+ * Toma una tarea del inicio de la cola propia o del fin de una ajena
+ */
+bool rtPool::tomar(const unsigned long long ronda,const int cola,const bool propia,int& tarea) {
+
+  std::atomic<unsigned long long>& palabra = colas_[cola].palabra;
+  unsigned long long valor = palabra.load(std::memory_order_acquire);
+  for (;;) {
+    const int inicio = static_cast<int>(valor & mascaraIndice);
+    const int fin = static_cast<int>((valor >> 16) & mascaraIndice);
+    if (((valor >> 32) != ronda) || (inicio >= fin)) {
+      return false;
+    }
+    const unsigned long long nuevo = propia ? valor + 1 : valor - (1ULL << 16);
+    if (palabra.compare_exchange_weak(valor,nuevo,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+      tarea = propia ? inicio : fin - 1;
+      return true;
+    }
+  }
+}
+
+/*
+ * Toma tareas de una ronda hasta que no quede ninguna sin asignar
+ */
+void rtPool::tomarTareas(const unsigned long long ronda,const int hilo) {
+
+  const int participantes = hilos_ + 1;
+  int victima = hilo;
+  int tarea;
+  for (;;) {
+    // Las tareas propias se toman del inicio y las robadas del fin, de modo
+    // que dueno y ladron solo compiten por la ultima tarea de una cola.
+    if (!tomar(ronda,hilo,true,tarea)) {
+      // Se empieza por la ultima victima, que probablemente aun tiene tareas.
+      bool robada = false;
+      for (int k=0;(k<participantes) && !robada;++k) {
+        const int v = (victima + k) % participantes;
+        if ((v != hilo) && tomar(ronda,v,false,tarea)) {
+          victima = v;
+          robada = true;
+        }
+      }
+      if (!robada) {
+        return;
+      }
+    }
+
+    // La tarea tomada mantiene pendientes_ sobre cero, por lo que la ronda
+    // no puede terminar ni funcion_ cambiar hasta que se descuente.
+    funcion_(contexto_,tarea,hilo);
+    pendientes_.fetch_sub(1,std::memory_order_release);
+  }
+}
+
+/*
+ * Ciclo de un trabajador
+ */
+void rtPool::trabajar(const int hilo) {
+
+  int vista = ronda_.toques();
+  for (;;) {
+    ronda_.esperar(vista);
+    vista = ronda_.toques();
+
+    if (terminar_.load()) {
+      return;
+    }
+
+    rtGuard zona;
+    tomarTareas(colas_[hilo].palabra.load(std::memory_order_acquire) >> 32,hilo);
+  }
+}
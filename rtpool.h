@@ -0,0 +1,195 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   rtpool.h
+ *         Fork-join worker pool for the real time thread: pinned workers
+ *         with work-stealing task queues that spin and then sleep on a
+ *         futex between periods.
+ *
+ * $Id: rtpool.h $
+ */
+
+#ifndef RTPOOL_H
+#define RTPOOL_H
+
+#include "spinfutex.h"
+
+#include <atomic>
+#include <thread>
+
+/**
+ * Grupo de hilos trabajadores para repartir un bloque entre varios nucleos.
+ *
+ * ejecutar() reparte las tareas 0..cantidad-1 de una funcion entre los
+ * trabajadores y el hilo que llama, que tambien trabaja, y retorna cuando
+ * todas terminaron (fork-join).
+ *
+ * Cada participante (el hilo que llama y cada trabajador) tiene su propia
+ * cola de tareas: toma las suyas del inicio y, cuando se le acaban, roba del
+ * fin de las colas de los demas, de modo que una tarea larga no deja a los
+ * demas hilos sin trabajo. Las tareas de una ronda se conocen todas al
+ * empezar, por lo que cada cola es un rango [inicio,fin) en una sola palabra
+ * atomica que el dueno y los ladrones modifican con compare_exchange, sin
+ * candados. ejecutar() pone todas las tareas en la cola del hilo que llama,
+ * que empieza por la primera; ejecutarRepartido() da a cada participante un
+ * tramo contiguo, de modo que la misma tarea cae en el mismo hilo en cada
+ * periodo mientras no haga falta robar.
+ *
+ * Los hilos se crean en iniciar(), fuera del hilo de tiempo real, fijos cada
+ * uno a un nucleo y con prioridad SCHED_FIFO si el sistema lo permite. Entre
+ * bloques cada trabajador espera en un spinFutex, que gira unas vueltas y luego
+ * duerme; ejecutar() solo hace la llamada al sistema que los despierta si
+ * alguno esta dormido. El hilo que llama nunca duerme: espera girando a que
+ * terminen las tareas que tomaron los demas. En ejecutar() no se reserva
+ * memoria y las tareas corren dentro de un rtGuard.
+ *
+ * Un solo hilo puede llamar a ejecutar() a la vez.
+ */
+class rtPool {
+public:
+
+    /**
+     * Constantes del grupo.
+     */
+    enum {
+      MaxHilos=15,     /**< Trabajadores que puede tener el grupo, sin contar al hilo que llama. */
+      MaxTareas=65535  /**< Tareas que puede repartir una ronda; las demas las ejecuta el hilo que llama. */
+    };
+
+    /**
+     * Funcion de una tarea.
+     * @param contexto puntero que se paso a ejecutar().
+     * @param tarea indice de la tarea, de 0 a cantidad-1.
+     * @param hilo quien la ejecuta: 0 el hilo que llama y 1..hilos() los trabajadores.
+     */
+    typedef void (*funcion)(void* contexto,int tarea,int hilo);
+
+    /**
+     * Constructor: el grupo inicia sin trabajadores.
+     */
+    rtPool();
+
+    /**
+     * Destructor: detiene los trabajadores.
+     */
+    ~rtPool();
+
+    /**
+     * @brief iniciar Crea los trabajadores. Debe llamarse fuera del hilo de tiempo real.
+     * El trabajador i se fija al nucleo i+1, de modo que el nucleo 0 queda libre.
+     * @param hilos cantidad de trabajadores (a lo sumo MaxHilos y uno menos que los nucleos); 0 los detiene.
+     * @param prioridad prioridad SCHED_FIFO de los trabajadores; 0 los deja con la politica normal.
+     * @return false si no se pudo crear algun trabajador o fijar su prioridad (el grupo sigue
+     * funcionando con los que se crearon).
+     */
+    bool iniciar(int hilos,int prioridad);
+
+    /**
+     * @brief detener Termina y espera a los trabajadores.
+     */
+    void detener();
+
+    /**
+     * @brief hilos Cantidad de trabajadores, sin contar al hilo que llama.
+     */
+    int hilos() const;
+
+    /**
+     * @brief ejecutar Ejecuta las tareas 0..cantidad-1 de f y espera a que terminen.
+     * Sin trabajadores las ejecuta todas el hilo que llama, en orden.
+     * @param f funcion de cada tarea.
+     * @param contexto se pasa a cada tarea.
+     * @param cantidad cantidad de tareas (a lo sumo MaxTareas).
+     */
+    void ejecutar(funcion f,void* contexto,int cantidad);
+
+    /**
+     * @brief ejecutarRepartido Igual que ejecutar(), pero el participante p empieza con las tareas
+     * [p*cantidad/P, (p+1)*cantidad/P), con P = hilos()+1 y p = 0 el hilo que llama.
+     */
+    void ejecutarRepartido(funcion f,void* contexto,int cantidad);
+
+private:
+
+    /**
+     * @brief lanzar Publica una ronda, participa en ella y espera a que terminen todas sus tareas.
+     * @param repartir si es verdadero cada participante recibe un tramo; si no, todas van al hilo que llama.
+     */
+    void lanzar(funcion f,void* contexto,int cantidad,bool repartir);
+
+    /**
+     * @brief tomar Toma una tarea de una cola: del inicio si es la propia y del fin si se roba.
+     * @return false si la cola esta vacia o es de otra ronda.
+     */
+    bool tomar(unsigned long long ronda,int cola,bool propia,int& tarea);
+
+    /**
+     * @brief trabajar Ciclo de un trabajador.
+     */
+    void trabajar(int hilo);
+
+    /**
+     * @brief tomarTareas Ejecuta tareas de la ronda actual, primero de la propia cola y luego
+     * robadas, mientras queden.
+     * @param ronda ronda de la que se toman tareas.
+     * @param hilo indice de quien las ejecuta y de su cola.
+     */
+    void tomarTareas(unsigned long long ronda,int hilo);
+
+    std::thread* trabajadores_[MaxHilos];
+    int hilos_;
+
+    /**
+     * Funcion, contexto y tareas sin terminar de la ronda actual. Solo cambian
+     * entre rondas, cuando ninguna tarea puede estar en curso.
+     */
+    funcion funcion_;
+    void* contexto_;
+    std::atomic<int> pendientes_;
+
+    /**
+     * Cola de cada participante: ronda (32 bits), fin (16 bits) e inicio (16 bits) de las
+     * tareas que le quedan, en una sola palabra, de modo que un trabajador atrasado que
+     * aun ve una ronda anterior nunca toma una tarea de la actual. Cada cola ocupa su
+     * propia linea de cache.
+     */
+    struct Cola {
+      std::atomic<unsigned long long> palabra;
+      char relleno[64 - sizeof(std::atomic<unsigned long long>)];
+    };
+    Cola colas_[MaxHilos+1];
+
+    /**
+     * Ronda actual; solo la cambia el hilo que llama.
+     */
+    unsigned long long rondas_;
+
+    /**
+     * Timbre de los trabajadores: se toca en cada ronda. Los trabajadores
+     * esperan mientras tenga el valor que ya vieron.
+     */
+    spinFutex ronda_;
+
+    std::atomic<bool> terminar_;
+
+    rtPool(const rtPool&);
+    rtPool& operator=(const rtPool&);
+};
+
+#endif // RTPOOL_H
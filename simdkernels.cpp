@@ -0,0 +1,590 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   simdkernels.cpp
+ *         Vector kernels for the hot loops of the equalizer, selected at
+ *         run time from the instruction sets of the processor.
+ *
+ * $Id: simdkernels.cpp $
+ */
+
+#include "simdkernels.h"
+#include <cstdlib>
+#include <cstring>
+
+/*
+ * Las variantes vectoriales se compilan con atributos target de GCC/Clang,
+ * asi el resto del programa no necesita banderas especiales y el binario
+ * corre en cualquier procesador x86; solo se llaman si CPUID las reporta.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define _DSP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#define REAL 0
+#define IMAG 1
+
+namespace {
+
+  /*
+   * Referencia escalar.
+   */
+  namespace escalar {
+
+    void multiplicar(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      for (int k=0;k<n;++k) {
+        const double re = (x[k][REAL]*h[k][REAL]) - (x[k][IMAG]*h[k][IMAG]);
+        const double im = (x[k][IMAG]*h[k][REAL]) + (x[k][REAL]*h[k][IMAG]);
+        y[k][REAL] = re;
+        y[k][IMAG] = im;
+      }
+    }
+
+    void multiplicarAcumular(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      for (int k=0;k<n;++k) {
+        y[k][REAL] += (x[k][REAL]*h[k][REAL]) - (x[k][IMAG]*h[k][IMAG]);
+        y[k][IMAG] += (x[k][IMAG]*h[k][REAL]) + (x[k][REAL]*h[k][IMAG]);
+      }
+    }
+
+    void multiplicarF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      for (int k=0;k<n;++k) {
+        const float re = (x[k][REAL]*h[k][REAL]) - (x[k][IMAG]*h[k][IMAG]);
+        const float im = (x[k][IMAG]*h[k][REAL]) + (x[k][REAL]*h[k][IMAG]);
+        y[k][REAL] = re;
+        y[k][IMAG] = im;
+      }
+    }
+
+    void multiplicarAcumularF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      for (int k=0;k<n;++k) {
+        y[k][REAL] += (x[k][REAL]*h[k][REAL]) - (x[k][IMAG]*h[k][IMAG]);
+        y[k][IMAG] += (x[k][IMAG]*h[k][REAL]) + (x[k][REAL]*h[k][IMAG]);
+      }
+    }
+
+    void acumularEscalado(const double* x,double g,double* y,int n) {
+      for (int i=0;i<n;++i) {
+        y[i] += g*x[i];
+      }
+    }
+
+    void acumularEscaladoF(const float* x,float g,float* y,int n) {
+      for (int i=0;i<n;++i) {
+        y[i] += g*x[i];
+      }
+    }
+
+    void combinar(const float* x,const float* u,const float* v,float a,float b,float c,float* y,int n) {
+      for (int i=0;i<n;++i) {
+        y[i] = c*v[i] + a*x[i] + b*u[i];
+      }
+    }
+
+    void rampa(const float* x,float inicial,float paso,float* y,int n) {
+      for (int i=0;i<n;++i) {
+        y[i] = (inicial + static_cast<float>(i)*paso)*x[i];
+      }
+    }
+
+    float productoPunto(const float* x,const float* h,int n) {
+      float suma = 0.0f;
+      for (int i=0;i<n;++i) {
+        suma += x[i]*h[i];
+      }
+      return suma;
+    }
+  }
+
+#ifdef _DSP_SIMD_X86
+
+  /*
+   * SSE2: un termino complejo double, dos float o cuatro float reales por registro.
+   */
+  namespace sse2 {
+
+    __attribute__((target("sse2")))
+    inline __m128d producto(__m128d x,__m128d h) {
+      // [xr xi]*[hr hr] + [-xi xr]*[hi hi]
+      const __m128d signo = _mm_set_pd(0.0,-0.0);
+      const __m128d hr = _mm_unpacklo_pd(h,h);
+      const __m128d hi = _mm_unpackhi_pd(h,h);
+      const __m128d xs = _mm_xor_pd(_mm_shuffle_pd(x,x,1),signo);
+      return _mm_add_pd(_mm_mul_pd(x,hr),_mm_mul_pd(xs,hi));
+    }
+
+    __attribute__((target("sse2")))
+    void multiplicar(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      for (int k=0;k<n;++k) {
+        _mm_storeu_pd(y[k],producto(_mm_loadu_pd(x[k]),_mm_loadu_pd(h[k])));
+      }
+    }
+
+    __attribute__((target("sse2")))
+    void multiplicarAcumular(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      for (int k=0;k<n;++k) {
+        const __m128d p = producto(_mm_loadu_pd(x[k]),_mm_loadu_pd(h[k]));
+        _mm_storeu_pd(y[k],_mm_add_pd(_mm_loadu_pd(y[k]),p));
+      }
+    }
+
+    __attribute__((target("sse2")))
+    inline __m128 productoF(__m128 x,__m128 h) {
+      // dos terminos: [xr xi]*[hr hr] + [-xi xr]*[hi hi]
+      const __m128 signo = _mm_set_ps(0.0f,-0.0f,0.0f,-0.0f);
+      const __m128 hr = _mm_shuffle_ps(h,h,_MM_SHUFFLE(2,2,0,0));
+      const __m128 hi = _mm_shuffle_ps(h,h,_MM_SHUFFLE(3,3,1,1));
+      const __m128 xs = _mm_xor_ps(_mm_shuffle_ps(x,x,_MM_SHUFFLE(2,3,0,1)),signo);
+      return _mm_add_ps(_mm_mul_ps(x,hr),_mm_mul_ps(xs,hi));
+    }
+
+    __attribute__((target("sse2")))
+    void multiplicarF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      int k=0;
+      for (;k+2<=n;k+=2) {
+        _mm_storeu_ps(y[k],productoF(_mm_loadu_ps(x[k]),_mm_loadu_ps(h[k])));
+      }
+      escalar::multiplicarF(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("sse2")))
+    void multiplicarAcumularF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      int k=0;
+      for (;k+2<=n;k+=2) {
+        const __m128 p = productoF(_mm_loadu_ps(x[k]),_mm_loadu_ps(h[k]));
+        _mm_storeu_ps(y[k],_mm_add_ps(_mm_loadu_ps(y[k]),p));
+      }
+      escalar::multiplicarAcumularF(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("sse2")))
+    void acumularEscalado(const double* x,double g,double* y,int n) {
+      const __m128d vg = _mm_set1_pd(g);
+      int i=0;
+      for (;i+2<=n;i+=2) {
+        _mm_storeu_pd(y+i,_mm_add_pd(_mm_loadu_pd(y+i),_mm_mul_pd(vg,_mm_loadu_pd(x+i))));
+      }
+      escalar::acumularEscalado(x+i,g,y+i,n-i);
+    }
+
+    __attribute__((target("sse2")))
+    void acumularEscaladoF(const float* x,float g,float* y,int n) {
+      const __m128 vg = _mm_set1_ps(g);
+      int i=0;
+      for (;i+4<=n;i+=4) {
+        _mm_storeu_ps(y+i,_mm_add_ps(_mm_loadu_ps(y+i),_mm_mul_ps(vg,_mm_loadu_ps(x+i))));
+      }
+      escalar::acumularEscaladoF(x+i,g,y+i,n-i);
+    }
+
+    __attribute__((target("sse2")))
+    void combinar(const float* x,const float* u,const float* v,float a,float b,float c,float* y,int n) {
+      const __m128 va = _mm_set1_ps(a);
+      const __m128 vb = _mm_set1_ps(b);
+      const __m128 vc = _mm_set1_ps(c);
+      int i=0;
+      for (;i+4<=n;i+=4) {
+        __m128 s = _mm_add_ps(_mm_mul_ps(vc,_mm_loadu_ps(v+i)),_mm_mul_ps(va,_mm_loadu_ps(x+i)));
+        s = _mm_add_ps(s,_mm_mul_ps(vb,_mm_loadu_ps(u+i)));
+        _mm_storeu_ps(y+i,s);
+      }
+      escalar::combinar(x+i,u+i,v+i,a,b,c,y+i,n-i);
+    }
+
+    __attribute__((target("sse2")))
+    void rampa(const float* x,float inicial,float paso,float* y,int n) {
+      const __m128 vp = _mm_set1_ps(paso);
+      const __m128 vi = _mm_set1_ps(inicial);
+      __m128 indice = _mm_set_ps(3.0f,2.0f,1.0f,0.0f);
+      const __m128 cuatro = _mm_set1_ps(4.0f);
+      int i=0;
+      for (;i+4<=n;i+=4) {
+        const __m128 g = _mm_add_ps(vi,_mm_mul_ps(indice,vp));
+        _mm_storeu_ps(y+i,_mm_mul_ps(g,_mm_loadu_ps(x+i)));
+        indice = _mm_add_ps(indice,cuatro);
+      }
+      for (;i<n;++i) {
+        y[i] = (inicial + static_cast<float>(i)*paso)*x[i];
+      }
+    }
+
+    __attribute__((target("sse2")))
+    float productoPunto(const float* x,const float* h,int n) {
+      __m128 suma = _mm_setzero_ps();
+      int i=0;
+      for (;i+4<=n;i+=4) {
+        suma = _mm_add_ps(suma,_mm_mul_ps(_mm_loadu_ps(x+i),_mm_loadu_ps(h+i)));
+      }
+      suma = _mm_add_ps(suma,_mm_movehl_ps(suma,suma));
+      suma = _mm_add_ss(suma,_mm_shuffle_ps(suma,suma,1));
+      return _mm_cvtss_f32(suma) + escalar::productoPunto(x+i,h+i,n-i);
+    }
+  }
+
+  /*
+   * AVX2 y FMA: dos terminos complejos double, cuatro float u ocho float reales por registro.
+   */
+  namespace avx2 {
+
+    __attribute__((target("avx2,fma")))
+    inline __m256d producto(__m256d x,__m256d h) {
+      // pares: xr*hr - xi*hi, impares: xi*hr + xr*hi
+      const __m256d hr = _mm256_movedup_pd(h);
+      const __m256d hi = _mm256_permute_pd(h,0xF);
+      const __m256d xs = _mm256_permute_pd(x,0x5);
+      return _mm256_fmaddsub_pd(x,hr,_mm256_mul_pd(xs,hi));
+    }
+
+    __attribute__((target("avx2,fma")))
+    void multiplicar(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      int k=0;
+      for (;k+2<=n;k+=2) {
+        _mm256_storeu_pd(y[k],producto(_mm256_loadu_pd(x[k]),_mm256_loadu_pd(h[k])));
+      }
+      escalar::multiplicar(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void multiplicarAcumular(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      int k=0;
+      for (;k+2<=n;k+=2) {
+        const __m256d p = producto(_mm256_loadu_pd(x[k]),_mm256_loadu_pd(h[k]));
+        _mm256_storeu_pd(y[k],_mm256_add_pd(_mm256_loadu_pd(y[k]),p));
+      }
+      escalar::multiplicarAcumular(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256 productoF(__m256 x,__m256 h) {
+      const __m256 hr = _mm256_moveldup_ps(h);
+      const __m256 hi = _mm256_movehdup_ps(h);
+      const __m256 xs = _mm256_permute_ps(x,0xB1);
+      return _mm256_fmaddsub_ps(x,hr,_mm256_mul_ps(xs,hi));
+    }
+
+    __attribute__((target("avx2,fma")))
+    void multiplicarF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      int k=0;
+      for (;k+4<=n;k+=4) {
+        _mm256_storeu_ps(y[k],productoF(_mm256_loadu_ps(x[k]),_mm256_loadu_ps(h[k])));
+      }
+      escalar::multiplicarF(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void multiplicarAcumularF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      int k=0;
+      for (;k+4<=n;k+=4) {
+        const __m256 p = productoF(_mm256_loadu_ps(x[k]),_mm256_loadu_ps(h[k]));
+        _mm256_storeu_ps(y[k],_mm256_add_ps(_mm256_loadu_ps(y[k]),p));
+      }
+      escalar::multiplicarAcumularF(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void acumularEscalado(const double* x,double g,double* y,int n) {
+      const __m256d vg = _mm256_set1_pd(g);
+      int i=0;
+      for (;i+4<=n;i+=4) {
+        _mm256_storeu_pd(y+i,_mm256_fmadd_pd(vg,_mm256_loadu_pd(x+i),_mm256_loadu_pd(y+i)));
+      }
+      escalar::acumularEscalado(x+i,g,y+i,n-i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void acumularEscaladoF(const float* x,float g,float* y,int n) {
+      const __m256 vg = _mm256_set1_ps(g);
+      int i=0;
+      for (;i+8<=n;i+=8) {
+        _mm256_storeu_ps(y+i,_mm256_fmadd_ps(vg,_mm256_loadu_ps(x+i),_mm256_loadu_ps(y+i)));
+      }
+      escalar::acumularEscaladoF(x+i,g,y+i,n-i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void combinar(const float* x,const float* u,const float* v,float a,float b,float c,float* y,int n) {
+      const __m256 va = _mm256_set1_ps(a);
+      const __m256 vb = _mm256_set1_ps(b);
+      const __m256 vc = _mm256_set1_ps(c);
+      int i=0;
+      for (;i+8<=n;i+=8) {
+        __m256 s = _mm256_mul_ps(vc,_mm256_loadu_ps(v+i));
+        s = _mm256_fmadd_ps(va,_mm256_loadu_ps(x+i),s);
+        s = _mm256_fmadd_ps(vb,_mm256_loadu_ps(u+i),s);
+        _mm256_storeu_ps(y+i,s);
+      }
+      escalar::combinar(x+i,u+i,v+i,a,b,c,y+i,n-i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void rampa(const float* x,float inicial,float paso,float* y,int n) {
+      const __m256 vp = _mm256_set1_ps(paso);
+      const __m256 vi = _mm256_set1_ps(inicial);
+      __m256 indice = _mm256_set_ps(7.0f,6.0f,5.0f,4.0f,3.0f,2.0f,1.0f,0.0f);
+      const __m256 ocho = _mm256_set1_ps(8.0f);
+      int i=0;
+      for (;i+8<=n;i+=8) {
+        const __m256 g = _mm256_fmadd_ps(indice,vp,vi);
+        _mm256_storeu_ps(y+i,_mm256_mul_ps(g,_mm256_loadu_ps(x+i)));
+        indice = _mm256_add_ps(indice,ocho);
+      }
+      for (;i<n;++i) {
+        y[i] = (inicial + static_cast<float>(i)*paso)*x[i];
+      }
+    }
+
+    __attribute__((target("avx2,fma")))
+    float productoPunto(const float* x,const float* h,int n) {
+      // Dos acumuladores independientes para no esperar la latencia de cada FMA.
+      __m256 a = _mm256_setzero_ps();
+      __m256 b = _mm256_setzero_ps();
+      int i=0;
+      for (;i+16<=n;i+=16) {
+        a = _mm256_fmadd_ps(_mm256_loadu_ps(x+i),_mm256_loadu_ps(h+i),a);
+        b = _mm256_fmadd_ps(_mm256_loadu_ps(x+i+8),_mm256_loadu_ps(h+i+8),b);
+      }
+      for (;i+8<=n;i+=8) {
+        a = _mm256_fmadd_ps(_mm256_loadu_ps(x+i),_mm256_loadu_ps(h+i),a);
+      }
+      a = _mm256_add_ps(a,b);
+      __m128 suma = _mm_add_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1));
+      suma = _mm_add_ps(suma,_mm_movehl_ps(suma,suma));
+      suma = _mm_add_ss(suma,_mm_shuffle_ps(suma,suma,1));
+      return _mm_cvtss_f32(suma) + escalar::productoPunto(x+i,h+i,n-i);
+    }
+  }
+
+  /*
+   * AVX-512: cuatro terminos complejos double, ocho float o dieciseis float reales por registro.
+   */
+  namespace avx512 {
+
+    __attribute__((target("avx512f")))
+    inline __m512d producto(__m512d x,__m512d h) {
+      // Las formas con mascara completa evitan el aviso falso de GCC 12 sobre
+      // _mm512_undefined_pd en las formas sin mascara.
+      const __m512d hr = _mm512_mask_unpacklo_pd(h,0xFF,h,h);
+      const __m512d hi = _mm512_mask_unpackhi_pd(h,0xFF,h,h);
+      const __m512d xs = _mm512_mask_shuffle_pd(x,0xFF,x,x,0x55);
+      return _mm512_fmaddsub_pd(x,hr,_mm512_mul_pd(xs,hi));
+    }
+
+    __attribute__((target("avx512f")))
+    void multiplicar(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      int k=0;
+      for (;k+4<=n;k+=4) {
+        _mm512_storeu_pd(y[k],producto(_mm512_loadu_pd(x[k]),_mm512_loadu_pd(h[k])));
+      }
+      escalar::multiplicar(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx512f")))
+    void multiplicarAcumular(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n) {
+      int k=0;
+      for (;k+4<=n;k+=4) {
+        const __m512d p = producto(_mm512_loadu_pd(x[k]),_mm512_loadu_pd(h[k]));
+        _mm512_storeu_pd(y[k],_mm512_add_pd(_mm512_loadu_pd(y[k]),p));
+      }
+      escalar::multiplicarAcumular(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx512f")))
+    inline __m512 productoF(__m512 x,__m512 h) {
+      const __m512 hr = _mm512_mask_moveldup_ps(h,0xFFFF,h);
+      const __m512 hi = _mm512_mask_movehdup_ps(h,0xFFFF,h);
+      const __m512 xs = _mm512_mask_permute_ps(x,0xFFFF,x,0xB1);
+      return _mm512_fmaddsub_ps(x,hr,_mm512_mul_ps(xs,hi));
+    }
+
+    __attribute__((target("avx512f")))
+    void multiplicarF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      int k=0;
+      for (;k+8<=n;k+=8) {
+        _mm512_storeu_ps(y[k],productoF(_mm512_loadu_ps(x[k]),_mm512_loadu_ps(h[k])));
+      }
+      escalar::multiplicarF(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx512f")))
+    void multiplicarAcumularF(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n) {
+      int k=0;
+      for (;k+8<=n;k+=8) {
+        const __m512 p = productoF(_mm512_loadu_ps(x[k]),_mm512_loadu_ps(h[k]));
+        _mm512_storeu_ps(y[k],_mm512_add_ps(_mm512_loadu_ps(y[k]),p));
+      }
+      escalar::multiplicarAcumularF(x+k,h+k,y+k,n-k);
+    }
+
+    __attribute__((target("avx512f")))
+    void acumularEscalado(const double* x,double g,double* y,int n) {
+      const __m512d vg = _mm512_set1_pd(g);
+      int i=0;
+      for (;i+8<=n;i+=8) {
+        _mm512_storeu_pd(y+i,_mm512_fmadd_pd(vg,_mm512_loadu_pd(x+i),_mm512_loadu_pd(y+i)));
+      }
+      escalar::acumularEscalado(x+i,g,y+i,n-i);
+    }
+
+    __attribute__((target("avx512f")))
+    void acumularEscaladoF(const float* x,float g,float* y,int n) {
+      const __m512 vg = _mm512_set1_ps(g);
+      int i=0;
+      for (;i+16<=n;i+=16) {
+        _mm512_storeu_ps(y+i,_mm512_fmadd_ps(vg,_mm512_loadu_ps(x+i),_mm512_loadu_ps(y+i)));
+      }
+      escalar::acumularEscaladoF(x+i,g,y+i,n-i);
+    }
+
+    __attribute__((target("avx512f")))
+    void combinar(const float* x,const float* u,const float* v,float a,float b,float c,float* y,int n) {
+      const __m512 va = _mm512_set1_ps(a);
+      const __m512 vb = _mm512_set1_ps(b);
+      const __m512 vc = _mm512_set1_ps(c);
+      int i=0;
+      for (;i+16<=n;i+=16) {
+        __m512 s = _mm512_mul_ps(vc,_mm512_loadu_ps(v+i));
+        s = _mm512_fmadd_ps(va,_mm512_loadu_ps(x+i),s);
+        s = _mm512_fmadd_ps(vb,_mm512_loadu_ps(u+i),s);
+        _mm512_storeu_ps(y+i,s);
+      }
+      escalar::combinar(x+i,u+i,v+i,a,b,c,y+i,n-i);
+    }
+
+    __attribute__((target("avx512f")))
+    void rampa(const float* x,float inicial,float paso,float* y,int n) {
+      const __m512 vp = _mm512_set1_ps(paso);
+      const __m512 vi = _mm512_set1_ps(inicial);
+      __m512 indice = _mm512_set_ps(15.0f,14.0f,13.0f,12.0f,11.0f,10.0f,9.0f,8.0f,
+                                    7.0f,6.0f,5.0f,4.0f,3.0f,2.0f,1.0f,0.0f);
+      const __m512 dieciseis = _mm512_set1_ps(16.0f);
+      int i=0;
+      for (;i+16<=n;i+=16) {
+        const __m512 g = _mm512_fmadd_ps(indice,vp,vi);
+        _mm512_storeu_ps(y+i,_mm512_mul_ps(g,_mm512_loadu_ps(x+i)));
+        indice = _mm512_add_ps(indice,dieciseis);
+      }
+      for (;i<n;++i) {
+        y[i] = (inicial + static_cast<float>(i)*paso)*x[i];
+      }
+    }
+
+    __attribute__((target("avx512f")))
+    float productoPunto(const float* x,const float* h,int n) {
+      __m512 suma = _mm512_setzero_ps();
+      int i=0;
+      for (;i+16<=n;i+=16) {
+        suma = _mm512_fmadd_ps(_mm512_loadu_ps(x+i),_mm512_loadu_ps(h+i),suma);
+      }
+      // Se reduce a mano: _mm512_reduce_add_ps usa las extracciones sin
+      // mascara, con el mismo aviso falso de GCC 12 que en producto().
+      const __m512d mitades = _mm512_castps_pd(suma);
+      const __m256 a = _mm256_add_ps(
+        _mm256_castpd_ps(_mm512_mask_extractf64x4_pd(_mm256_setzero_pd(),0xF,mitades,0)),
+        _mm256_castpd_ps(_mm512_mask_extractf64x4_pd(_mm256_setzero_pd(),0xF,mitades,1)));
+      __m128 resto = _mm_add_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1));
+      resto = _mm_add_ps(resto,_mm_movehl_ps(resto,resto));
+      resto = _mm_add_ss(resto,_mm_shuffle_ps(resto,resto,1));
+      return _mm_cvtss_f32(resto) + escalar::productoPunto(x+i,h+i,n-i);
+    }
+  }
+
+#endif // _DSP_SIMD_X86
+
+  /*
+   * Tablas de cada conjunto de instrucciones, en el orden de simdKernels::Isa.
+   * Fuera de x86 solo existe la escalar.
+   */
+  const simdKernels tablas[simdKernels::NumIsas] = {
+    { simdKernels::Escalar,"escalar",
+      escalar::multiplicar,escalar::multiplicarAcumular,escalar::multiplicarF,escalar::multiplicarAcumularF,
+      escalar::acumularEscalado,
+      escalar::acumularEscaladoF,escalar::combinar,escalar::rampa,escalar::productoPunto },
+#ifdef _DSP_SIMD_X86
+    { simdKernels::SSE2,"SSE2",
+      sse2::multiplicar,sse2::multiplicarAcumular,sse2::multiplicarF,sse2::multiplicarAcumularF,
+      sse2::acumularEscalado,
+      sse2::acumularEscaladoF,sse2::combinar,sse2::rampa,sse2::productoPunto },
+    { simdKernels::AVX2,"AVX2+FMA",
+      avx2::multiplicar,avx2::multiplicarAcumular,avx2::multiplicarF,avx2::multiplicarAcumularF,
+      avx2::acumularEscalado,
+      avx2::acumularEscaladoF,avx2::combinar,avx2::rampa,avx2::productoPunto },
+    { simdKernels::AVX512,"AVX-512",
+      avx512::multiplicar,avx512::multiplicarAcumular,avx512::multiplicarF,avx512::multiplicarAcumularF,
+      avx512::acumularEscalado,
+      avx512::acumularEscaladoF,avx512::combinar,avx512::rampa,avx512::productoPunto }
+#endif
+  };
+
+  /*
+   * Elige la mejor tabla soportada, limitada por DSP_SIMD si esta definida.
+   */
+  const simdKernels* elegir() {
+    int limite = simdKernels::NumIsas-1;
+    const char* forzado = std::getenv("DSP_SIMD");
+    if (forzado != 0) {
+      for (int i=0;i<simdKernels::NumIsas;++i) {
+        const char* nombres[simdKernels::NumIsas] = {"escalar","sse2","avx2","avx512"};
+        if (std::strcmp(forzado,nombres[i]) == 0) {
+          limite = i;
+        }
+      }
+    }
+    for (int i=limite;i>simdKernels::Escalar;--i) {
+      if (simdKernels::soportado(static_cast<simdKernels::Isa>(i))) {
+        return &tablas[i];
+      }
+    }
+    return &tablas[simdKernels::Escalar];
+  }
+}
+
+bool simdKernels::soportado(Isa isa) {
+#ifdef _DSP_SIMD_X86
+  // __builtin_cpu_supports tambien verifica que el sistema operativo guarde
+  // los registros extendidos (XGETBV).
+  __builtin_cpu_init();
+  switch (isa) {
+  case Escalar:
+    return true;
+  case SSE2:
+    return __builtin_cpu_supports("sse2");
+  case AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case AVX512:
+    return __builtin_cpu_supports("avx512f");
+  default:
+    return false;
+  }
+#else
+  return isa == Escalar;
+#endif
+}
+
+const simdKernels& simdKernels::para(Isa isa) {
+  if ((isa < Escalar) || (isa >= NumIsas) || !soportado(isa)) {
+    return tablas[Escalar];
+  }
+  return tablas[isa];
+}
+
+const simdKernels& simdKernels::seleccionados() {
+  static const simdKernels* elegidos = elegir();
+  return *elegidos;
+}
@@ -0,0 +1,133 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   simdkernels.h
+ *         Vector kernels for the hot loops of the equalizer, selected at
+ *         run time from the instruction sets of the processor.
+ *
+ * $Id: simdkernels.h $
+ */
+
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <fftw3.h>
+
+/**
+ * Tabla de nucleos vectoriales.
+ *
+ * Hay una tabla por conjunto de instrucciones (escalar, SSE2, AVX2+FMA y
+ * AVX-512). seleccionados() elige una sola vez la mejor que soporta el
+ * procesador; la variable de ambiente DSP_SIMD (escalar, sse2, avx2, avx512)
+ * permite forzar una menor para comparar resultados. La version escalar es
+ * la referencia de las demas.
+ *
+ * Los arreglos pueden tener cualquier alineacion, pero los de fftw_malloc y
+ * los de la arena de controlVolume estan alineados y se recorren sin cruzar
+ * lineas de cache. Ningun nucleo reserva memoria.
+ */
+class simdKernels {
+public:
+
+  /**
+   * Conjuntos de instrucciones, de menor a mayor.
+   */
+  enum Isa {
+    Escalar=0,
+    SSE2,
+    AVX2,
+    AVX512,
+    NumIsas
+  };
+
+  /**
+   * @brief seleccionados Nucleos del mejor conjunto de instrucciones disponible.
+   *
+   * La deteccion se hace en la primera llamada, que debe ocurrir fuera del
+   * hilo de tiempo real (controlVolume la hace en su constructor).
+   */
+  static const simdKernels& seleccionados();
+
+  /**
+   * @brief para Nucleos de un conjunto de instrucciones dado, o los escalares si el procesador no lo soporta.
+   */
+  static const simdKernels& para(Isa isa);
+
+  /**
+   * @brief soportado Indica si el procesador y el sistema operativo soportan isa.
+   */
+  static bool soportado(Isa isa);
+
+  /**
+   * Conjunto de instrucciones de esta tabla.
+   */
+  Isa isa;
+
+  /**
+   * Nombre del conjunto de instrucciones, para reportarlo.
+   */
+  const char* nombre;
+
+  /**
+   * y(k) = x(k)h(k) para n terminos complejos. y puede ser x.
+   */
+  void (*multiplicar)(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n);
+
+  /**
+   * y(k) += x(k)h(k) para n terminos complejos.
+   */
+  void (*multiplicarAcumular)(const fftw_complex* x,const fftw_complex* h,fftw_complex* y,int n);
+
+  /**
+   * y(k) = x(k)h(k) para n terminos complejos float. y puede ser x.
+   */
+  void (*multiplicarF)(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n);
+
+  /**
+   * y(k) += x(k)h(k) para n terminos complejos float.
+   */
+  void (*multiplicarAcumularF)(const fftwf_complex* x,const fftwf_complex* h,fftwf_complex* y,int n);
+
+  /**
+   * y(i) += g*x(i) para n valores double.
+   */
+  void (*acumularEscalado)(const double* x,double g,double* y,int n);
+
+  /**
+   * y(i) += g*x(i) para n valores float.
+   */
+  void (*acumularEscaladoF)(const float* x,float g,float* y,int n);
+
+  /**
+   * y(i) = c*v(i) + a*x(i) + b*u(i) para n valores float. y puede ser x; no debe traslaparse con u ni v.
+   */
+  void (*combinar)(const float* x,const float* u,const float* v,float a,float b,float c,float* y,int n);
+
+  /**
+   * y(i) = (inicial + i*paso)*x(i) para n valores float. y puede ser x.
+   */
+  void (*rampa)(const float* x,float inicial,float paso,float* y,int n);
+
+  /**
+   * Retorna sum_i x(i)h(i) para n valores float.
+   */
+  float (*productoPunto)(const float* x,const float* h,int n);
+};
+
+#endif // SIMDKERNELS_H
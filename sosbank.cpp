@@ -0,0 +1,366 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   sosbank.cpp
+ *         Bank of IIR band filters in second-order sections, evaluated in the
+ *         time domain with all bands running in lockstep in SIMD lanes.
+ *
+ * $Id: sosbank.cpp $
+ */
+
+#include "sosbank.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Los ceros y polos se agrupan en long double: los polos de las bandas bajas
+// estan agrupados muy cerca de z=1.
+typedef sosBank::complejo complejo;
+
+namespace {
+
+  /*
+   * Operaciones sobre un registro de varias bandas. Con AVX caben 4 bandas
+   * en double, con SSE2 caben 2 y sin SIMD se procesa una banda a la vez.
+   */
+#if defined(__AVX__)
+  typedef __m256d vec;
+  enum { Ancho=4 };
+  inline vec vcargar(const double* p) { return _mm256_loadu_pd(p); }
+  inline void vguardar(double* p,vec v) { _mm256_storeu_pd(p,v); }
+  inline vec vdifundir(double x) { return _mm256_set1_pd(x); }
+  inline vec vsumar(vec a,vec b) { return _mm256_add_pd(a,b); }
+  inline vec vrestar(vec a,vec b) { return _mm256_sub_pd(a,b); }
+  inline vec vmult(vec a,vec b) { return _mm256_mul_pd(a,b); }
+  inline double vhorizontal(vec v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    lo = _mm_add_pd(lo,_mm256_extractf128_pd(v,1));
+    return _mm_cvtsd_f64(_mm_add_sd(lo,_mm_unpackhi_pd(lo,lo)));
+  }
+#elif defined(__SSE2__)
+  typedef __m128d vec;
+  enum { Ancho=2 };
+  inline vec vcargar(const double* p) { return _mm_loadu_pd(p); }
+  inline void vguardar(double* p,vec v) { _mm_storeu_pd(p,v); }
+  inline vec vdifundir(double x) { return _mm_set1_pd(x); }
+  inline vec vsumar(vec a,vec b) { return _mm_add_pd(a,b); }
+  inline vec vrestar(vec a,vec b) { return _mm_sub_pd(a,b); }
+  inline vec vmult(vec a,vec b) { return _mm_mul_pd(a,b); }
+  inline double vhorizontal(vec v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v,_mm_unpackhi_pd(v,v)));
+  }
+#else
+  typedef double vec;
+  enum { Ancho=1 };
+  inline vec vcargar(const double* p) { return *p; }
+  inline void vguardar(double* p,vec v) { *p = v; }
+  inline vec vdifundir(double x) { return x; }
+  inline vec vsumar(vec a,vec b) { return a+b; }
+  inline vec vrestar(vec a,vec b) { return a-b; }
+  inline vec vmult(vec a,vec b) { return a*b; }
+  inline double vhorizontal(vec v) { return v; }
+#endif
+
+  /*
+   * Los carriles se rellenan siempre a multiplos de 4 para que la distribucion
+   * en memoria no dependa del conjunto de instrucciones.
+   */
+  enum { AnchoMaximo=4 };
+
+  /*
+   * Agrupa n raices en n/2 pares: cada raiz compleja con su conjugada y las
+   * raices reales con la real mas cercana.
+   */
+  void emparejar(const complejo* r,int n,complejo (*pares)[2]) {
+    bool usada[sosBank::Orden] = {false};
+    for (int s=0;s<n/2;++s) {
+      int i=-1;
+      for (int k=0;k<n;++k) {
+        if (!usada[k] && ((i<0) || (std::abs(r[k].imag())>std::abs(r[i].imag())))) {
+          i=k;
+        }
+      }
+      usada[i]=true;
+      int j=-1;
+      for (int k=0;k<n;++k) {
+        if (!usada[k] && ((j<0) ||
+            (std::abs(r[k]-std::conj(r[i]))<std::abs(r[j]-std::conj(r[i]))))) {
+          j=k;
+        }
+      }
+      usada[j]=true;
+      pares[s][0]=r[i];
+      pares[s][1]=r[j];
+    }
+  }
+}
+
+/*
+ * Constructor
+ */
+sosBank::sosBank(int bandas)
+  : bandas_(bandas),acumulado_(0) {
+
+  carriles_ = ((bandas + AnchoMaximo - 1)/AnchoMaximo)*AnchoMaximo;
+
+  const int total = Secciones*carriles_;
+  b0_ = new double[total];
+  b1_ = new double[total];
+  b2_ = new double[total];
+  a1_ = new double[total];
+  a2_ = new double[total];
+  z1_ = new double[total];
+  z2_ = new double[total];
+  pesos_ = new double[carriles_];
+  acumulado_ = new double[Tramo];
+
+  // Los carriles de relleno quedan con coeficientes nulos y no aportan a la salida.
+  for (int i=0;i<total;++i) {
+    b0_[i]=b1_[i]=b2_[i]=a1_[i]=a2_[i]=0.0;
+  }
+  for (int i=0;i<carriles_;++i) {
+    pesos_[i]=0.0;
+  }
+  reiniciar();
+}
+
+/*
+ * Destructor
+ */
+sosBank::~sosBank() {
+  delete[] b0_;
+  delete[] b1_;
+  delete[] b2_;
+  delete[] a1_;
+  delete[] a2_;
+  delete[] z1_;
+  delete[] z2_;
+  delete[] pesos_;
+  delete[] acumulado_;
+}
+
+int sosBank::bandas() const {
+  return bandas_;
+}
+
+/**
+ * @brief respuestaImpulso Calcula h(n) de una banda evaluando sus secciones con un impulso unitario.
+ * @param banda indice de la banda.
+ * @param largo cantidad de muestras de h(n) a calcular.
+ * @param h arreglo de largo muestras donde se guarda la respuesta.
+ */
+void sosBank::respuestaImpulso(int banda,int largo,double* h) const {
+  double z1[Secciones] = {0.0};
+  double z2[Secciones] = {0.0};
+  for (int n=0;n<largo;++n) {
+    double u = (n==0) ? 1.0 : 0.0;
+    for (int s=0;s<Secciones;++s) {
+      const int idx = s*carriles_ + banda;
+      const double y = b0_[idx]*u + z1[s];
+      z1[s] = b1_[idx]*u - a1_[idx]*y + z2[s];
+      z2[s] = b2_[idx]*u - a2_[idx]*y;
+      u = y;
+    }
+    h[n] = u;
+  }
+}
+
+/**
+ * @brief anular Deja una banda con coeficientes nulos (no aporta a la salida).
+ * @param banda indice de la banda.
+ */
+void sosBank::anular(int banda) {
+  if ((banda<0) || (banda>=bandas_)) {
+    return;
+  }
+  for (int s=0;s<Secciones;++s) {
+    const int idx = s*carriles_ + banda;
+    b0_[idx]=b1_[idx]=b2_[idx]=a1_[idx]=a2_[idx]=0.0;
+    z1_[idx]=z2_[idx]=0.0;
+  }
+}
+
+void sosBank::reiniciar() {
+  for (int i=0;i<Secciones*carriles_;++i) {
+    z1_[i]=0.0;
+    z2_[i]=0.0;
+  }
+}
+
+/**
+ * @brief disenarZpk Agrupa ceros y polos de una banda en secciones de segundo orden.
+ * @param banda indice de la banda.
+ * @param ceros los Orden ceros en z (las raices complejas con su conjugada).
+ * @param polos los Orden polos en z.
+ * @param ganancia ganancia k de H(z)=k*prod(1-c_i z^-1)/prod(1-p_i z^-1).
+ * @return false si la banda no existe.
+ */
+bool sosBank::disenarZpk(int banda,const complejo* ceros,const complejo* polos,
+                         long double ganancia) {
+
+  if ((banda<0) || (banda>=bandas_)) {
+    return false;
+  }
+
+  complejo paresCeros[Secciones][2];
+  complejo paresPolos[Secciones][2];
+  emparejar(ceros,Orden,paresCeros);
+  emparejar(polos,Orden,paresPolos);
+
+  // Las secciones se ordenan de menor a mayor radio de polos, y a cada par de
+  // polos se le asigna el par de ceros mas cercano.
+  int orden[Secciones];
+  for (int s=0;s<Secciones;++s) {
+    orden[s]=s;
+  }
+  for (int s=0;s<Secciones;++s) {
+    for (int t=s+1;t<Secciones;++t) {
+      if (std::abs(paresPolos[orden[t]][0]) < std::abs(paresPolos[orden[s]][0])) {
+        std::swap(orden[s],orden[t]);
+      }
+    }
+  }
+
+  bool cerosUsados[Secciones] = {false};
+  int cerosDe[Secciones];
+  for (int s=Secciones-1;s>=0;--s) {
+    const complejo p=paresPolos[orden[s]][0];
+    int mejor=-1;
+    for (int c=0;c<Secciones;++c) {
+      if (!cerosUsados[c] &&
+          ((mejor<0) || (std::abs(paresCeros[c][0]-p)<std::abs(paresCeros[mejor][0]-p)))) {
+        mejor=c;
+      }
+    }
+    cerosUsados[mejor]=true;
+    cerosDe[s]=mejor;
+  }
+
+  // La ganancia se reparte en partes iguales entre las secciones.
+  const long double magnitud = std::pow(std::fabs(ganancia),1.0L/Secciones);
+
+  for (int s=0;s<Secciones;++s) {
+    const complejo* pc = paresCeros[cerosDe[s]];
+    const complejo* pp = paresPolos[orden[s]];
+    const long double k = (s==0 && ganancia<0.0L) ? -magnitud : magnitud;
+    const int idx = s*carriles_ + banda;
+
+    // (1 - r1 z^-1)(1 - r2 z^-1) = 1 - (r1+r2)z^-1 + r1 r2 z^-2
+    b0_[idx] = static_cast<double>(k);
+    b1_[idx] = static_cast<double>(-k*(pc[0]+pc[1]).real());
+    b2_[idx] = static_cast<double>(k*(pc[0]*pc[1]).real());
+    a1_[idx] = static_cast<double>(-(pp[0]+pp[1]).real());
+    a2_[idx] = static_cast<double>((pp[0]*pp[1]).real());
+  }
+
+  return true;
+}
+
+/**
+ * @brief filtrar Filtra un bloque por todas las bandas y suma sus salidas ponderadas.
+ * @param blockSize cantidad de muestras del bloque.
+ * @param in entrada del bloque.
+ * @param pesos ganancia de cada banda.
+ * @param out suma de las salidas ponderadas de todas las bandas.
+ * @param muestras si no es nulo, recibe la salida ponderada de cada banda en la muestra blockSize/2.
+ */
+void sosBank::filtrar(int blockSize,const float* in,const double* pesos,
+                      float* out,float* muestras) {
+
+#if defined(__SSE2__)
+  // Las colas de los filtros decaen hacia numeros subnormales, que son muy
+  // lentos; durante el bloque se tratan como cero.
+  const unsigned int csr = _mm_getcsr();
+  _mm_setcsr(csr | 0x8040); // FTZ | DAZ
+#endif
+
+  for (int i=0;i<bandas_;++i) {
+    pesos_[i]=pesos[i];
+  }
+
+  const int medio = blockSize/2;
+  double carril[Ancho];
+
+  // El bloque se recorre por tramos de Tramo muestras, asi el acumulador no
+  // depende del tamano de bloque y no hay que reservar memoria al cambiarlo.
+  for (int inicio=0;inicio<blockSize;inicio+=Tramo) {
+    const int largo = (blockSize-inicio < Tramo) ? blockSize-inicio : Tramo;
+    const float* x = in + inicio;
+
+    for (int n=0;n<largo;++n) {
+      acumulado_[n]=0.0;
+    }
+
+    for (int v=0;v<carriles_;v+=Ancho) {
+
+      vec b0[Secciones],b1[Secciones],b2[Secciones],a1[Secciones],a2[Secciones];
+      vec z1[Secciones],z2[Secciones];
+      for (int s=0;s<Secciones;++s) {
+        const int idx = s*carriles_ + v;
+        b0[s]=vcargar(b0_+idx);
+        b1[s]=vcargar(b1_+idx);
+        b2[s]=vcargar(b2_+idx);
+        a1[s]=vcargar(a1_+idx);
+        a2[s]=vcargar(a2_+idx);
+        z1[s]=vcargar(z1_+idx);
+        z2[s]=vcargar(z2_+idx);
+      }
+      const vec w = vcargar(pesos_+v);
+
+      for (int n=0;n<largo;++n) {
+        vec u = vdifundir(x[n]);
+        for (int s=0;s<Secciones;++s) {
+          // Forma directa II transpuesta
+          const vec y = vsumar(vmult(b0[s],u),z1[s]);
+          z1[s] = vsumar(vrestar(vmult(b1[s],u),vmult(a1[s],y)),z2[s]);
+          z2[s] = vrestar(vmult(b2[s],u),vmult(a2[s],y));
+          u = y;
+        }
+        const vec p = vmult(u,w);
+        acumulado_[n] += vhorizontal(p);
+
+        if ((muestras != 0) && (inicio+n == medio)) {
+          vguardar(carril,p);
+          for (int i=0;(i<Ancho) && (v+i<bandas_);++i) {
+            muestras[v+i] = static_cast<float>(carril[i]);
+          }
+        }
+      }
+
+      for (int s=0;s<Secciones;++s) {
+        const int idx = s*carriles_ + v;
+        vguardar(z1_+idx,z1[s]);
+        vguardar(z2_+idx,z2[s]);
+      }
+    }
+
+    for (int n=0;n<largo;++n) {
+      out[inicio+n] = static_cast<float>(acumulado_[n]);
+    }
+  }
+
+#if defined(__SSE2__)
+  _mm_setcsr(csr);
+#endif
+}
@@ -0,0 +1,152 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   sosbank.h
+ *         Bank of IIR band filters in second-order sections, evaluated in the
+ *         time domain with all bands running in lockstep in SIMD lanes.
+ *
+ * $Id: sosbank.h $
+ */
+
+#ifndef SOSBANK_H
+#define SOSBANK_H
+
+#include <complex>
+
+/**
+ * Banco de filtros IIR en secciones de segundo orden.
+ *
+ * Cada banda de orden 6 se factoriza en tres secciones
+ * \f[
+ * H_s(z)=\frac{b_0+b_1z^{-1}+b_2z^{-2}}{1+a_1z^{-1}+a_2z^{-2}}
+ * \f]
+ * que se evaluan en forma directa II transpuesta. Los coeficientes y estados
+ * se guardan como estructura de arreglos: el elemento [s*carriles+i] pertenece
+ * a la seccion s de la banda i, de modo que cada registro SIMD procesa varias
+ * bandas a la vez. No hay latencia algoritmica: y(n) depende de x(n).
+ */
+class sosBank {
+public:
+
+    /**
+     * Constantes del banco.
+     */
+    enum {
+      Secciones=3, /**< Secciones de segundo orden por banda (orden 6). */
+      Orden=6,     /**< Orden de la ecuacion de diferencias de cada banda. */
+      Tramo=256    /**< Muestras que se acumulan a la vez; los bloques se procesan por tramos. */
+    };
+
+    /**
+     * Raices en z. Se manejan en long double: los polos de las bandas bajas estan
+     * agrupados muy cerca de z=1.
+     */
+    typedef std::complex<long double> complejo;
+
+    /**
+     * Constructor
+     * @param bandas cantidad de bandas del banco.
+     */
+    sosBank(int bandas);
+
+    /**
+     * Destructor
+     */
+    ~sosBank();
+
+    /**
+     * @brief disenarZpk Agrupa ceros y polos de una banda en secciones de segundo orden.
+     * @param banda indice de la banda.
+     * @param ceros los Orden ceros en z (las raices complejas con su conjugada).
+     * @param polos los Orden polos en z.
+     * @param ganancia ganancia k de H(z)=k*prod(1-c_i z^-1)/prod(1-p_i z^-1).
+     * @return false si la banda no existe.
+     */
+    bool disenarZpk(int banda,const complejo* ceros,const complejo* polos,
+                    long double ganancia);
+
+    /**
+     * @brief anular Deja una banda con coeficientes nulos (no aporta a la salida).
+     * @param banda indice de la banda.
+     */
+    void anular(int banda);
+
+    /**
+     * @brief respuestaImpulso Calcula h(n) de una banda evaluando sus secciones con un impulso unitario.
+     * @param banda indice de la banda.
+     * @param largo cantidad de muestras de h(n) a calcular.
+     * @param h arreglo de largo muestras donde se guarda la respuesta.
+     */
+    void respuestaImpulso(int banda,int largo,double* h) const;
+
+    /**
+     * @brief reiniciar Pone en cero el estado de todas las secciones.
+     */
+    void reiniciar();
+
+    /**
+     * @brief filtrar Filtra un bloque por todas las bandas y suma sus salidas ponderadas.
+     * @param blockSize cantidad de muestras del bloque (cualquier tamano).
+     * @param in entrada del bloque.
+     * @param pesos ganancia de cada banda.
+     * @param out suma de las salidas ponderadas de todas las bandas.
+     * @param muestras si no es nulo, recibe la salida ponderada de cada banda en la muestra blockSize/2.
+     */
+    void filtrar(int blockSize,const float* in,const double* pesos,
+                 float* out,float* muestras);
+
+    /**
+     * Cantidad de bandas del banco.
+     */
+    int bandas() const;
+
+private:
+
+    /**
+     * Cantidad de bandas y de carriles (bandas rellenadas a un multiplo del ancho SIMD).
+     */
+    int bandas_;
+    int carriles_;
+
+    /**
+     * Coeficientes de cada seccion, [Secciones*carriles_].
+     */
+    double* b0_;
+    double* b1_;
+    double* b2_;
+    double* a1_;
+    double* a2_;
+
+    /**
+     * Estados de la forma directa II transpuesta, [Secciones*carriles_].
+     */
+    double* z1_;
+    double* z2_;
+
+    /**
+     * Pesos por carril y acumulador de la suma de las bandas, de Tramo muestras.
+     */
+    double* pesos_;
+    double* acumulado_;
+
+    sosBank(const sosBank&);
+    sosBank& operator=(const sosBank&);
+};
+
+#endif // SOSBANK_H
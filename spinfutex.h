@@ -0,0 +1,131 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   spinfutex.h
+ *         Wakeup word for the real time helper threads: waiters spin for a
+ *         while and then sleep on a futex.
+ *
+ * $Id: spinfutex.h $
+ */
+
+#ifndef SPINFUTEX_H
+#define SPINFUTEX_H
+
+#include <atomic>
+#include <climits>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Timbre para despertar a un hilo que espera trabajo.
+ *
+ * toques() cambia con cada tocar(). esperar() retorna en cuanto toques() deja
+ * de valer lo que el hilo ya vio: gira unas Giros vueltas y luego duerme en un
+ * futex sobre la misma palabra. tocar() solo hace la llamada al sistema que
+ * despierta si alguien esta dormido, por lo que quien avisa nunca entra al
+ * kernel mientras los que esperan siguen girando.
+ *
+ * Lo usan rtPool, para publicar cada ronda de tareas, y stagePipeline, para
+ * avisar a cada etapa de una entrega.
+ */
+class spinFutex {
+public:
+
+    /**
+     * Constantes de la espera.
+     */
+    enum {
+      Giros=4096 /**< Vueltas que gira esperar() antes de dormir en el futex. */
+    };
+
+    /**
+     * Constructor: nadie ha tocado ni duerme.
+     */
+    spinFutex() : toques_(0),dormidos_(0) {
+      static_assert(sizeof(std::atomic<int>) == sizeof(int),"el futex usa la palabra de toques_");
+    }
+
+    /**
+     * @brief pausa Pausa de una vuelta de espera activa: libera recursos del nucleo para el
+     * otro hilo del mismo nucleo fisico.
+     */
+    static inline void pausa() {
+#if defined(__x86_64__) || defined(__i386__)
+      _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      __asm__ __volatile__("yield");
+#endif
+    }
+
+    /**
+     * @brief toques Valor actual de la palabra; se lee antes de revisar si hay trabajo, de modo
+     * que un aviso posterior a la revision hace retornar a esperar().
+     */
+    inline int toques() const {
+      return toques_.load();
+    }
+
+    /**
+     * @brief tocar Cambia la palabra y despierta a los dormidos, si hay alguno.
+     */
+    inline void tocar() {
+      // Un hilo que aumento dormidos_ despues de esta lectura ve el cambio de
+      // toques_ en el futex y no duerme.
+      toques_.fetch_add(1);
+      if (dormidos_.load() > 0) {
+        syscall(SYS_futex,reinterpret_cast<int*>(&toques_),FUTEX_WAKE_PRIVATE,INT_MAX,0,0,0);
+      }
+    }
+
+    /**
+     * @brief esperar Espera a que toques() deje de valer vista: gira Giros vueltas y luego
+     * duerme en el futex. Retorna de inmediato si ya cambio.
+     */
+    inline void esperar(const int vista) {
+      int giros = 0;
+      while ((toques_.load(std::memory_order_acquire) == vista) && (giros < Giros)) {
+        pausa();
+        ++giros;
+      }
+      while (toques_.load() == vista) {
+        dormidos_.fetch_add(1);
+        syscall(SYS_futex,reinterpret_cast<int*>(&toques_),FUTEX_WAIT_PRIVATE,vista,0,0,0);
+        dormidos_.fetch_sub(1);
+      }
+    }
+
+private:
+
+    /**
+     * Palabra del futex y cantidad de hilos dormidos (o a punto de dormir) en ella.
+     */
+    std::atomic<int> toques_;
+    std::atomic<int> dormidos_;
+
+    spinFutex(const spinFutex&);
+    spinFutex& operator=(const spinFutex&);
+};
+
+#endif // SPINFUTEX_H
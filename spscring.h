@@ -0,0 +1,129 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   spscring.h
+ *         Lock-free ring that passes values from one producer thread to one
+ *         consumer thread.
+ *
+ * $Id: spscring.h $
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+
+/**
+ * Anillo sin bloqueos para un productor y un consumidor.
+ *
+ * Guarda hasta capacidad() valores de T en un arreglo de potencia de dos. El
+ * productor solo escribe escritos_ y el consumidor solo leidos_, cada uno en
+ * su propia linea de cache; ninguno espera al otro: poner() falla si el
+ * anillo esta lleno y sacar() si esta vacio. Para pasar buffers grandes T es
+ * un puntero, de modo que los datos no se copian.
+ *
+ * La memoria se reserva en el constructor; poner() y sacar() no reservan.
+ */
+template<typename T>
+class spscRing {
+public:
+
+    /**
+     * Constructor
+     * @param capacidad cantidad minima de valores; se redondea a una potencia de dos.
+     */
+    explicit spscRing(int capacidad)
+      : mascara_(1),valores_(0),escritos_(0),leidos_(0) {
+      while (mascara_ < static_cast<unsigned long>(capacidad)) {
+        mascara_ <<= 1;
+      }
+      valores_ = new T[mascara_];
+      --mascara_;
+    }
+
+    /**
+     * Destructor
+     */
+    ~spscRing() {
+      delete[] valores_;
+    }
+
+    /**
+     * @brief capacidad Cantidad de valores que caben en el anillo.
+     */
+    int capacidad() const {
+      return static_cast<int>(mascara_ + 1);
+    }
+
+    /**
+     * @brief poner Agrega un valor al final (solo el productor).
+     * @return false si el anillo esta lleno.
+     */
+    bool poner(const T& valor) {
+      const unsigned long escritos = escritos_.load(std::memory_order_relaxed);
+      if (escritos - leidos_.load(std::memory_order_acquire) > mascara_) {
+        return false;
+      }
+      valores_[escritos & mascara_] = valor;
+      escritos_.store(escritos + 1,std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief sacar Quita el valor mas antiguo (solo el consumidor).
+     * @return false si el anillo esta vacio.
+     */
+    bool sacar(T& valor) {
+      const unsigned long leidos = leidos_.load(std::memory_order_relaxed);
+      if (escritos_.load(std::memory_order_acquire) == leidos) {
+        return false;
+      }
+      valor = valores_[leidos & mascara_];
+      leidos_.store(leidos + 1,std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief vacio Indica si no hay valores; desde el productor puede estar desactualizado.
+     */
+    bool vacio() const {
+      return escritos_.load(std::memory_order_acquire) == leidos_.load(std::memory_order_acquire);
+    }
+
+private:
+
+    unsigned long mascara_;
+    T* valores_;
+
+    /**
+     * Valores agregados y quitados desde el inicio. Solo los escribe su lado.
+     * Los rellenos dejan al menos una linea de cache entre cada contador y lo
+     * que lo rodea, sin depender de la alineacion con que se reservo el anillo.
+     */
+    char rellenoValores_[64];
+    std::atomic<unsigned long> escritos_;
+    char rellenoEscritos_[64 - sizeof(std::atomic<unsigned long>)];
+    std::atomic<unsigned long> leidos_;
+    char rellenoLeidos_[64 - sizeof(std::atomic<unsigned long>)];
+
+    spscRing(const spscRing&);
+    spscRing& operator=(const spscRing&);
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,259 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   stagepipeline.cpp
+ *         Pipelined processing: the equalizer and the reverberation run
+ *         each on its own core, some periods behind jack.
+ *
+ * $Id: stagepipeline.cpp $
+ */
+
+#include "stagepipeline.h"
+#include "rtguard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <pthread.h>
+#include <sched.h>
+
+/*
+ * Constructor
+ */
+stagePipeline::stagePipeline(controlVolume* cv,const int periodos)
+  : cv_(cv),periodos_(std::max(1,std::min(periodos,int(MaxPeriodos)))),
+    bloques_(0),cantidad_(0),cantidadLibres_(0),siguiente_(0),
+    llamadas_(0),reinicioPendiente_(false),
+    aEcualizador_(MaxPeriodos+2),aReverberacion_(MaxPeriodos+2),aJack_(MaxPeriodos+2),
+    atrasos_(0),terminar_(false) {
+
+  // En cada momento hay periodos_ bloques esperando su turno de salida, uno
+  // que entra y uno de holgura para una etapa atrasada.
+  cantidad_ = periodos_ + 2;
+  bloques_ = new Periodo[cantidad_];
+  for (int i=0;i<cantidad_;++i) {
+    for (int c=0;c<controlVolume::MaxCanales;++c) {
+      bloques_[i].entrada[c] = new float[MaxBloque];
+      bloques_[i].ecualizada[c] = new float[MaxBloque];
+    }
+    libres_[cantidadLibres_++] = &bloques_[i];
+  }
+
+  for (int i=0;i<Etapas;++i) {
+    hilos_[i]=0;
+  }
+}
+
+/*
+ * Destructor
+ */
+stagePipeline::~stagePipeline() {
+  detener();
+  for (int i=0;i<cantidad_;++i) {
+    for (int c=0;c<controlVolume::MaxCanales;++c) {
+      delete[] bloques_[i].entrada[c];
+      delete[] bloques_[i].ecualizada[c];
+    }
+  }
+  delete[] bloques_;
+}
+
+bool stagePipeline::iniciar(const int primerNucleo,const int prioridad) {
+  detener();
+
+  terminar_.store(false);
+  hilos_[0] = new std::thread(&stagePipeline::ecualizador,this);
+  hilos_[1] = new std::thread(&stagePipeline::reverberacion,this);
+
+  bool ok = true;
+  for (int i=0;i<Etapas;++i) {
+    const int nucleo = primerNucleo + i;
+
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    CPU_SET(nucleo,&conjunto);
+    if (pthread_setaffinity_np(hilos_[i]->native_handle(),sizeof(conjunto),&conjunto) != 0) {
+      std::cerr << "stagePipeline: no se pudo fijar la etapa " << i
+                << " al nucleo " << nucleo << std::endl;
+      ok = false;
+    }
+
+    if (prioridad > 0) {
+      sched_param parametro;
+      parametro.sched_priority = prioridad;
+      if (pthread_setschedparam(hilos_[i]->native_handle(),SCHED_FIFO,&parametro) != 0) {
+        std::cerr << "stagePipeline: no se pudo usar SCHED_FIFO " << prioridad
+                  << " en la etapa " << i << std::endl;
+        ok = false;
+      }
+    }
+  }
+
+  return ok;
+}
+
+void stagePipeline::detener() {
+  if (hilos_[0] == 0) {
+    return;
+  }
+  terminar_.store(true);
+  timbreEcualizador_.tocar();
+  timbreReverberacion_.tocar();
+  for (int i=0;i<Etapas;++i) {
+    hilos_[i]->join();
+    delete hilos_[i];
+    hilos_[i]=0;
+  }
+}
+
+int stagePipeline::periodos() const {
+  return periodos_;
+}
+
+unsigned long stagePipeline::atrasos() const {
+  return atrasos_.load();
+}
+
+/*
+ * Espera de una etapa: toques() se lee antes de revisar el anillo, por lo que
+ * una entrega posterior cambia su valor y la espera retorna.
+ */
+bool stagePipeline::esperar(spscRing<Periodo*>& anillo,spinFutex& timbre,Periodo*& periodo) {
+  for (;;) {
+    const int vista = timbre.toques();
+    if (terminar_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    if (anillo.sacar(periodo)) {
+      return true;
+    }
+    timbre.esperar(vista);
+  }
+}
+
+/*
+ * Entrada y salida de la tuberia en el hilo de jack
+ */
+void stagePipeline::procesar(const Parametros& p,const bool reiniciar,float* const* in,
+                             float* const* out,int canales,const int blockSize,
+                             struct Spectral* spectral) {
+
+  canales = std::max(1,std::min(canales,int(controlVolume::MaxCanales)));
+
+  // Un pedido de reinicio no se pierde aunque su bloque no pueda entrar.
+  reinicioPendiente_ = reinicioPendiente_ || reiniciar;
+
+  if ((blockSize <= MaxBloque) && (cantidadLibres_ > 0)) {
+    Periodo* q = libres_[--cantidadLibres_];
+    q->numero = llamadas_;
+    q->parametros = p;
+    q->reiniciar = reinicioPendiente_;
+    q->canales = canales;
+    q->blockSize = blockSize;
+    q->spectral = spectral;
+    for (int c=0;c<canales;++c) {
+      memcpy(q->entrada[c],in[c],sizeof(float)*blockSize);
+    }
+    reinicioPendiente_ = false;
+    aEcualizador_.poner(q);
+    timbreEcualizador_.tocar();
+  }
+
+  // Se entrega el bloque que entro hace periodos_ llamadas, si ya salio de la
+  // tuberia. Los anteriores llegaron tarde y se descartan; uno posterior se
+  // guarda en siguiente_ hasta que le toque.
+  const long long turno = llamadas_ - periodos_;
+  bool entregado = false;
+  while ((siguiente_ != 0) || aJack_.sacar(siguiente_)) {
+    Periodo* q = siguiente_;
+    if (q->numero > turno) {
+      break;
+    }
+    siguiente_ = 0;
+    if (q->numero == turno) {
+      const int muestras = std::min(q->blockSize,blockSize);
+      for (int c=0;c<canales;++c) {
+        if ((c < q->canales) && q->valido) {
+          memcpy(out[c],q->entrada[c],sizeof(float)*muestras);
+          memset(out[c]+muestras,0,sizeof(float)*(blockSize-muestras));
+        } else {
+          memset(out[c],0,sizeof(float)*blockSize);
+        }
+      }
+      entregado = true;
+    }
+    libres_[cantidadLibres_++] = q;
+  }
+
+  if (!entregado) {
+    for (int c=0;c<canales;++c) {
+      memset(out[c],0,sizeof(float)*blockSize);
+    }
+    // Los primeros periodos_ bloques aun no tienen salida; despues, un bloque
+    // sin salida se atraso o no pudo entrar.
+    if (turno >= 0) {
+      atrasos_.fetch_add(1,std::memory_order_relaxed);
+    }
+  }
+  ++llamadas_;
+}
+
+/*
+ * Etapa del ecualizador
+ */
+void stagePipeline::ecualizador() {
+
+  Periodo* q;
+  while (esperar(aEcualizador_,timbreEcualizador_,q)) {
+    rtGuard zona;
+
+    const Parametros& p = q->parametros;
+    if (q->reiniciar) {
+      cv_->inicio = true;
+    }
+    cv_->motor = p.engine;
+    cv_->medirBandas = p.metering;
+    q->valido = cv_->ecualizar(q->canales,q->blockSize,p.volumeGain,p.ganancias,
+                               q->entrada,q->ecualizada,q->medidores,q->omitir);
+
+    aReverberacion_.poner(q);
+    timbreReverberacion_.tocar();
+  }
+}
+
+/*
+ * Etapa de la reverberacion
+ */
+void stagePipeline::reverberacion() {
+
+  Periodo* q;
+  while (esperar(aReverberacion_,timbreReverberacion_,q)) {
+    rtGuard zona;
+
+    if (q->valido) {
+      const Parametros& p = q->parametros;
+      cv_->reverberar(q->canales,q->blockSize,q->ecualizada,q->entrada,p.aReverb,p.dReverb,
+                      p.reverbEnabled,p.typeReverb,q->omitir);
+      controlVolume::escribirMedidores(q->entrada[0][q->blockSize/2],q->medidores,q->spectral);
+    }
+
+    aJack_.poner(q);
+  }
+}
@@ -0,0 +1,197 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   stagepipeline.h
+ *         Pipelined processing: the equalizer and the reverberation run
+ *         each on its own core, some periods behind jack.
+ *
+ * $Id: stagepipeline.h $
+ */
+
+#ifndef STAGEPIPELINE_H
+#define STAGEPIPELINE_H
+
+#include <atomic>
+#include <thread>
+
+#include "controlvolume.h"
+#include "filterbank.h"
+#include "parametros.h"
+#include "spectralvalues.h"
+#include "spinfutex.h"
+#include "spscring.h"
+
+/**
+ * Tuberia de etapas de un controlVolume.
+ *
+ * controlVolume::filter() ejecuta el ecualizador, la reverberacion y los
+ * medidores uno tras otro, por lo que cada periodo debe alcanzar para la suma
+ * de las etapas. Aqui el ecualizador y el reverberador tienen cada uno su
+ * propio hilo, fijo a su propio nucleo: procesar() (en el hilo de jack) copia
+ * la entrada a un periodo libre y lo entrega al ecualizador, este al
+ * reverberador y este de vuelta a jack, siempre por anillos spscRing que pasan
+ * el puntero al periodo, sin copiar sus buffers. Los medidores solo copian la
+ * salida y los valores que calculo el ecualizador, por lo que los escribe el
+ * reverberador al terminar cada bloque.
+ *
+ * La salida de un periodo se entrega periodos() llamadas despues de su
+ * entrada. Con un periodo de latencia el ecualizador y el reverberador deben
+ * terminar juntos dentro de un periodo, pero el hilo de jack queda libre; con
+ * dos o mas cada etapa tiene un periodo completo, de modo que el limite lo
+ * pone la etapa mas lenta y no la suma. Si una salida
+ * no llega a tiempo el periodo sale en silencio y se cuenta en atrasos(); la
+ * salida atrasada se descarta al llegar, para que la latencia no cambie. Cada
+ * periodo lleva el numero de la llamada en que entro, por lo que la salida
+ * sigue alineada aunque un bloque no pueda entrar por falta de periodos libres.
+ *
+ * Los parametros viajan con cada periodo, por lo que el ecualizador es el
+ * unico hilo que usa inicio, motor y medirBandas del controlVolume. En
+ * procesar() no se reserva memoria ni se toman candados, y las etapas corren
+ * dentro de un rtGuard.
+ */
+class stagePipeline {
+public:
+
+    /**
+     * Constantes de la tuberia.
+     */
+    enum {
+      MaxPeriodos=8,  /**< Periodos de latencia que se pueden agregar. */
+      MaxBloque=8192, /**< Muestras por canal del bloque mas largo; con bloques mayores la salida es silencio. */
+      Etapas=2        /**< Hilos de la tuberia: ecualizador y reverberacion. */
+    };
+
+    /**
+     * Constructor: reserva los periodos; los hilos se crean en iniciar().
+     * @param cv procesador cuyas etapas se ejecutan; no debe procesar por otro lado mientras exista la tuberia.
+     * @param periodos periodos de latencia que se agregan, de 1 a MaxPeriodos.
+     */
+    stagePipeline(controlVolume* cv,int periodos);
+
+    /**
+     * Destructor: detiene los hilos.
+     */
+    ~stagePipeline();
+
+    /**
+     * @brief iniciar Crea los hilos de las etapas. Debe llamarse fuera del hilo de tiempo real.
+     * @param primerNucleo nucleo del ecualizador; la reverberacion va en el siguiente.
+     * @param prioridad prioridad SCHED_FIFO de las etapas; 0 las deja con la politica normal.
+     * @return false si algun hilo no se pudo fijar a su nucleo o subir de prioridad (la tuberia funciona igual).
+     */
+    bool iniciar(int primerNucleo,int prioridad);
+
+    /**
+     * @brief detener Termina y espera a los hilos de las etapas.
+     */
+    void detener();
+
+    /**
+     * @brief periodos Periodos de latencia que agrega la tuberia.
+     */
+    int periodos() const;
+
+    /**
+     * @brief atrasos Periodos que salieron en silencio porque su salida no llego a tiempo o no habia periodos libres.
+     */
+    unsigned long atrasos() const;
+
+    /**
+     * @brief procesar Entrega un bloque a la tuberia y escribe la salida del bloque de periodos() llamadas antes.
+     * Solo desde el hilo de jack. in y out pueden ser los mismos buffers.
+     * @param p parametros del bloque.
+     * @param reiniciar pide reiniciar las historias de los filtros en este bloque.
+     * @param in entrada de cada canal.
+     * @param out salida de cada canal.
+     * @param canales 1 o 2.
+     * @param blockSize muestras por canal.
+     * @param spectral valores de los medidores, que escribe el hilo de la reverberacion.
+     */
+    void procesar(const Parametros& p,bool reiniciar,float* const* in,float* const* out,
+                  int canales,int blockSize,struct Spectral* spectral);
+
+private:
+
+    /**
+     * Un bloque en la tuberia, con sus parametros y buffers.
+     */
+    struct Periodo {
+      long long numero;             /**< Llamada de procesar() en que entro. */
+      Parametros parametros;
+      bool reiniciar;
+      int canales;
+      int blockSize;
+      bool valido;                  /**< El ecualizador tenia estado para este bloque; si no, la salida es silencio. */
+      bool omitir;                  /**< La salida del ecualizador es nula (modo de reposo o volumen en cero). */
+      float medidores[filterBank::Grupos];
+      struct Spectral* spectral;
+      float* entrada[controlVolume::MaxCanales];    /**< Entrada, que el reverberador reemplaza con la salida. */
+      float* ecualizada[controlVolume::MaxCanales]; /**< Salida del ecualizador. */
+    };
+
+    /**
+     * @brief esperar Saca una entrega del anillo de una etapa, esperando en su timbre si esta vacio.
+     * @return false si se pidio terminar.
+     */
+    bool esperar(spscRing<Periodo*>& anillo,spinFutex& timbre,Periodo*& periodo);
+
+    /**
+     * Ciclo de cada etapa: espera una entrega en su timbre y la procesa.
+     */
+    void ecualizador();
+    void reverberacion();
+
+    controlVolume* cv_;
+    int periodos_;
+
+    /**
+     * Periodos reservados en el constructor.
+     */
+    Periodo* bloques_;
+    int cantidad_;
+
+    /**
+     * Periodos libres, periodo que ya salio de la tuberia pero aun no le toca,
+     * llamadas a procesar() y pedido de reinicio que aun no entra; solo los usa
+     * el hilo de jack.
+     */
+    Periodo* libres_[MaxPeriodos+2];
+    int cantidadLibres_;
+    Periodo* siguiente_;
+    long long llamadas_;
+    bool reinicioPendiente_;
+
+    /**
+     * Anillos entre las etapas y sus timbres.
+     */
+    spscRing<Periodo*> aEcualizador_;
+    spscRing<Periodo*> aReverberacion_;
+    spscRing<Periodo*> aJack_;
+    spinFutex timbreEcualizador_;
+    spinFutex timbreReverberacion_;
+
+    std::atomic<unsigned long> atrasos_;
+    std::atomic<bool> terminar_;
+    std::thread* hilos_[Etapas];
+
+    stagePipeline(const stagePipeline&);
+    stagePipeline& operator=(const stagePipeline&);
+};
+
+#endif // STAGEPIPELINE_H
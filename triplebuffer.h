@@ -0,0 +1,104 @@
+/*
+ * DSP Example is part of the DSP Lecture at TEC-Costa Rica
+ * Copyright (C) 2026  The DSP Example contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file   triplebuffer.h
+ *         Lock-free triple buffer that hands complete snapshots from one
+ *         writer thread to one reader thread.
+ *
+ * $Id: triplebuffer.h $
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * Buffer triple sin bloqueos para un escritor y un lector.
+ *
+ * Hay tres copias de T: la que llena el escritor, la que usa el lector y una
+ * intermedia. publicar() intercambia la copia del escritor con la intermedia
+ * y la marca como nueva; tomar() intercambia la intermedia con la del lector
+ * solo si hay una nueva. Cada lado hace a lo sumo un intercambio atomico, el
+ * lector nunca espera y siempre ve una copia completa: nunca una mezcla de
+ * dos publicaciones.
+ */
+template<typename T>
+class tripleBuffer {
+public:
+
+    /**
+     * Constructor
+     * @param inicial valor inicial de las tres copias.
+     */
+    explicit tripleBuffer(const T& inicial = T())
+      : intermedio_(1),escritura_(0),lectura_(2) {
+      copias_[0] = copias_[1] = copias_[2] = inicial;
+    }
+
+    /**
+     * @brief escribir Copia que llena el escritor. Su contenido es el de una
+     * publicacion anterior, por lo que se debe llenar completa antes de publicar().
+     */
+    T& escribir() {
+      return copias_[escritura_];
+    }
+
+    /**
+     * @brief publicar Entrega la copia del escritor al lector.
+     */
+    void publicar() {
+      escritura_ = intermedio_.exchange(escritura_ | Nuevo,std::memory_order_acq_rel) & Indice;
+    }
+
+    /**
+     * @brief tomar Retorna la ultima copia publicada (solo el lector).
+     */
+    const T& tomar() {
+      if (intermedio_.load(std::memory_order_relaxed) & Nuevo) {
+        lectura_ = intermedio_.exchange(lectura_,std::memory_order_acq_rel) & Indice;
+      }
+      return copias_[lectura_];
+    }
+
+private:
+
+    enum {
+      Indice=3, /**< Bits del indice de la copia intermedia. */
+      Nuevo=4   /**< Indica que la copia intermedia no ha sido tomada. */
+    };
+
+    T copias_[3];
+
+    /**
+     * Indice de la copia intermedia y bandera Nuevo.
+     */
+    std::atomic<int> intermedio_;
+
+    /**
+     * Copias de cada lado; cada indice lo usa un solo hilo.
+     */
+    int escritura_;
+    int lectura_;
+
+    tripleBuffer(const tripleBuffer&);
+    tripleBuffer& operator=(const tripleBuffer&);
+};
+
+#endif // TRIPLEBUFFER_H